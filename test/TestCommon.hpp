@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdio>
+
+namespace zs::test {
+
+  inline int g_numFailures = 0;
+
+  /// @note the exit code of a test executable
+  inline int report(const char *name) {
+    if (g_numFailures) {
+      std::fprintf(stderr, "%s: %d check(s) failed\n", name, g_numFailures);
+      return 1;
+    }
+    std::printf("%s: passed\n", name);
+    return 0;
+  }
+
+}  // namespace zs::test
+
+#define ZS_CHECK(cond)                                                              \
+  do {                                                                              \
+    if (!(cond)) {                                                                  \
+      std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      ++zs::test::g_numFailures;                                                    \
+    }                                                                               \
+  } while (0)
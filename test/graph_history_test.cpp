@@ -0,0 +1,493 @@
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestCommon.hpp"
+#include "editor/ImguiSystem.hpp"
+#include "editor/widgets/GraphWidgetComponent.hpp"
+#include "editor/widgets/GraphWidgetHistory.hpp"
+
+using namespace zs;
+
+/// @note sets [key] of the document from [from] to [to]
+struct SetCommand {
+  int key, from, to;
+  size_t bytes{16};
+  size_t footprint() const noexcept { return bytes; }
+};
+using History = ge::TransactionHistory<SetCommand>;
+
+struct Document {
+  std::map<int, int> values;
+  std::vector<int> replayed;  // keys in the order of replay
+
+  void set(History &history, int key, int value, size_t bytes = 16) {
+    history.push(SetCommand{key, values[key], value, bytes});
+    values[key] = value;
+  }
+  bool undo(History &history) {
+    return history.undo([this](const SetCommand &cmd) {
+      values[cmd.key] = cmd.from;
+      replayed.push_back(cmd.key);
+    });
+  }
+  bool redo(History &history) {
+    return history.redo([this](const SetCommand &cmd) {
+      values[cmd.key] = cmd.to;
+      replayed.push_back(cmd.key);
+    });
+  }
+};
+
+static void test_undo_redo() {
+  History history{16, 1 << 20};
+  Document doc;
+  ZS_CHECK(!history.canUndo() && !doc.undo(history));
+  doc.set(history, 0, 1);
+  doc.set(history, 0, 2);
+  ZS_CHECK(history.numUndoEntries() == 2);
+  ZS_CHECK(doc.undo(history) && doc.values[0] == 1);
+  ZS_CHECK(doc.undo(history) && doc.values[0] == 0);
+  ZS_CHECK(!doc.undo(history));
+  ZS_CHECK(doc.redo(history) && doc.values[0] == 1);
+  ZS_CHECK(history.numUndoEntries() == 1 && history.numRedoEntries() == 1);
+
+  /// a new edit discards the redo history
+  doc.set(history, 1, 5);
+  ZS_CHECK(!history.canRedo() && !doc.redo(history));
+  ZS_CHECK(history.footprint() == 2 * 16);
+}
+
+static void test_transactions() {
+  History history{16, 1 << 20};
+  Document doc;
+  history.begin();
+  doc.set(history, 0, 1);
+  history.begin();
+  doc.set(history, 1, 1);
+  history.end();
+  /// still open, thus neither committed nor undoable
+  ZS_CHECK(history.numUndoEntries() == 0 && !doc.undo(history));
+  doc.set(history, 2, 1);
+  history.end();
+  ZS_CHECK(history.numUndoEntries() == 1);
+
+  ZS_CHECK(doc.undo(history));
+  ZS_CHECK(doc.values[0] == 0 && doc.values[1] == 0 && doc.values[2] == 0);
+  ZS_CHECK((doc.replayed == std::vector<int>{2, 1, 0}));
+  doc.replayed.clear();
+  ZS_CHECK(doc.redo(history));
+  ZS_CHECK(doc.values[0] == 1 && doc.values[1] == 1 && doc.values[2] == 1);
+  ZS_CHECK((doc.replayed == std::vector<int>{0, 1, 2}));
+
+  /// an empty transaction commits nothing
+  history.begin();
+  history.end();
+  ZS_CHECK(history.numUndoEntries() == 1);
+}
+
+static void test_replay_not_recorded() {
+  History history{16, 1 << 20};
+  Document doc;
+  doc.set(history, 0, 1);
+  ZS_CHECK(history.recording());
+  history.undo([&](const SetCommand &cmd) {
+    ZS_CHECK(!history.recording());
+    /// edits issued by the replay itself
+    doc.set(history, cmd.key, cmd.from);
+  });
+  ZS_CHECK(history.recording());
+  ZS_CHECK(history.numUndoEntries() == 0 && history.numRedoEntries() == 1);
+  ZS_CHECK(doc.values[0] == 0);
+}
+
+static void test_capacity() {
+  {
+    History history{4, 1 << 20};
+    Document doc;
+    for (int i = 0; i != 10; ++i) doc.set(history, i, 1);
+    ZS_CHECK(history.numUndoEntries() == 4 && history.footprint() == 4 * 16);
+    /// the latest edits are kept
+    while (doc.undo(history));
+    ZS_CHECK(doc.values[5] == 1 && doc.values[6] == 0 && doc.values[9] == 0);
+  }
+  {
+    History history{128, 1000};
+    Document doc;
+    for (int i = 0; i != 10; ++i) doc.set(history, i, 1, 300);
+    ZS_CHECK(history.numUndoEntries() == 3 && history.footprint() == 900);
+    /// undone entries count towards the budget
+    doc.undo(history);
+    doc.undo(history);
+    history.setCapacity(2, 1000);
+    ZS_CHECK(history.numUndoEntries() == 0 && history.numRedoEntries() == 2);
+    ZS_CHECK(history.footprint() == 600);
+    history.setCapacity(128, 300);
+    ZS_CHECK(history.numRedoEntries() == 1 && history.footprint() == 300);
+    /// the redo history closest to the present is kept
+    ZS_CHECK(doc.redo(history) && doc.values[8] == 1 && doc.values[9] == 0);
+    history.clear();
+    ZS_CHECK(!history.canUndo() && !history.canRedo() && history.footprint() == 0);
+  }
+}
+
+/// @note evaluates the python string literals produced by python_string_literal
+static bool eval_literal(const std::string &lit, std::string &s) {
+  if (lit.size() < 2 || lit.front() != '\"' || lit.back() != '\"') return false;
+  s.clear();
+  for (size_t i = 1; i + 1 < lit.size(); ++i) {
+    char c = lit[i];
+    if (c == '\n' || c == '\r' || c == '\"') return false;  // would break the literal
+    if (c != '\\') {
+      s += c;
+      continue;
+    }
+    if (++i + 1 >= lit.size()) return false;
+    switch (lit[i]) {
+      case '\\':
+      case '\"':
+        s += lit[i];
+        break;
+      case 'n':
+        s += '\n';
+        break;
+      case 'r':
+        s += '\r';
+        break;
+      case 't':
+        s += '\t';
+        break;
+      case 'x':
+        if (i + 3 >= lit.size()) return false;
+        s += (char)std::stoi(lit.substr(i + 1, 2), nullptr, 16);
+        i += 2;
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+static void test_string_literal() {
+  ZS_CHECK(ge::python_string_literal("abc") == "\"abc\"");
+  ZS_CHECK(ge::python_string_literal("a\"b\\c") == "\"a\\\"b\\\\c\"");
+  ZS_CHECK(ge::python_string_literal("l0\nl1\r\n\tx") == "\"l0\\nl1\\r\\n\\tx\"");
+  ZS_CHECK(ge::python_string_literal("\x01\x7f") == "\"\\x01\\x7f\"");
+  /// utf-8
+  ZS_CHECK(ge::python_string_literal("\xe4\xbd\xa0") == "\"\xe4\xbd\xa0\"");
+
+  std::string all, evaluated;
+  for (int c = 1; c != 256; ++c) all += (char)c;
+  ZS_CHECK(eval_literal(ge::python_string_literal(all), evaluated) && evaluated == all);
+}
+
+///
+/// edits on a real graph
+///
+static std::string dump_position(ImVec2 pos) {
+  return std::to_string((int)pos.x) + "," + std::to_string((int)pos.y);
+}
+
+/// @note pins in tree order, children indented below their parent
+static void dump_pin(const ge::Pin &pin, int depth, std::string &out) {
+  out.append(2 * depth, ' ');
+  out += "pin " + std::to_string(pin._id.Get()) + " " + pin._name + " type "
+         + std::to_string((int)pin._type) + " kind " + std::to_string((int)pin._kind)
+         + " expanded " + (pin._expanded ? std::to_string((int)*pin._expanded) : "-") + "\n";
+  for (const auto &ch : pin._chs) dump_pin(ch, depth + 1, out);
+}
+
+/// @note pin contents are left out, as restoring them evaluates python expressions
+static std::string dump_graph(ge::Graph &graph) {
+  auto guard = graph.contextGuard();
+  std::string out;
+  for (const auto &[id, node] : graph._nodes) {
+    out += "node " + std::to_string(id.Get()) + " " + node._name + " type "
+           + std::to_string((int)node._type) + " at " + dump_position(ed::GetNodePosition(id))
+           + " (" + dump_position(node._pos) + ")\n";
+    for (const auto &pin : node._inputs) dump_pin(pin, 1, out);
+    for (const auto &pin : node._outputs) dump_pin(pin, 1, out);
+  }
+  for (const auto &[id, link] : graph._links)
+    out += "link " + std::to_string(id.Get()) + " " + std::to_string(link._srcPin->_id.Get())
+           + " -> " + std::to_string(link._dstPin->_id.Get()) + "\n";
+  return out;
+}
+
+static void collect_pins(ge::Pin &pin, std::vector<ge::Pin *> &pins) {
+  pins.push_back(&pin);
+  for (auto &ch : pin._chs) collect_pins(ch, pins);
+}
+static std::vector<ge::Pin *> collect_pins(ge::Graph &graph) {
+  std::vector<ge::Pin *> pins;
+  for (auto &[id, node] : graph._nodes) {
+    for (auto &pin : node._inputs) collect_pins(pin, pins);
+    for (auto &pin : node._outputs) collect_pins(pin, pins);
+  }
+  return pins;
+}
+
+/// @note the pin registry and the links agree with the node trees
+static bool graph_consistent(ge::Graph &graph) {
+  const auto pins = collect_pins(graph);
+  if (pins.size() != graph._pins.size()) return false;
+  for (auto pin : pins) {
+    if (graph.findPin(pin->_id) != pin || graph.findNode(pin->_node->_id) != pin->_node)
+      return false;
+    if (pin->_parent && pin->_parent->_kind != pin->_kind) return false;
+    for (auto link : pin->_links)
+      if (link->_srcPin != pin && link->_dstPin != pin) return false;
+  }
+  for (auto &[id, link] : graph._links) {
+    auto src = link._srcPin, dst = link._dstPin;
+    if (graph.findPin(src->_id) != src || graph.findPin(dst->_id) != dst) return false;
+    if (link._startPinID != src->_id || link._endPinID != dst->_id) return false;
+    if (!src->_links.count(&link) || !dst->_links.count(&link)) return false;
+  }
+  return true;
+}
+
+/// @note each edit goes through the same graph calls and history records as the editor does,
+/// and commits exactly one transaction if it returns true
+struct GraphEditing {
+  ge::Graph &graph;
+  std::mt19937 rng;
+
+  u32 pick(u32 n) { return std::uniform_int_distribution<u32>(0, n - 1)(rng); }
+  ImVec2 randomPosition() { return ImVec2((float)pick(2000) - 1000, (float)pick(2000) - 1000); }
+  ge::Node *randomNode() {
+    if (graph._nodes.empty()) return nullptr;
+    auto it = graph._nodes.begin();
+    std::advance(it, pick((u32)graph._nodes.size()));
+    return &it->second;
+  }
+  ge::Pin *randomPin(bool expandableOnly = false) {
+    auto pins = collect_pins(graph);
+    if (expandableOnly) std::erase_if(pins, [](ge::Pin *pin) { return !pin->expandable(); });
+    return pins.empty() ? nullptr : pins[pick((u32)pins.size())];
+  }
+  ge::Link *randomLink() {
+    if (graph._links.empty()) return nullptr;
+    auto it = graph._links.begin();
+    std::advance(it, pick((u32)graph._links.size()));
+    return &it->second;
+  }
+
+  void populate(ge::Pin *pin) {
+    pin->_type = (ge::pin_type_e)pick(5);
+    if (pick(2)) return;
+    pin->_type = pick(2) ? ge::pin_type_e::List : ge::pin_type_e::Dict;
+    pin->_expanded = pick(2) != 0;
+    for (u32 k = pick(3); k--;) {
+      auto id = graph.nextPinId();
+      pin->append(id, std::string("item_") + std::to_string(id.Get()));
+    }
+  }
+
+  bool spawnNode() {
+    auto [iter, success] = graph.spawnNode("node");
+    auto &node = iter->second;
+    node._name = "node_" + std::to_string(node._id.Get());
+    node._type = (ge::node_type_e)pick(3);
+    for (u32 i = 1 + pick(3); i--;) populate(node.appendInput("in_" + std::to_string(i)));
+    for (u32 i = 1 + pick(2); i--;) populate(node.appendOutput("out_" + std::to_string(i)));
+    /// @note integral, as the node editor snaps positions to whole pixels
+    node._pos = randomPosition();
+    ed::SetNodePosition(node._id, node._pos);
+    graph.history().recordNodeSpawn(node);
+    return true;
+  }
+  bool deleteNode() {
+    auto node = randomNode();
+    if (!node) return false;
+    auto &history = graph.history();
+    history.begin();
+    history.recordNodeDelete(*node);
+    graph._nodes.erase(node->_id);
+    history.end();
+    return true;
+  }
+  bool createLink() {
+    auto src = randomPin(), dst = randomPin();
+    if (!src || !dst || src->_kind == dst->_kind || src->_node == dst->_node) return false;
+    if (src->_kind == ge::pin_kind_e::Input) std::swap(src, dst);
+    for (auto link : dst->_links)
+      if (link->_srcPin == src) return false;
+    auto &history = graph.history();
+    history.begin();
+    /// remove existing links related to the dstPin (if any)
+    if (dst->_links.size()) {
+      auto link = *dst->_links.begin();
+      history.recordLinkRemove(*link);
+      graph._links.erase(link->_id);
+    }
+    auto [iter, success] = graph.spawnLink(src, dst);
+    history.recordLinkCreate(iter->second);
+    history.end();
+    return true;
+  }
+  bool removeLink() {
+    auto link = randomLink();
+    if (!link) return false;
+    graph.history().recordLinkRemove(*link);
+    graph._links.erase(link->_id);
+    return true;
+  }
+  /// @note either appended to an expandable pin, inserted after one of its children, or
+  /// inserted among the top-level pins of a node
+  bool insertPin() {
+    auto id = graph.nextPinId();
+    const auto label = std::string("item_") + std::to_string(id.Get());
+    ge::Pin *pin = nullptr;
+    if (pick(3) == 0) {
+      auto target = randomPin();
+      if (!target || target->_parent) return false;
+      auto node = target->_node;
+      pin = target->_kind == ge::pin_kind_e::Input ? node->appendInput(target, id, label)
+                                                   : node->appendOutput(target, id, label);
+    } else {
+      auto parent = randomPin(true);
+      if (!parent) return false;
+      if (!parent->_chs.empty() && pick(2)) {
+        auto target = parent->_chs.begin();
+        std::advance(target, pick((u32)parent->_chs.size()));
+        pin = parent->append(&*target, id, label);
+      } else
+        pin = parent->append(id, label);
+    }
+    graph.history().recordPinInsert(*pin);
+    return true;
+  }
+  bool removePin() {
+    auto pin = randomPin();
+    if (!pin) return false;
+    graph.history().recordPinRemove(*pin);
+    pin->_node->removePin(pin);
+    return true;
+  }
+  /// @note dragging a selection of nodes
+  bool moveNodes() {
+    auto &history = graph.history();
+    const auto numUndos = history.numUndoEntries();
+    history.begin();
+    for (u32 i = 1 + pick(3); i--;) {
+      auto node = randomNode();
+      if (!node) break;
+      const auto from = ed::GetNodePosition(node->_id);
+      const auto to = randomPosition();
+      if (to.x == from.x && to.y == from.y) continue;
+      node->_pos = to;
+      ed::SetNodePosition(node->_id, to);
+      history.recordNodeMove(node->_id, from, to);
+    }
+    history.end();
+    return history.numUndoEntries() != numUndos;
+  }
+  /// @note deleting a selection: links first, then pins, then nodes, within one transaction
+  bool deleteSelection() {
+    auto &history = graph.history();
+    const auto numUndos = history.numUndoEntries();
+    history.begin();
+    if (auto link = randomLink()) {
+      history.recordLinkRemove(*link);
+      graph._links.erase(link->_id);
+    }
+    if (auto pin = randomPin()) {
+      history.recordPinRemove(*pin);
+      pin->_node->removePin(pin);
+    }
+    if (auto node = randomNode()) {
+      history.recordNodeDelete(*node);
+      graph._nodes.erase(node->_id);
+    }
+    history.end();
+    return history.numUndoEntries() != numUndos;
+  }
+
+  bool edit() {
+    /// @note spawns outweigh deletions so that the graph grows
+    switch (pick(10)) {
+      case 0:
+      case 1:
+        return spawnNode();
+      case 2:
+        return deleteNode();
+      case 3:
+      case 4:
+        return createLink();
+      case 5:
+        return removeLink();
+      case 6:
+        return insertPin();
+      case 7:
+        return removePin();
+      case 8:
+        return moveNodes();
+      default:
+        return deleteSelection();
+    }
+  }
+};
+
+static void test_graph_edits() {
+  ImguiSystem::initialize();
+  const auto missing
+      = (std::filesystem::temp_directory_path() / "zs_graph_history_test.json").string();
+  std::filesystem::remove(missing);
+  ge::Graph graph{"graph_history_test", missing};
+  auto &history = graph.history();
+  history.setCapacity((size_t)1 << 20, (size_t)1 << 40);
+  auto guard = graph.contextGuard();
+
+  GraphEditing editing{graph, std::mt19937{26}};
+  /// states[i] is the graph after i committed transactions
+  std::vector<std::string> states{dump_graph(graph)};
+  size_t cur = 0;
+  bool consistent = true, restored = true;
+  for (int round = 0; round != 40; ++round) {
+    for (int i = 0; i != 25; ++i) {
+      if (!editing.edit()) continue;
+      states.resize(cur + 1);
+      states.push_back(dump_graph(graph));
+      cur++;
+      consistent = consistent && graph_consistent(graph);
+    }
+    restored = restored && history.numUndoEntries() == cur;
+    /// step back and forth through the history
+    for (size_t n = editing.pick((u32)cur + 1); n--;) {
+      restored = restored && graph.undo() && dump_graph(graph) == states[--cur];
+      consistent = consistent && graph_consistent(graph);
+    }
+    for (size_t n = editing.pick((u32)(states.size() - cur)); n--;) {
+      restored = restored && graph.redo() && dump_graph(graph) == states[++cur];
+      consistent = consistent && graph_consistent(graph);
+    }
+  }
+  ZS_CHECK(states.size() > 200 && !graph._links.empty());
+  ZS_CHECK(consistent);
+  ZS_CHECK(restored);
+
+  /// all the way back to the empty graph, then all the way forward again
+  while (cur != 0) restored = restored && graph.undo() && dump_graph(graph) == states[--cur];
+  ZS_CHECK(restored && !graph.undo() && graph._nodes.empty() && graph._pins.empty());
+  while (cur + 1 != states.size())
+    restored = restored && graph.redo() && dump_graph(graph) == states[++cur];
+  ZS_CHECK(restored && !graph.redo() && graph_consistent(graph));
+
+  /// a new edit discards the redo history
+  ZS_CHECK(graph.undo() && editing.spawnNode() && !graph.redo());
+}
+
+int main() {
+  test_undo_redo();
+  test_transactions();
+  test_replay_not_recorded();
+  test_capacity();
+  test_string_literal();
+  test_graph_edits();
+  return zs::test::report("graph_history_test");
+}
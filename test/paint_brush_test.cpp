@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <random>
+#include <vector>
+
+#include "TestCommon.hpp"
+#include "editor/SceneEditorPaintBrush.hpp"
+
+using namespace zs;
+
+/// @note the exit code ctest takes as skipped, when there is no vulkan device at all
+static constexpr int s_skipped = 77;
+static constexpr u32 s_width = 96, s_height = 64, s_num_verts = 700;
+static constexpr int s_prim_id = 5;
+
+/// @note (prim id, vertex id) per pixel, as written by the pick pass: vertices cover 2x2 patches,
+/// some of which belong to the background or to another prim
+static std::vector<glm::ivec4> random_pick_image(std::mt19937 &rng) {
+  std::uniform_int_distribution<int> pickVertex(0, (int)s_num_verts - 1), pickKind(0, 9);
+  std::vector<glm::ivec4> cells((s_width / 2) * (s_height / 2));
+  for (auto &cell : cells) {
+    const int kind = pickKind(rng);
+    if (kind == 0)
+      cell = glm::ivec4(-1, -1, 0, 0);
+    else
+      cell = glm::ivec4(kind == 1 ? s_prim_id + 1 : s_prim_id, pickVertex(rng), 0, 0);
+  }
+  std::vector<glm::ivec4> pixels(s_width * s_height);
+  for (u32 y = 0; y != s_height; ++y)
+    for (u32 x = 0; x != s_width; ++x)
+      pixels[y * s_width + x] = cells[y / 2 * (s_width / 2) + x / 2];
+  return pixels;
+}
+
+/// @note what the cpu path paints: the vertices of the prim gathered within the integral radius
+/// take the brush color as a whole
+static void paint_on_cpu(const std::vector<glm::ivec4> &pixels, const PaintBrush::Param &param,
+                         std::vector<glm::vec3> &colors) {
+  const int r = (int)param.radius;
+  for (int y = std::max(param.center.y - r, 0); y <= param.center.y + r && y < (int)s_height; ++y)
+    for (int x = std::max(param.center.x - r, 0); x <= param.center.x + r && x < (int)s_width;
+         ++x) {
+      const int dx = x - param.center.x, dy = y - param.center.y;
+      const auto &ids = pixels[y * s_width + x];
+      if (dx * dx + dy * dy > r * r || ids.x != param.primId || ids.y < 0) continue;
+      colors[ids.y] = param.color;
+    }
+}
+
+/// @note the brush weights evaluated on the cpu, the max one over the pixels of a vertex
+static void soft_paint_on_cpu(const std::vector<glm::ivec4> &pixels,
+                              const PaintBrush::Param &param, std::vector<glm::vec3> &colors) {
+  const int r = (int)param.radius;
+  std::vector<float> weights(s_num_verts, 0.f);
+  for (int y = std::max(param.center.y - r, 0); y <= param.center.y + r && y < (int)s_height; ++y)
+    for (int x = std::max(param.center.x - r, 0); x <= param.center.x + r && x < (int)s_width;
+         ++x) {
+      const int dx = x - param.center.x, dy = y - param.center.y;
+      const auto &ids = pixels[y * s_width + x];
+      if (dx * dx + dy * dy > r * r || ids.x != param.primId || ids.y < 0) continue;
+      const float dist = r > 0 ? std::min(std::sqrt((float)(dx * dx + dy * dy)) / r, 1.f) : 0.f;
+      const float f = dist <= param.hardness
+                          ? 1.f
+                          : std::clamp((1 - dist) / std::max(1 - param.hardness, 1e-5f), 0.f, 1.f);
+      weights[ids.y] = std::max(weights[ids.y], param.opacity * f * f * (3 - 2 * f));
+    }
+  for (u32 v = 0; v != s_num_verts; ++v)
+    if (weights[v] > 0) colors[v] = colors[v] * (1 - weights[v]) + param.color * weights[v];
+}
+
+static bool bitwise_equal(const glm::vec3 *a, const glm::vec3 *b, size_t n) {
+  return std::memcmp(a, b, sizeof(glm::vec3) * n) == 0;
+}
+
+/// @note the records hold every changed vertex once, with its colors before and after the dab
+static bool records_match(const std::vector<PaintBrush::Record> &records,
+                          const std::vector<glm::vec3> &before, const glm::vec3 *after) {
+  std::vector<bool> recorded(s_num_verts, false);
+  for (const auto &record : records) {
+    if (record.vid >= s_num_verts || recorded[record.vid]) return false;
+    recorded[record.vid] = true;
+    if (!bitwise_equal(&record.prev, &before[record.vid], 1)
+        || !bitwise_equal(&record.next, &after[record.vid], 1))
+      return false;
+  }
+  for (u32 v = 0; v != s_num_verts; ++v)
+    if (!recorded[v] && !bitwise_equal(&before[v], &after[v], 1)) return false;
+  return true;
+}
+
+int main() {
+  VulkanContext *pctx = nullptr;
+  try {
+    pctx = &Vulkan::context(0);
+  } catch (const std::exception &e) {
+    std::printf("paint_brush_test: skipped, no vulkan device (%s)\n", e.what());
+    return s_skipped;
+  }
+  auto &ctx = *pctx;
+  std::mt19937 rng(20240925u);
+
+  /// @note the pick image, uploaded once
+  const auto pixels = random_pick_image(rng);
+  Owner<Image> pickImage;
+  pickImage = ctx.create2DImage(
+      vk::Extent2D{s_width, s_height}, vk::Format::eR32G32B32A32Sint,
+      vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferDst,
+      vk::MemoryPropertyFlagBits::eDeviceLocal);
+  {
+    const size_t numBytes = sizeof(glm::ivec4) * pixels.size();
+    Owner<Buffer> staging;
+    staging = ctx.createStagingBuffer(numBytes, vk::BufferUsageFlagBits::eTransferSrc);
+    staging.get().map();
+    std::memcpy(staging.get().mappedAddress(), pixels.data(), numBytes);
+    staging.get().unmap();
+    staging.get().flush();
+    Owner<VkCommand> cmd;
+    cmd = ctx.createCommandBuffer(vk_cmd_usage_e::reset, vk_queue_e::graphics, false);
+    Owner<Fence> fence;
+    fence = Fence(ctx, true);
+    auto &c = cmd.get();
+    c.begin();
+    auto barrier = image_layout_transition_barrier(
+        pickImage.get(), vk::ImageAspectFlagBits::eColor, vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eGeneral, vk::PipelineStageFlagBits::eTopOfPipe,
+        vk::PipelineStageFlagBits::eTransfer);
+    (*c).pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                         vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {}, {},
+                         {barrier}, ctx.dispatcher);
+    vk::BufferImageCopy region{};
+    region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = vk::Extent3D{s_width, s_height, 1};
+    (*c).copyBufferToImage(staging.get(), pickImage.get(), vk::ImageLayout::eGeneral, {region},
+                           ctx.dispatcher);
+    c.end();
+    c.submit(fence.get(), /*reset fence*/ true, /*reset config*/ true);
+    fence.get().wait();
+  }
+
+  PaintBrush brush;
+  brush.setup(ctx);
+  std::uniform_real_distribution<float> channel(0.f, 1.f);
+  std::uniform_int_distribution<int> pickX(0, (int)s_width - 1), pickY(0, (int)s_height - 1);
+  std::vector<glm::vec3> before(s_num_verts), expected;
+  std::vector<PaintBrush::Record> records;
+  bool hardMatches = true, softMatches = true, recordsMatch = true;
+  int numHits = 0;
+  for (int dab = 0; dab != 32; ++dab) {
+    /// @note hard dabs at full opacity first, as the cpu path paints, then soft translucent ones
+    const bool hard = dab < 16;
+    PaintBrush::Param param;
+    param.color = glm::vec3(channel(rng), channel(rng), channel(rng));
+    param.center = glm::ivec2(pickX(rng), pickY(rng));
+    param.radius = (float)(dab % 4 == 0 ? 0 : 3 + dab % 13) + 0.5f;
+    param.hardness = hard ? 1.f : 0.3f;
+    param.opacity = hard ? 1.f : 0.6f;
+    param.primId = s_prim_id;
+
+    auto canvas = brush.prepareCanvas(s_num_verts);
+    for (auto &c : before) c = glm::vec3(channel(rng), channel(rng), channel(rng));
+    std::copy(std::begin(before), std::end(before), canvas);
+    expected = before;
+    if (hard)
+      paint_on_cpu(pixels, param, expected);
+    else
+      soft_paint_on_cpu(pixels, param, expected);
+
+    brush.apply(pickImage.get(), param);
+    records.clear();
+    ZS_CHECK(brush.pending() && brush.retrieve(/*wait*/ true, records) && !brush.pending());
+    if (hard)
+      hardMatches = hardMatches && bitwise_equal(canvas, expected.data(), s_num_verts);
+    else
+      for (u32 v = 0; v != s_num_verts; ++v)
+        softMatches = softMatches && glm::all(glm::lessThanEqual(glm::abs(canvas[v] - expected[v]),
+                                                                 glm::vec3(1e-5f)));
+    recordsMatch = recordsMatch && records_match(records, before, canvas);
+    numHits += !records.empty();
+  }
+  ZS_CHECK(hardMatches);
+  ZS_CHECK(softMatches);
+  ZS_CHECK(recordsMatch);
+  /// @note the dabs actually hit the prim
+  ZS_CHECK(numHits > 0);
+  return test::report("paint_brush_test");
+}
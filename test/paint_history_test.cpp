@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "TestCommon.hpp"
+#include "editor/SceneEditorPaintHistory.hpp"
+
+using namespace zs;
+
+static bool bitwise_equal(const std::vector<glm::vec3> &a, const std::vector<glm::vec3> &b) {
+  return a.size() == b.size()
+         && (a.empty() || std::memcmp(a.data(), b.data(), sizeof(glm::vec3) * a.size()) == 0);
+}
+
+/// @note sorted unique ids in runs of random lengths, colors drawn from a small palette (thus
+/// forming runs) which includes values only distinguishable bitwise
+static void random_stroke(std::mt19937 &rng, size_t numVertices, std::vector<i32> &ids,
+                          std::vector<glm::vec3> &prevColors, std::vector<glm::vec3> &colors) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float denorm = std::numeric_limits<float>::denorm_min();
+  const glm::vec3 palette[] = {{0.f, 0.f, 0.f},    {-0.f, 0.f, 0.f}, {0.8f, 0.1f, 0.1f},
+                               {denorm, 1.f, 0.5f}, {nan, 0.f, 1.f},  {1.f, 1.f, 1.f},
+                               {0.1f, 0.2f, 0.3f}};
+  std::uniform_int_distribution<int> gap(1, 8), runLength(1, 40), pick(0, 6), keep(0, 9);
+  ids.clear();
+  prevColors.clear();
+  colors.clear();
+  i32 id = gap(rng) - 1;
+  while (ids.size() < numVertices) {
+    for (int n = runLength(rng); n-- && ids.size() < numVertices;) ids.push_back(id++);
+    id += gap(rng);
+  }
+  glm::vec3 prev = palette[0], next = palette[2];
+  for (size_t i = 0; i != numVertices; ++i) {
+    if (keep(rng) == 0) prev = palette[pick(rng)];
+    if (keep(rng) == 0) next = palette[pick(rng)];
+    prevColors.push_back(prev);
+    colors.push_back(next);
+  }
+}
+
+static void check_round_trip(std::mt19937 &rng) {
+  std::vector<i32> ids, decodedIds;
+  std::vector<glm::vec3> prevColors, colors, decoded;
+  for (size_t numVertices : {0, 1, 2, 37, 1000, 100000}) {
+    random_stroke(rng, numVertices, ids, prevColors, colors);
+    const auto delta = PaintDelta::compress(7, ids, prevColors, colors);
+    ZS_CHECK(delta._primId == 7);
+    ZS_CHECK(delta.numVertices() == numVertices);
+    delta.decompressIds(decodedIds);
+    ZS_CHECK(decodedIds == ids);
+    delta.decompressColors(decoded, /*prev*/ true);
+    ZS_CHECK(bitwise_equal(decoded, prevColors));
+    delta.decompressColors(decoded, /*prev*/ false);
+    ZS_CHECK(bitwise_equal(decoded, colors));
+    /// @note runs actually compress
+    if (numVertices >= 1000) ZS_CHECK(delta.numBytes() < numVertices * sizeof(glm::vec3));
+  }
+}
+
+static PaintHistory::Stroke incompressible_stroke(i32 primId, size_t numVertices) {
+  std::vector<i32> ids(numVertices);
+  std::vector<glm::vec3> prevColors(numVertices), colors(numVertices);
+  for (size_t i = 0; i != numVertices; ++i) {
+    ids[i] = (i32)(i * 2);  // no two consecutive ids
+    prevColors[i] = glm::vec3((float)i);
+    colors[i] = glm::vec3((float)i + 0.5f);
+  }
+  PaintHistory::Stroke stroke;
+  stroke.deltas.push_back(PaintDelta::compress(primId, ids, prevColors, colors));
+  return stroke;
+}
+
+static void check_trimming() {
+  PaintHistory history;
+  ZS_CHECK(history.budget() == ((size_t)64 << 20));
+
+  /// @note about 4MB per stroke, thus the default budget holds 16 of them
+  const size_t numVertices = 100000;
+  const size_t strokeBytes = incompressible_stroke(0, numVertices).numBytes();
+  const i32 numStrokes = 40;
+  for (i32 i = 0; i != numStrokes; ++i) {
+    history.push(incompressible_stroke(i, numVertices));
+    ZS_CHECK(history.numBytes() <= history.budget());
+  }
+  const size_t numKept = history.budget() / strokeBytes;
+  ZS_CHECK(numKept == 16);
+  ZS_CHECK(history.numBytes() == numKept * strokeBytes);
+
+  /// @note the newest strokes are kept, the oldest discarded
+  size_t numUndone = 0;
+  i32 expected = numStrokes - 1;
+  while (auto stroke = history.undo()) {
+    ZS_CHECK(stroke->deltas.size() == 1 && stroke->deltas[0]._primId == expected--);
+    ++numUndone;
+  }
+  ZS_CHECK(numUndone == numKept);
+  ZS_CHECK(!history.canUndo() && history.canRedo());
+  ZS_CHECK(history.numBytes() == numKept * strokeBytes);
+
+  /// @note redo replays in order, a push discards the remaining redo history
+  auto redone = history.redo();
+  ZS_CHECK(redone && redone->deltas[0]._primId == numStrokes - (i32)numKept);
+  history.push(incompressible_stroke(100, numVertices));
+  ZS_CHECK(!history.canRedo());
+  ZS_CHECK(history.numBytes() == 2 * strokeBytes);
+
+  /// @note a smaller budget trims right away, yet the latest stroke is always kept
+  history.setBudget(strokeBytes / 2);
+  ZS_CHECK(history.numBytes() == strokeBytes);
+  auto latest = history.undo();
+  ZS_CHECK(latest && latest->deltas[0]._primId == 100);
+  ZS_CHECK(!history.canUndo());
+}
+
+/// @note the cpu brush path: each dab records the colors the mesh holds, then writes the brush
+/// color back right away. the stroke delta restores the mesh as before the stroke
+static void check_stroke_record(std::mt19937 &rng) {
+  const size_t numPoints = 5000;
+  std::vector<glm::vec3> mesh(numPoints);
+  std::uniform_real_distribution<float> channel(0.f, 1.f);
+  for (auto &c : mesh) c = glm::vec3(channel(rng), channel(rng), channel(rng));
+  const auto original = mesh;
+
+  PaintStrokeRecord record;
+  const glm::vec3 brushColors[] = {{0.8f, 0.1f, 0.1f}, {0.1f, 0.8f, 0.1f}};
+  std::uniform_int_distribution<i32> center(0, (i32)numPoints - 1), radius(0, 60);
+  for (int dab = 0; dab != 64; ++dab) {
+    /// @note overlapping dabs of a changing color, thus vertices are recorded repeatedly
+    const auto color = brushColors[dab / 32];
+    const i32 c = center(rng), r = radius(rng);
+    for (i32 id = std::max(c - r, 0); id <= std::min(c + r, (i32)numPoints - 1); ++id) {
+      record.add(id, mesh[id], color);
+      mesh[id] = color;
+    }
+  }
+  ZS_CHECK(record.ids.size() == record.index.size() && !record.ids.empty());
+
+  std::vector<i32> ids, decodedIds;
+  std::vector<glm::vec3> prevColors, colors, decoded;
+  record.sorted(ids, prevColors, colors);
+  ZS_CHECK(std::is_sorted(std::begin(ids), std::end(ids)));
+  bool latest = true;
+  for (size_t i = 0; i != ids.size(); ++i)
+    latest = latest && std::memcmp(&colors[i], &mesh[ids[i]], sizeof(glm::vec3)) == 0;
+  ZS_CHECK(latest);
+
+  const auto delta = PaintDelta::compress(3, ids, prevColors, colors);
+  delta.decompressIds(decodedIds);
+  delta.decompressColors(decoded, /*prev*/ true);
+  for (size_t i = 0; i != decodedIds.size(); ++i) mesh[decodedIds[i]] = decoded[i];
+  ZS_CHECK(bitwise_equal(mesh, original));
+  delta.decompressColors(decoded, /*prev*/ false);
+  for (size_t i = 0; i != decodedIds.size(); ++i) mesh[decodedIds[i]] = decoded[i];
+  ZS_CHECK(!bitwise_equal(mesh, original) && bitwise_equal(decoded, colors));
+}
+
+int main() {
+  std::mt19937 rng(20240923u);
+  check_round_trip(rng);
+  check_trimming();
+  check_stroke_record(rng);
+  return test::report("paint_history_test");
+}
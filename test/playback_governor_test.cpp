@@ -0,0 +1,139 @@
+#include <cmath>
+#include <vector>
+
+#include "TestCommon.hpp"
+#include "editor/widgets/SequencerPlayback.hpp"
+
+using namespace zs;
+
+/// @note the sequencer loop driven by a fake clock (in milliseconds), with an evaluation of
+/// [evalTime] ms started upon every presented time code
+struct Playback {
+  PlaybackGovernor governor;
+  double now{0.}, interval{40.}, evalTime{0.}, readyAt{0.};
+  TimeCode current{0}, start{0}, end{1000};
+  std::vector<TimeCode> presented;
+  u64 numHeld{0};  // ui frames that kept showing a time code still being evaluated
+
+  void begin() { governor.start(now); }
+  void frame(double dt) {
+    now += dt;
+    const bool ready = now >= readyAt;
+    TimeCode next;
+    if (governor.advance(now, ready, current, start, end, interval, next)) {
+      current = next;
+      presented.push_back(next);
+      readyAt = now + evalTime;
+    } else if (!ready)
+      numHeld++;
+  }
+  void run(int numFrames, double dt) {
+    while (numFrames--) frame(dt);
+  }
+};
+
+static bool consecutive(const std::vector<TimeCode> &tcs, TimeCode first) {
+  for (size_t i = 0; i != tcs.size(); ++i)
+    if (tcs[i] != first + (TimeCode)i) return false;
+  return true;
+}
+
+static void test_default_mode() {
+  PlaybackGovernor governor;
+  ZS_CHECK(governor.mode() == PlaybackGovernor::real_time);
+}
+
+static void test_real_time_keeps_up() {
+  Playback pb;
+  pb.begin();
+  pb.run(100, 10.);
+  /// anchored at the first frame (t = 10), one time code every 4 ui frames
+  ZS_CHECK(pb.presented.size() == 24 && consecutive(pb.presented, 1));
+  ZS_CHECK(pb.governor.numDropped() == 0 && pb.numHeld == 0);
+  ZS_CHECK(pb.governor.numPresented() == pb.presented.size());
+  ZS_CHECK(std::abs(pb.governor.effectiveRate(pb.now) - 24.) < 1e-9);
+}
+
+static void test_real_time_drops() {
+  Playback pb;
+  pb.evalTime = 100.;
+  pb.begin();
+  pb.run(100, 10.);
+  ZS_CHECK(pb.presented.size() > 1);
+  ZS_CHECK(pb.governor.numDropped() > 0 && pb.numHeld > 0);
+  /// every time code up to the latest one is either presented or dropped
+  ZS_CHECK((TimeCode)(pb.governor.numPresented() + pb.governor.numDropped())
+           == pb.presented.back());
+  bool increasing = true;
+  for (size_t i = 1; i < pb.presented.size(); ++i)
+    increasing = increasing && pb.presented[i] > pb.presented[i - 1];
+  ZS_CHECK(increasing);
+  /// still following the wall clock, at most one evaluation behind
+  const TimeCode wallClockTc = std::floor((pb.now - 10.) / pb.interval);
+  ZS_CHECK(pb.presented.back() <= wallClockTc
+           && pb.presented.back() + std::ceil(pb.evalTime / pb.interval) >= wallClockTc);
+}
+
+static void test_every_frame_holds() {
+  Playback pb;
+  pb.evalTime = 100.;
+  pb.governor.setMode(PlaybackGovernor::every_frame);
+  pb.begin();
+  pb.run(100, 10.);
+  ZS_CHECK(pb.presented.size() > 1 && consecutive(pb.presented, 1));
+  ZS_CHECK(pb.governor.numDropped() == 0 && pb.numHeld > 0);
+  ZS_CHECK(pb.governor.effectiveRate(pb.now) < 1000. / pb.interval);
+
+  /// without evaluation delays, at most the target rate
+  Playback fast;
+  fast.governor.setMode(PlaybackGovernor::every_frame);
+  fast.begin();
+  fast.run(100, 10.);
+  ZS_CHECK(consecutive(fast.presented, 1) && fast.numHeld == 0);
+  ZS_CHECK(fast.governor.effectiveRate(fast.now) <= 1000. / fast.interval);
+}
+
+static void test_wrap() {
+  for (auto mode : {PlaybackGovernor::real_time, PlaybackGovernor::every_frame}) {
+    Playback pb;
+    pb.end = 9;
+    pb.governor.setMode(mode);
+    pb.begin();
+    pb.run(400, 10.);
+    /// several loops through [start, end] without repeating or skipping a time code
+    ZS_CHECK(pb.presented.size() > 3 * (size_t)(pb.end + 1) && pb.presented.front() == 1);
+    bool inOrder = true;
+    for (size_t i = 1; i != pb.presented.size(); ++i)
+      inOrder = inOrder
+                && pb.presented[i] == std::fmod(pb.presented[i - 1] + 1, pb.end + 1);
+    ZS_CHECK(inOrder);
+    ZS_CHECK(pb.governor.numDropped() == 0);
+  }
+}
+
+static void test_scrub() {
+  Playback pb;
+  pb.begin();
+  pb.run(20, 10.);
+  const auto numDropped = pb.governor.numDropped();
+  /// the playhead being dragged elsewhere, playback resumes from there
+  pb.current = 500;
+  pb.presented.clear();
+  pb.run(20, 10.);
+  ZS_CHECK(!pb.presented.empty() && consecutive(pb.presented, 501));
+  ZS_CHECK(pb.governor.numDropped() == numDropped);
+
+  /// restarting resets the statistics
+  pb.begin();
+  ZS_CHECK(pb.governor.numPresented() == 0 && pb.governor.numDropped() == 0);
+}
+
+int main() {
+  test_default_mode();
+  test_real_time_keeps_up();
+  test_real_time_drops();
+  test_every_frame_holds();
+  test_wrap();
+  test_scrub();
+  return zs::test::report("playback_governor_test");
+}
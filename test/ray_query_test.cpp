@@ -0,0 +1,84 @@
+#include <random>
+#include <vector>
+
+#include "TestCommon.hpp"
+#include "editor/SceneEditorRayQuery.hpp"
+
+using namespace zs;
+
+/// @note small random triangles around [-1, 1]^3, every 17th of which is degenerate
+static void build_soup(std::mt19937 &rng, u32 numTris, std::vector<glm::vec3> &positions,
+                       std::vector<glm::uvec3> &tris) {
+  std::uniform_real_distribution<float> unit(-1.f, 1.f), jitter(-0.1f, 0.1f);
+  positions.clear();
+  tris.clear();
+  for (u32 i = 0; i != numTris; ++i) {
+    const glm::vec3 c{unit(rng), unit(rng), unit(rng)};
+    const u32 base = (u32)positions.size();
+    positions.push_back(c + glm::vec3{jitter(rng), jitter(rng), jitter(rng)});
+    positions.push_back(c + glm::vec3{jitter(rng), jitter(rng), jitter(rng)});
+    if (i % 17 == 16)
+      positions.push_back(positions[base]);
+    else
+      positions.push_back(c + glm::vec3{jitter(rng), jitter(rng), jitter(rng)});
+    tris.push_back(glm::uvec3{base, base + 1, base + 2});
+  }
+}
+
+static void compare_with_brute_force(const TriangleMeshBvh &mesh, std::mt19937 &rng,
+                                     u32 numRays) {
+  std::uniform_real_distribution<float> unit(-1.f, 1.f);
+  u32 numHits = 0;
+  for (u32 r = 0; r != numRays; ++r) {
+    const glm::vec3 origin = glm::vec3{unit(rng), unit(rng), unit(rng)} * 3.f;
+    /// @note aim at a triangle half of the time, also cover axis-aligned directions
+    glm::vec3 target = glm::vec3{unit(rng), unit(rng), unit(rng)};
+    if (r % 2 == 0) {
+      const auto &tri = mesh.triangles()[r / 2 % mesh.triangles().size()];
+      const auto &ps = mesh.positions();
+      target = (ps[tri[0]] + ps[tri[1]] + ps[tri[2]]) / 3.f;
+    }
+    glm::vec3 dir = target - origin;
+    if (r % 13 == 0) dir = glm::vec3{0.f, 0.f, origin.z > 0.f ? -1.f : 1.f};
+    if (glm::length(dir) == 0.f) continue;
+
+    float tBvh = 1e30f, tRef = 1e30f;
+    u32 triBvh = ~(u32)0, triRef = ~(u32)0;
+    const bool hitBvh = mesh.raycast(origin, dir, tBvh, &triBvh);
+    const bool hitRef = mesh.raycastBruteForce(origin, dir, tRef, &triRef);
+    ZS_CHECK(hitBvh == hitRef);
+    if (hitBvh && hitRef) {
+      ++numHits;
+      /// @note ties (shared edges) may resolve to another triangle at the same distance
+      ZS_CHECK(tBvh == tRef);
+    }
+  }
+  ZS_CHECK(numHits > 0);
+}
+
+int main() {
+  std::mt19937 rng(20240917u);
+  std::vector<glm::vec3> positions;
+  std::vector<glm::uvec3> tris;
+
+  for (u32 numTris : {1u, 3u, 64u, 1000u}) {
+    build_soup(rng, numTris, positions, tris);
+    TriangleMeshBvh mesh;
+    mesh.assign(positions, tris);
+    compare_with_brute_force(mesh, rng, 500);
+
+    /// @note same topology, moved points: the bvh is refitted
+    std::uniform_real_distribution<float> offset(-0.3f, 0.3f);
+    for (auto &p : positions) p = p + glm::vec3{offset(rng), offset(rng), offset(rng)};
+    mesh.assign(positions, tris);
+    compare_with_brute_force(mesh, rng, 500);
+  }
+
+  {
+    TriangleMeshBvh mesh;
+    float t = 1e30f;
+    ZS_CHECK(!mesh.raycast(glm::vec3{0.f}, glm::vec3{0.f, 0.f, 1.f}, t));
+  }
+
+  return test::report("ray_query_test");
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestCommon.hpp"
+#include "editor/widgets/TermWidgetLogIndex.hpp"
+
+using namespace zs;
+
+static constexpr size_t s_num_lines = 1000000;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since)
+      .count();
+}
+
+/// @note log-like lines: a severity, a few words from a vocabulary and a counter
+static std::vector<std::string> generate_log(size_t numLines, std::vector<u32> &types) {
+  const char *words[] = {"load",    "usd",     "stage",   "prim",     "mesh",    "shader",
+                         "compile", "texture", "upload",  "frame",    "python",  "execute",
+                         "node",    "graph",   "link",    "pin",      "evaluate", "cache",
+                         "timeline", "scene",  "camera",  "light",    "buffer",  "vulkan"};
+  constexpr size_t numWords = sizeof(words) / sizeof(words[0]);
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<size_t> pick(0, numWords - 1), length(3, 9);
+  std::uniform_int_distribution<int> severity(0, 99);
+  std::vector<std::string> lines(numLines);
+  types.resize(numLines);
+  for (size_t i = 0; i != numLines; ++i) {
+    /// @note rare errors (type 2), with a distinctive message every now and then
+    const int s = severity(rng);
+    types[i] = s == 0 ? 2 : (s < 10 ? 1 : 0);
+    auto &line = lines[i];
+    line = types[i] == 2 ? "[error] " : "[info] ";
+    for (size_t n = length(rng); n--;) {
+      line += words[pick(rng)];
+      line += ' ';
+    }
+    if (types[i] == 2 && i % 7 == 0) line += "Segmentation Fault in worker ";
+    line += std::to_string(i);
+    line += '\n';
+  }
+  return lines;
+}
+
+/// @note pages holding an entry containing [literal] (ascii case-insensitive)
+static std::vector<u32> brute_force_pages(const std::vector<std::string> &lines,
+                                          std::string literal, u32 firstPage) {
+  auto lower = [](std::string s) {
+    for (auto &c : s) c = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    return s;
+  };
+  literal = lower(literal);
+  std::vector<u32> pages;
+  for (size_t i = (size_t)firstPage << TermLogIndex::s_page_bits; i < lines.size(); ++i)
+    if (lower(lines[i]).find(literal) != std::string::npos) {
+      const u32 page = (u32)(i >> TermLogIndex::s_page_bits);
+      if (pages.empty() || pages.back() != page) pages.push_back(page);
+    }
+  return pages;
+}
+
+static bool includes(const std::vector<u32> &sup, const std::vector<u32> &sub) {
+  return std::includes(sup.begin(), sup.end(), sub.begin(), sub.end());
+}
+
+static void bench_queries(const std::vector<std::string> &lines, const std::vector<u32> &types) {
+  TermLogIndex index;
+  auto t = std::chrono::steady_clock::now();
+  for (size_t i = 0; i != lines.size(); ++i) index.append(i, lines[i], types[i]);
+  std::printf("indexed %zu lines (%u pages, %zu postings) in %.1f ms\n", lines.size(),
+              index.numPages(), index.numPostings(), elapsed_ms(t));
+  ZS_CHECK(index.firstPage() == 0);
+  ZS_CHECK(index.numPages() == (u32)((lines.size() - 1) >> TermLogIndex::s_page_bits) + 1);
+
+  const char *queries[] = {"segmentation fault", "vulkan", "texture upload", "999999", "zzzz"};
+  for (auto query : queries) {
+    TermLogIndex::PageList pages;
+    t = std::chrono::steady_clock::now();
+    const bool restricted = index.candidatePages(query, pages);
+    const double indexed = elapsed_ms(t);
+    t = std::chrono::steady_clock::now();
+    const auto expected = brute_force_pages(lines, query, 0);
+    const double scanned = elapsed_ms(t);
+    std::printf("  [%s]: %zu candidate pages in %.3f ms, %zu matching pages (scan) in %.1f ms\n",
+                query, pages.size(), indexed, expected.size(), scanned);
+    ZS_CHECK(restricted && includes(pages, expected));
+  }
+
+  /// regex and severity filters
+  TermLogIndex::PageList pages;
+  const auto literals = TermLogIndex::regex_required_literals("segmentation\\s+fault in (\\w+)");
+  ZS_CHECK(index.candidatePagesAll(literals, pages));
+  /// @note every match in the generated log is separated by a single space
+  ZS_CHECK(!pages.empty());
+  ZS_CHECK(includes(pages, brute_force_pages(lines, "segmentation fault in", 0)));
+  /// @note the arguments of \xhh, \uhhhh and \cX are not part of any literal
+  ZS_CHECK((TermLogIndex::regex_required_literals("foo\\x41bar")
+            == std::vector<std::string>{"foo", "bar"}));
+  ZS_CHECK((TermLogIndex::regex_required_literals("\\u00e9tape\\cJabc")
+            == std::vector<std::string>{"tape", "abc"}));
+  ZS_CHECK((TermLogIndex::regex_required_literals("(in)\\12345")
+            == std::vector<std::string>{}));
+  ZS_CHECK(index.candidatePagesAll(
+      TermLogIndex::regex_required_literals("segmentation\\x20fault\\u0020in"), pages));
+  ZS_CHECK(includes(pages, brute_force_pages(lines, "segmentation fault in", 0)));
+  u32 numErrorPages = 0;
+  for (u32 page = 0; page != index.numPages(); ++page)
+    numErrorPages += (index.pageTypeMask(page) & TermLogIndex::type_bit(2)) != 0;
+  std::printf("  %u of %u pages hold errors\n", numErrorPages, index.numPages());
+  ZS_CHECK(numErrorPages > 0 && numErrorPages < index.numPages());
+
+  /// pruning drops the postings of the leading pages
+  const size_t numPostings = index.numPostings();
+  const u32 half = index.numPages() / 2;
+  index.prune(half);
+  ZS_CHECK(index.firstPage() == half && index.numPostings() < numPostings);
+  ZS_CHECK(index.pageTypeMask(0) == ~(u32)0);
+  ZS_CHECK(index.candidatePages("vulkan", pages));
+  ZS_CHECK(!pages.empty() && pages.front() >= half);
+  ZS_CHECK(includes(pages, brute_force_pages(lines, "vulkan", half)));
+}
+
+static void test_capped(const std::vector<std::string> &lines, const std::vector<u32> &types) {
+  constexpr u32 maxPages = 256;
+  TermLogIndex index{maxPages};
+  size_t maxPostings = 0;
+  for (size_t i = 0; i != lines.size(); ++i) {
+    index.append(i, lines[i], types[i]);
+    maxPostings = std::max(maxPostings, index.numPostings());
+  }
+  ZS_CHECK(index.numPages() - index.firstPage() <= maxPages + maxPages / 4);
+  ZS_CHECK(index.numPages() - index.firstPage() >= maxPages);
+  std::printf("capped at %u pages: at most %zu postings\n", maxPages, maxPostings);
+  TermLogIndex::PageList pages;
+  ZS_CHECK(index.candidatePages("segmentation fault", pages));
+  ZS_CHECK(pages.empty() || pages.front() >= index.firstPage());
+  ZS_CHECK(includes(pages, brute_force_pages(lines, "segmentation fault", index.firstPage())));
+
+  index.clear();
+  ZS_CHECK(index.firstPage() == 0 && index.numPages() == 0 && index.numPostings() == 0);
+}
+
+int main() {
+  std::vector<u32> types;
+  const auto lines = generate_log(s_num_lines, types);
+  bench_queries(lines, types);
+  test_capped(lines, types);
+  return zs::test::report("term_log_index_bench");
+}
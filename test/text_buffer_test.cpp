@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestCommon.hpp"
+#include "editor/widgets/TextEditorBuffer.hpp"
+
+using namespace zs;
+
+static constexpr size_t s_num_lines = 100000;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since)
+      .count();
+}
+
+/// @note short fragments, frequently holding line breaks
+static std::string random_text(std::mt19937 &rng) {
+  const char *fragments[] = {"a", "def ", "\n", "x = 1\n", "    ", "\"\"\"", "\n\n", "# c", "é"};
+  std::uniform_int_distribution<size_t> pick(0, 8), count(1, 4);
+  std::string ret;
+  for (size_t n = count(rng); n--;) ret += fragments[pick(rng)];
+  return ret;
+}
+
+static std::string python_source(size_t numLines) {
+  std::string ret;
+  for (size_t i = 0; i != numLines; ++i)
+    ret += i % 4 == 0 ? "def f" + std::to_string(i) + "(x):\n" : "    x = x * 2 + 1  # step\n";
+  return ret;
+}
+
+/// @note line layout of [text] derived from scratch
+static bool same_lines(const TextPieceTable &table, const std::string &text,
+                       std::mt19937 &rng) {
+  std::vector<size_t> begins{0};
+  for (size_t i = 0; i != text.size(); ++i)
+    if (text[i] == '\n') begins.push_back(i + 1);
+  if (table.numLines() != begins.size()) return false;
+  std::uniform_int_distribution<size_t> pickLine(0, begins.size() - 1);
+  for (int n = 0; n != 16; ++n) {
+    const size_t line = pickLine(rng);
+    const size_t end = line + 1 < begins.size() ? begins[line + 1] - 1 : text.size();
+    if (table.lineBegin(line) != begins[line] || table.lineEnd(line) != end) return false;
+    if (table.lineOf(begins[line]) != line || table.lineOf(end) != line) return false;
+  }
+  return true;
+}
+
+static void test_random_edits() {
+  std::mt19937 rng(31);
+  for (const std::string initial : {std::string{}, std::string{"line0\nline1\n"}}) {
+    TextPieceTable table{initial};
+    std::string model = initial;
+    bool sameText = true, sameLines = true, sameChars = true;
+    for (int i = 0; i != 4000; ++i) {
+      std::uniform_int_distribution<size_t> pickPos(0, model.size());
+      const size_t pos = pickPos(rng);
+      if (rng() % 3 != 0 || model.empty()) {
+        const auto text = random_text(rng);
+        table.insert(pos, text);
+        model.insert(pos, text);
+      } else {
+        std::uniform_int_distribution<size_t> pickLen(0, 24);
+        const size_t len = pickLen(rng);
+        table.erase(pos, len);
+        model.erase(std::min(pos, model.size()), len);
+      }
+      if (table.size() != model.size()) {
+        sameText = false;
+        break;
+      }
+      if (i % 97 == 0) sameText = sameText && table.text() == model;
+      if (i % 13 == 0) sameLines = sameLines && same_lines(table, model, rng);
+      if (!model.empty()) {
+        const size_t at = pickPos(rng) % model.size();
+        sameChars = sameChars && table.at(at) == model[at];
+        std::string range;
+        table.copyRange(at, 7, range);
+        sameChars = sameChars && range == model.substr(at, 7);
+      }
+    }
+    ZS_CHECK(sameText && table.text() == model);
+    ZS_CHECK(sameLines && same_lines(table, model, rng));
+    ZS_CHECK(sameChars);
+  }
+
+  /// out-of-range positions are clamped
+  TextPieceTable table{"ab"};
+  table.insert(100, "c");
+  table.erase(1, 100);
+  table.erase(5, 1);
+  ZS_CHECK(table.text() == "a" && table.numLines() == 1 && table.at(1) == '\0');
+}
+
+static void test_document_undo_redo() {
+  std::mt19937 rng(7);
+  TextDocument doc;
+  const std::string initial = python_source(64);
+  doc.assign(initial);
+  std::vector<std::string> states{initial};
+  for (int i = 0; i != 300; ++i) {
+    std::uniform_int_distribution<size_t> pickPos(0, doc._text.size());
+    const size_t pos = pickPos(rng);
+    const size_t len = std::min<size_t>(rng() % 16, doc._text.size() - pos);
+    doc.replace(pos, len, random_text(rng));
+    states.push_back(doc._text.text());
+    /// keep the lexer states settled, as the editor does for the displayed lines
+    const size_t line = doc._text.lineOf(pos);
+    std::string lineText;
+    doc._text.copyRange(doc._text.lineBegin(line),
+                        doc._text.lineEnd(line) - doc._text.lineBegin(line), lineText);
+    doc._highlighter.lineTokens(doc._text, line, lineText);
+  }
+  ZS_CHECK(doc.unsynced());
+
+  /// every state is restored exactly, in both directions
+  bool restored = true;
+  for (size_t i = states.size() - 1; i-- > 0;)
+    restored = restored && doc.undo() && doc._text.text() == states[i];
+  ZS_CHECK(restored && !doc.undo());
+  for (size_t i = 1; i != states.size(); ++i)
+    restored = restored && doc.redo() && doc._text.text() == states[i];
+  ZS_CHECK(restored && !doc.redo());
+
+  /// consecutive typing is undone at once
+  doc.assign("x");
+  for (char c : std::string{"yz"}) {
+    doc._cursor = doc._anchor = doc._text.size();
+    doc.replaceSelection(std::string_view{&c, 1}, true);
+  }
+  ZS_CHECK(doc._text.text() == "xyz" && doc.undo() && doc._text.text() == "x" && !doc.undo());
+}
+
+/// @note typing, deleting and navigating throughout a 100k-line script, compared with the same
+/// edits on a flat string
+static void bench_large_document() {
+  std::mt19937 rng(100);
+  const std::string source = python_source(s_num_lines);
+  constexpr int numEdits = 4000;
+  TextDocument doc;
+  auto t = std::chrono::steady_clock::now();
+  doc.assign(source);
+  doc._undoLimit = numEdits;
+  std::printf("loaded %zu lines (%zu bytes) in %.1f ms\n", doc._text.numLines() - 1,
+              source.size(), elapsed_ms(t));
+
+  std::vector<size_t> lines(numEdits / 8);
+  std::uniform_int_distribution<size_t> pickLine(0, s_num_lines - 1);
+  for (auto &line : lines) line = pickLine(rng);
+
+  std::string model = source;
+  t = std::chrono::steady_clock::now();
+  size_t checksum = 0;
+  for (int i = 0; i != numEdits; ++i) {
+    /// a burst of typing on a random line, then a backspace
+    const size_t pos = doc._text.lineBegin(lines[i / 8]) + 4;
+    if (i % 8 == 7) {
+      doc.replace(pos - 1, 1, "");
+    } else {
+      doc._cursor = doc._anchor = pos;
+      doc.replaceSelection("y", true);
+    }
+    checksum += doc._text.lineOf(pos);
+  }
+  const double edited = elapsed_ms(t);
+
+  t = std::chrono::steady_clock::now();
+  for (int i = 0; i != numEdits; ++i) {
+    size_t pos = 0;
+    for (size_t line = lines[i / 8]; line--;) pos = model.find('\n', pos) + 1;
+    pos += 4;
+    if (i % 8 == 7)
+      model.erase(pos - 1, 1);
+    else
+      model.insert(pos, "y");
+  }
+  const double flat = elapsed_ms(t);
+  std::printf("  %d edits: %.1f ms (piece table), %.1f ms (flat string)\n", numEdits, edited,
+              flat);
+  ZS_CHECK(doc._text.text() == model && checksum > 0);
+
+  t = std::chrono::steady_clock::now();
+  while (doc.undo());
+  std::printf("  undone in %.1f ms\n", elapsed_ms(t));
+  ZS_CHECK(doc._text.text() == source);
+}
+
+int main() {
+  test_random_edits();
+  test_document_undo_redo();
+  bench_large_document();
+  return zs::test::report("text_buffer_test");
+}
@@ -0,0 +1,169 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestCommon.hpp"
+#include "editor/widgets/TreeWidgetPaths.hpp"
+
+using namespace zs;
+using ui::TreePathTable;
+
+static constexpr int s_num_frames = 20;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since)
+      .count();
+}
+
+/// @note the parts of a tree node the paths and the visible order depend on
+struct SyntheticNode {
+  u32 _parent;
+  std::string _label;
+  std::vector<u32> _children;
+  u32 _indexInParent{0};
+  TreePathTable::handle_t _pathHandle{TreePathTable::s_root};
+};
+
+struct SyntheticTree {
+  std::vector<SyntheticNode> _nodes;
+  TreePathTable _paths;
+
+  SyntheticTree() { _nodes.push_back(SyntheticNode{0, ""}); }
+  /// @note the path is interned upon creation, as TreeNodeBase does upon labelling
+  u32 addChild(u32 parent, std::string label) {
+    const u32 id = (u32)_nodes.size();
+    _nodes.push_back(SyntheticNode{parent, std::move(label)});
+    auto &node = _nodes.back();
+    node._indexInParent = (u32)_nodes[parent]._children.size();
+    node._pathHandle = _paths.intern(_nodes[parent]._pathHandle, node._label);
+    _nodes[parent]._children.push_back(id);
+    return id;
+  }
+  u32 depth(u32 id) const {
+    u32 d = 0;
+    for (; id; id = _nodes[id]._parent) ++d;
+    return d;
+  }
+};
+
+/// @note a binary tree of [levels] levels, each leaf extended by a chain of [chain] nodes,
+/// with prim-like labels
+static void build_deep_tree(SyntheticTree &tree, u32 levels, u32 chain) {
+  std::vector<u32> frontier{0};
+  for (u32 l = 0; l != levels; ++l) {
+    std::vector<u32> next;
+    for (auto id : frontier)
+      for (int c = 0; c != 2; ++c)
+        next.push_back(tree.addChild(id, "Xform_" + std::to_string(l) + "_" + std::to_string(c)));
+    frontier = std::move(next);
+  }
+  for (auto id : frontier)
+    for (u32 c = 0; c != chain; ++c) id = tree.addChild(id, "Mesh_" + std::to_string(c));
+}
+
+/// @note what painting did before: assembling every path from the labels, every frame
+static size_t assemble_paths(const SyntheticTree &tree, u32 id, const std::string &path) {
+  size_t checksum = path.size();
+  for (auto ch : tree._nodes[id]._children)
+    checksum += assemble_paths(tree, ch, path + "/" + tree._nodes[ch]._label);
+  return checksum;
+}
+
+static size_t interned_paths(const SyntheticTree &tree) {
+  size_t checksum = 0;
+  for (const auto &node : tree._nodes) checksum += tree._paths.path(node._pathHandle).size();
+  return checksum;
+}
+
+static void bench_paths() {
+  SyntheticTree tree;
+  auto t = std::chrono::steady_clock::now();
+  build_deep_tree(tree, 12, 20);
+  const double built = elapsed_ms(t);
+  std::printf("built %zu nodes of depth %u, %zu interned paths in %.1f ms\n", tree._nodes.size(),
+              tree.depth((u32)tree._nodes.size() - 1), tree._paths.size(), built);
+  ZS_CHECK(tree._paths.size() == tree._nodes.size());
+
+  size_t assembled = 0, interned = 0;
+  t = std::chrono::steady_clock::now();
+  for (int f = 0; f != s_num_frames; ++f) assembled += assemble_paths(tree, 0, "");
+  const double assembling = elapsed_ms(t) / s_num_frames;
+  t = std::chrono::steady_clock::now();
+  for (int f = 0; f != s_num_frames; ++f) interned += interned_paths(tree);
+  const double interning = elapsed_ms(t) / s_num_frames;
+  std::printf("  per frame: %.3f ms (assembled paths), %.3f ms (interned paths)\n", assembling,
+              interning);
+  ZS_CHECK(assembled == interned);
+
+  /// the interned paths are exactly the assembled ones, and resolve back to their nodes
+  std::mt19937 rng(34);
+  std::uniform_int_distribution<u32> pick(1, (u32)tree._nodes.size() - 1);
+  bool consistent = true;
+  for (int i = 0; i != 1000; ++i) {
+    u32 id = pick(rng);
+    const auto handle = tree._nodes[id]._pathHandle;
+    std::string path;
+    for (; id; id = tree._nodes[id]._parent) path = "/" + tree._nodes[id]._label + path;
+    TreePathTable::handle_t found;
+    consistent = consistent && tree._paths.path(handle) == path
+                 && tree._paths.find(path, found) && found == handle;
+  }
+  ZS_CHECK(consistent);
+}
+
+/// @note stepping to the next sibling across a wide level, as the visible order traversal does
+static void bench_sibling_index() {
+  SyntheticTree tree;
+  constexpr u32 numChildren = 20000;
+  for (u32 i = 0; i != numChildren; ++i) tree.addChild(0, "Prim_" + std::to_string(i));
+  const auto &siblings = tree._nodes[0]._children;
+
+  auto t = std::chrono::steady_clock::now();
+  size_t scanned = 0;
+  for (auto id : siblings) {
+    u32 idx = 0;
+    while (siblings[idx] != id) ++idx;
+    scanned += idx;
+  }
+  const double scanning = elapsed_ms(t);
+  t = std::chrono::steady_clock::now();
+  size_t stored = 0;
+  for (auto id : siblings) stored += tree._nodes[id]._indexInParent;
+  const double storing = elapsed_ms(t);
+  std::printf("%u siblings: %.3f ms (searched index), %.3f ms (stored index)\n", numChildren,
+              scanning, storing);
+  ZS_CHECK(scanned == stored);
+}
+
+static void test_binding() {
+  TreePathTable paths;
+  ZS_CHECK(paths.path(TreePathTable::s_root).empty() && paths.size() == 1);
+  const auto a = paths.intern(TreePathTable::s_root, "a");
+  const auto b = paths.intern(a, "b");
+  ZS_CHECK(paths.intern(a, "b") == b && paths.path(b) == "/a/b" && paths.size() == 3);
+  TreePathTable::handle_t found;
+  ZS_CHECK(!paths.find("/a/c", found));
+
+  /// @note only compared, never dereferenced
+  int dummies[2];
+  auto n0 = reinterpret_cast<ui::TreeNodeBase *>(&dummies[0]);
+  auto n1 = reinterpret_cast<ui::TreeNodeBase *>(&dummies[1]);
+  ZS_CHECK(paths.node(b) == nullptr);
+  paths.bind(b, n0);
+  ZS_CHECK(paths.node(b) == n0);
+  /// a node no longer holding the path does not unbind its successor
+  paths.bind(b, n1);
+  paths.unbind(b, n0);
+  ZS_CHECK(paths.node(b) == n1);
+  paths.unbind(b, n1);
+  ZS_CHECK(paths.node(b) == nullptr);
+}
+
+int main() {
+  bench_paths();
+  bench_sibling_index();
+  test_binding();
+  return zs::test::report("tree_path_bench");
+}
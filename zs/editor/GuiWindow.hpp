@@ -173,6 +173,9 @@ namespace zs {
       /// WORLD (all temp)
       std::map<std::string, Shared<ge::Graph>> graphs;
       Shared<Terminal> terminal;
+      /// @note python executions seen so far, the displayed objects are refreshed after each
+      u64 numTerminalExecutions{0};
+      bool pyTaskInProgress{false};
       // std::vector<ZsVar> sceneData;
 
       std::optional<std::string> dialogLabel;
@@ -368,6 +368,28 @@ namespace zs {
                 }
               };
             })
+        .appendItemWithAction(
+            (const char *)ICON_MD_WIDGETS u8"导入模型",
+            [&dialogLabel = this->states.dialogLabel,
+             &dialogCallback = this->states.dialogCallback]() {
+              IGFD::FileDialogConfig config;
+              config.path = ".";
+              config.countSelectionMax = 1;
+              config.flags = ImGuiFileDialogFlags_Modal;
+              dialogLabel = (const char *)u8"模型对话框";
+              ImGuiFileDialog::Instance()->OpenDialog((const char *)u8"模型对话框",
+                                                      (const char *)u8"选择文件", ".obj", config);
+              dialogCallback = [&dialogLabel]() {
+                if (ImGuiFileDialog::Instance()->IsOk()) {  // action if OK
+                  std::string filePathName = ImGuiFileDialog::Instance()->GetFilePathName();
+                  /// @note listed in the asset browser, previewed through its thumbnail
+                  if (auto browser = ResourceSystem::get_widget_ptr<AssetBrowserComponent>(
+                          g_defaultWidgetLabelAssetBrowser))
+                    browser->appendItem(filePathName, AssetEntry::type_e::mesh_);
+                  dialogLabel = {};
+                }
+              };
+            })
         .appendMenu((const char *)ICON_MD_ADD u8"新建")
         .appendItemWithAction((const char *)ICON_MD_REFRESH u8"重新加载",
                               [&graphs = states.graphs]() {
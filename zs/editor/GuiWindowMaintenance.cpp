@@ -210,6 +210,17 @@ namespace zs {
 
     states.sceneEditor.get().update(io.DeltaTime);
 
+    /// @note console statements and scripts may modify the graph contents in place
+    {
+      const bool pyTaskInProgress = PyExecSystem::instance().inProgress();
+      const u64 numExecutions = states.terminal ? states.terminal->_numExecuted : 0;
+      if ((states.pyTaskInProgress && !pyTaskInProgress)
+          || numExecutions != states.numTerminalExecutions)
+        for (auto &[name, graph] : states.graphs) graph->markDirty();
+      states.pyTaskInProgress = pyTaskInProgress;
+      states.numTerminalExecutions = numExecutions;
+    }
+
     ImGui::PushFont((ImFont *)ImguiSystem::get_font(ImguiSystem::cn_font));
     ImGuizmo::BeginFrame();
 
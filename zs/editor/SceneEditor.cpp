@@ -199,6 +199,8 @@ layout (set = 1, binding = 0) readonly buffer LightList {
   LightInfo lights[];
 };
 layout (set = 1, binding = 1) readonly buffer ClusterLightIndexInfo {
+  // [2k, 2k + 1]: offset (into lightIndices) and size of the light list of cluster k,
+  // followed by the pool of light indices
   int lightIndices[];
 };
 layout (set = 1, binding = 2) uniform LightClusterParam {
@@ -291,11 +293,12 @@ void main() {
   context.a = roughness * roughness;
   context.a2 = context.a * context.a;
 
-  int cid_base = getClusterIndex() << 6;
-  int sizeOfClusterLights = lightIndices[cid_base];
+  int cid = getClusterIndex();
+  int clusterLightOffset = lightIndices[cid * 2];
+  int sizeOfClusterLights = lightIndices[cid * 2 + 1];
   outFragColor.rgb = vec3(0.0);
-  for (int i = 1; i <= sizeOfClusterLights; ++i){
-    int lid = lightIndices[cid_base + i];
+  for (int i = 0; i < sizeOfClusterLights; ++i){
+    int lid = lightIndices[clusterLightOffset + i];
     outFragColor.rgb += CookTorrance(lights[lid], context);
   }
 
@@ -467,6 +470,8 @@ layout (set = 2, binding = 0) readonly buffer LightList {
   LightInfo lights[];
 };
 layout (set = 2, binding = 1) readonly buffer ClusterLightIndexInfo {
+  // [2k, 2k + 1]: offset (into lightIndices) and size of the light list of cluster k,
+  // followed by the pool of light indices
   int lightIndices[];
 };
 layout (set = 2, binding = 2) uniform LightClusterParam {
@@ -571,11 +576,12 @@ void main()
   context.albedo = clr;
   context.lambert = clr * invPI;
 
-  int cid_base = getClusterIndex() << 6;
-  int sizeOfClusterLights = lightIndices[cid_base];
+  int cid = getClusterIndex();
+  int clusterLightOffset = lightIndices[cid * 2];
+  int sizeOfClusterLights = lightIndices[cid * 2 + 1];
   outFragColor.rgb = vec3(0.0);
-  for (int i = 1; i <= sizeOfClusterLights; ++i){
-    int lid = lightIndices[cid_base + i];
+  for (int i = 0; i < sizeOfClusterLights; ++i){
+    int lid = lightIndices[clusterLightOffset + i];
     outFragColor.rgb += CookTorrance(lights[lid], context);
   }
   outFragColor.a = 1.0;
@@ -814,6 +820,7 @@ void main()
       primIdToVisPrimId.clear();
       currentVisiblePrimsDrawn.clear();
       sceneLighting.lightList.clear();
+      sceneLighting.lightListVersion++;
       // i32 visCnt = 0;
       for (auto &&prim : currentVisiblePrimsSet) {
         auto p = prim.lock();
@@ -856,7 +863,8 @@ void main()
     sceneRenderer.fragShader
         = ctx.createShaderModuleFromGlsl(g_mesh_pbr_frag_code /*g_mesh_frag_code*/,
                                          vk::ShaderStageFlagBits::eFragment, "default_mesh_frag");
-    ctx.acquireSet(sceneRenderer.fragShader.get().layout(1), sceneLighting.lightTableSet);
+    for (auto &frame : sceneLighting.frames)
+      ctx.acquireSet(sceneRenderer.fragShader.get().layout(1), frame.lightTableSet);
 
     // texture
     ResourceSystem::load_shader(ctx, "default_texture_preview.vert",
@@ -1016,7 +1024,8 @@ void main()
       auto &texturePreviewVertShader = ResourceSystem::get_shader("default_texture_preview.vert");
       auto &texturePreviewFragShader = ResourceSystem::get_shader("default_texture_preview.frag");
 #if USE_SCENE_LIGHTING
-      ctx.acquireSet(texturePreviewFragShader.layout(2), sceneLighting.lightTableSet);
+      for (auto &frame : sceneLighting.frames)
+        ctx.acquireSet(texturePreviewFragShader.layout(2), frame.lightTableSet);
 #endif
 
       sceneRenderer.bindlessPipeline
@@ -1598,6 +1607,8 @@ void main()
       isCulledByFrustum[prim] = currentVisiblePrimsCulledByFrustum[i];
 #endif
     }
+    /// @note world bounds are updated, the ray query bvh is refitted upon the next query
+    sceneRayQuery.primBvhDirty = true;
 
     numFrameRenderModels = renderingModelsInFrame;
   }
@@ -1936,7 +1947,8 @@ void main()
               /*pipeline layout*/ sceneRenderer.opaquePipeline.get(),
               /*firstSet*/ 0,
 #if USE_SCENE_LIGHTING
-              /*descriptor sets*/ {sceneRenderData.sceneCameraSet, sceneLighting.lightTableSet},
+              /*descriptor sets*/
+              {sceneRenderData.sceneCameraSet, sceneLighting.currentFrame().lightTableSet},
 #else
               /*descriptor sets*/ {sceneRenderData.sceneCameraSet},
 #endif
@@ -1975,7 +1987,8 @@ void main()
               /*firstSet*/ 0,
               /*descriptor sets*/
 #if USE_SCENE_LIGHTING
-              {sceneRenderData.sceneCameraSet, bindlessSet, sceneLighting.lightTableSet},
+              {sceneRenderData.sceneCameraSet, bindlessSet,
+               sceneLighting.currentFrame().lightTableSet},
 #else
               {sceneRenderData.sceneCameraSet, bindlessSet},
 #endif
@@ -1,9 +1,13 @@
 #pragma once
 #include <latch>
 #include <optional>
+#include <unordered_map>
 
 #include "IconsMaterialDesign.h"
 #include "editor/ImguiRenderer.hpp"
+#include "editor/SceneEditorPaintBrush.hpp"
+#include "editor/SceneEditorPaintHistory.hpp"
+#include "editor/SceneEditorRayQuery.hpp"
 #include "editor/widgets/WidgetComponent.hpp"
 #include "imgui.h"
 #include "widgets/SceneWidgetComponent.hpp"
@@ -138,11 +142,31 @@ namespace zs {
     std::optional<glm::uvec2> paintCenter{};
     glm::vec3 paintColor{0.8f, 0.1f, 0.1f};
     float paintRadius = 10.f;
+    float paintOpacity = 1.f;
+    float paintHardness = 1.f;  // fraction of the radius painted at full opacity
+    /// @note the compute brush (soft, translucent) uploads its dabs as the ranged cpu path does
+    bool paintOnGpu = true;
+
+    /// @note usages the VkModel buffers are created with, which the buffer does not report.
+    /// VkModel fills its vertex buffers through a staging copy, thus they are transfer
+    /// destinations as well. paths binding them beyond these (transfer source, storage) are only
+    /// taken if declared here, and otherwise fall back to the zsmesh
+    vk::BufferUsageFlags modelBufferUsage
+        = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst;
+    bool modelBufferSupports(vk::BufferUsageFlags usage) const noexcept {
+      return (modelBufferUsage & usage) == usage;
+    }
 
     zs::vec<float, 2> canvasLocalMousePos;
 
     glm::vec3 getScreenPointCameraRayDirection() const;
     glm::vec3 getCameraPosition() const noexcept { return -sceneRenderData.camera.get().position; }
+    /// @note closest hit of the ray (in world space) with the prim, through its cached mesh bvh
+    bool getRayIntersectionWithPrim(const glm::vec3 &origin, const glm::vec3 &dir,
+                                    ZsPrimitive &prim, glm::vec3 *hitPt = nullptr);
+    /// @note closest visible prim hit by the ray, culled by the bvh over their world bounds
+    ZsPrimitive *pickPrimByRay(const glm::vec3 &origin, const glm::vec3 &dir,
+                               glm::vec3 *hitPt = nullptr);
 
     int numFrameRenderModels;
     float framePerSecond = 0.0f;
@@ -389,18 +413,39 @@ namespace zs {
       vk::DescriptorSet overlayFontSet;
       Owner<ImageSampler> sampler;
       VkTexture fontTexture;
-      u32 numLetters;
+      u32 numLabels{0}, numLetters{0};
 
       /// wireframe
       // Owner<ShaderModule> wiredVertShader, wiredFragShader;
       Owner<Pipeline> wiredPipeline;
 
       /// overlay text generation (compute)
+      /// @note glyphs are generated in object space, thus only upon focus or geometry changes.
+      /// set [overlayTextNeedUpdate] when the vertices are modified in place.
       // Owner<ShaderModule> genTextShader;
       Owner<Pipeline> genTextPipeline;
       Owner<Buffer> fontTemplateBuffer;  // stb_fontdata
       vk::DescriptorSet textGenSet;
       bool overlayTextNeedUpdate = true;
+      const VkModel *overlayTextModel{nullptr};
+      PrimIndex overlayTextPrimId{-1};
+      u32 overlayTextVertexCount{0};
+      TimeCode overlayTextTimeCode;
+      /// @note copied from the zsmesh points (host visible) upon generation
+      Owner<Buffer> overlayTextPositionBuffer;
+      u32 overlayTextPositionCapacity{0};
+      /// @note if the zsmesh points do not map onto the model vertices, the labels of the visible
+      /// vertices are generated in screen space from the pick buffer, thus upon camera motion
+      /// as well
+      Owner<Pipeline> genScreenTextPipeline;
+      vk::DescriptorSet textScreenGenSet;
+      bool overlayTextScreenSpace{false};
+      glm::mat4 overlayTextMvp{0.f};
+
+      /// overlay text screen-space density culling (compute), every frame
+      Owner<Pipeline> cullTextPipeline;
+      vk::DescriptorSet textCullSet;
+      Owner<Buffer> overlayTextCellBuffer;  // (nearest depth, label) per cell
 
       // Owner<Buffer> textPosBuffer, textUvBuffer;
       Owner<Buffer> overlayTextBuffer, counterBuffer;
@@ -410,6 +455,18 @@ namespace zs {
       Owner<Buffer> selectedIndicesBuffer;
       vk::DescriptorSet selectionSet;
 
+      /// box selection, deduplicated and sorted on the gpu, then read back asynchronously.
+      /// the bitset holds one segment per selectable prim (the focused one, or all visible ones)
+      Owner<Pipeline> selectionCompactPipeline;
+      vk::DescriptorSet selectionCompactSet;
+      Owner<Buffer> selectionBitsBuffer, selectionGroupSumsBuffer, selectionSegmentsBuffer;
+      Owner<Buffer> selectionResultBuffer, selectionResultCounterBuffer;
+      u32 selectionCapacity;         // number of elements covered by the bitset
+      u32 selectionSegmentCapacity;  // number of segments
+      Owner<VkCommand> selectionCmd;
+      Owner<Fence> selectionFence;
+      bool selectionPending;
+
       Owner<Pipeline> paintPipeline;
       vk::DescriptorSet paintSet;
 
@@ -474,24 +531,48 @@ namespace zs {
     };
 
     struct SceneLighting {
-      Owner<Pipeline> clusterLightPipeline;
-      vk::DescriptorSet clusterLightingSet;
-      vk::DescriptorSet lightTableSet;
+      static const size_t CLUSTER_SCREEN_SIZE = 32;
+      static const size_t CLUSTER_Z_SLICE = 32;
+      /// @note initial capacity of the light index pool, which grows upon overflow
+      static const size_t CLUSTER_LIGHT_INDEX_CAPACITY = 8;  // per cluster
+      static const size_t NUM_FRAMES = 2;
+
+      /// @note per-cluster light lists are compact, i.e. the (offset, size) of every cluster
+      /// followed by a pool of light indices. the light indices beyond the pool are dropped and
+      /// counted, upon which the pool grows before the next use of the frame.
+      /// the previous frame might still be in flight, thus the resources are cycled per frame.
+      struct FrameResource {
+        Owner<zs::Buffer> lightInfoBuffer;
+        Owner<zs::Buffer> clusterLightInfoBuffer;
+        Owner<zs::Buffer> counterBuffer;  // u32 (requested, overflown) light indices
+        size_t lightIndexCapacity{0};
+        u64 lightListVersion{0};  // of the uploaded lights
+        vk::DescriptorSet lightTableSet;
+        vk::DescriptorSet lightCullSet;
+        Owner<VkCommand> cmd;
+        Owner<Fence> fence;
+      };
+
+      Owner<Pipeline> lightCullPipeline;  // light culling (compute)
 
       Owner<zs::Buffer> screenInfoBuffer;
-      Owner<zs::Buffer> lightInfoBuffer;
-      Owner<zs::Buffer> clusterLightInfoBuffer;
 
       std::vector<SceneLightInfo> lightList;
+      u64 lightListVersion{1};  // bumped whenever lightList is rebuilt
       size_t clusterCountPerLine;
       size_t clusterCountPerDepth;
 
       Owner<Buffer> clusterDimUbo;  // glm::vec2i
       size_t clusterCount;
 
-      static const size_t CLUSTER_SCREEN_SIZE = 32;
-      static const size_t CLUSTER_Z_SLICE = 32;
-      static const size_t CLUSTER_LIGHT_INDEX_CAPACITY = 32;
+      /// cpu light culling scratch, kept across frames
+      std::vector<glm::vec3> columnPlanes, rowPlanes;  // (left, right), (top, down) per tile
+      std::vector<glm::ivec4> lightTileRanges;         // x0, x1, y0, y1 (inclusive)
+      std::vector<int> sliceLights[CLUSTER_Z_SLICE];   // lights overlapping each z slice
+
+      FrameResource frames[NUM_FRAMES];
+      u32 frameNo{0};
+      FrameResource &currentFrame() noexcept { return frames[frameNo]; }
     } sceneLighting;
 
     struct SceneOcclusionQuery {
@@ -505,17 +586,59 @@ namespace zs {
       std::map<void *, int> primToQueryIndex;
     } sceneOcclusionQuery;
 
-    glm::vec4 *beginText() {
-      sceneAugmentRenderer.numLetters = 0;
-      sceneAugmentRenderer.counterBuffer.get().map();
-      auto counter = (u32 *)sceneAugmentRenderer.counterBuffer.get().mappedAddress();
-      *counter = 0;
-      // *(counter + 1) = ~((u32)0);
-      sceneAugmentRenderer.counterBuffer.get().unmap();
-      sceneAugmentRenderer.counterBuffer.get().flush();
-      return nullptr;
-    }
-    void endText() {}
+    struct SceneRayQuery {
+      /// @note fills the local space triangles of the prim at the time code, returns false if
+      /// unavailable, in which case get_ray_intersection_with_prim is used instead
+      using TriangleProvider = zs::function<bool(ZsPrimitive &, TimeCode,
+                                                 std::vector<glm::vec3> &,
+                                                 std::vector<glm::uvec3> &)>;
+      TriangleProvider triangleProvider;
+      struct MeshEntry {
+        TriangleMeshBvh bvh;
+        TimeCode timeCode;
+        const void *model{nullptr};
+        bool valid{false};
+      };
+      std::unordered_map<const ZsPrimitive *, MeshEntry> meshes;
+      RayQueryBvh primBvh;
+      std::vector<ZsPrimitive *> bvhPrims;
+      bool primBvhDirty{true};
+    } sceneRayQuery;
+
+    struct ScenePaintUploader {
+      static constexpr u32 s_num_segments = 3;
+      static constexpr size_t s_segment_size = (size_t)4 << 20;  // in bytes
+      Owner<Buffer> staging;   // a ring of s_num_segments segments
+      Owner<Buffer> readback;  // previous colors of the recorded ranges, laid out as staging
+      Owner<VkCommand> cmds[s_num_segments];
+      Owner<Fence> fences[s_num_segments];
+      /// @note recorded ranges of a segment, gathered into the stroke once the segment retires
+      struct Run {
+        ZsPrimitive *prim;
+        PrimIndex first;
+        u32 count;
+        size_t offset;  // in vertices within the ring
+        glm::vec3 color;
+      };
+      std::vector<Run> runs[s_num_segments];
+      u32 segment{0};
+      bool initialized{false};
+      /// @note vertices painted within the stroke, per prim
+      std::map<ZsPrimitive *, PaintStrokeRecord> strokeRecords;
+    } scenePaintUploader;
+
+    struct ScenePaintHistory {
+      PaintHistory history;
+      int requestedStep{0};  // -1 for undo, 1 for redo, carried out by the render stage
+    } scenePaintHistory;
+
+    struct ScenePaintBrush {
+      PaintBrush brush;
+      ZsPrimitive *pendingPrim{nullptr};  // prim of the dab in flight
+      /// @note the prim (and its model) whose colors the canvas holds, reset upon stroke end
+      ZsPrimitive *canvasPrim{nullptr};
+      const VkModel *canvasModel{nullptr};
+    } scenePaintBrush;
 
     struct SceneRenderData {
       // std::vector<VkModel> models;
@@ -614,6 +737,30 @@ namespace zs {
     void setupAugmentResources();
     void rebuildAugmentFbo();
     void renderSceneAugmentView();
+    /// @note returns the number of glyphs generated into overlayTextBuffer
+    u32 generateScreenSpaceText(PrimIndex primId);
+    void ensureSelectionCompactBuffers(u32 numWords, u32 numSegments);
+    /// @note selects within the focused prim, or within every visible prim if [focusPrim] is null.
+    /// returns false if there is nothing to select
+    bool issueBoxSelection(const SelectionRegion &region, ZsPrimitive *focusPrim);
+    /// @note returns true once the pending box selection is retrieved into selectedIndices
+    bool retrieveBoxSelection();
+    /// @note uploads dirty vertex color ranges, the write-back is deferred to the stroke end
+    void uploadPaintedColors(std::map<ZsPrimitive *, std::vector<PrimIndex>> &jobs);
+    /// @note [ids] are sorted and unique, [colors] holds either one color per id or a single one.
+    /// [record] gathers the previous colors into the stroke (only for a single color), copied
+    /// back from the color buffer if possible, otherwise read from the zsmesh
+    void uploadVertexColors(ZsPrimitive &prim, const std::vector<PrimIndex> &ids,
+                            const std::vector<glm::vec3> &colors, bool record);
+    void retireColorUploadSegment(u32 segment);
+    /// @note ends the stroke, which is written back to the zsmesh and pushed to the history
+    void flushPaintStroke();
+    /// @note -1 for undo, 1 for redo
+    void stepPaintHistory(int step);
+    /// @note evaluates the brush on the gpu, returns false if the prim is left to the cpu path
+    bool applyPaintBrush(ZsPrimitive &prim, const glm::ivec2 &center);
+    /// @note gathers the records of the dab in flight into the stroke and uploads them
+    bool retrievePaintRecords(bool wait);
 
     // outline rendering
     void setupOutlineResources();
@@ -639,7 +786,10 @@ namespace zs {
     // cluster based lighting
     void setupLightingResources();
     void rebuildLightingFBO();
-    void ensureLightListBuffer();
+    void ensureLightListBuffer(SceneLighting::FrameResource &frame);
+    void allocateClusterLightBuffer(SceneLighting::FrameResource &frame, size_t capacity);
+    /// @note every frame shares the capacity, thus an overflow in one grows all of them
+    void growClusterLightBuffers(size_t capacity);
     void registerLightSource(Shared<LightPrimContainer> lightContainer);
     void updateClusterLighting();
   };
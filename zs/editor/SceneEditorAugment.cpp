@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "SceneEditor.hpp"
 #include "fonts/stb_font_consolas_24_latin1.inl"
 #include "imgui.h"
@@ -6,6 +8,8 @@
 #include "world/system/ZsExecSystem.hpp"
 
 #define TEXTOVERLAY_MAX_CHAR_COUNT 50000
+#define TEXTOVERLAY_CELL_WIDTH 48
+#define TEXTOVERLAY_CELL_HEIGHT 24
 static stb_fontchar g_stbFontData[STB_FONT_consolas_24_latin1_NUM_CHARS];
 
 #define MAX_SELECTION_INDICES 2000000
@@ -14,12 +18,21 @@ static stb_fontchar g_stbFontData[STB_FONT_consolas_24_latin1_NUM_CHARS];
 
 namespace zs {
 
+  /// @note labels are anchored in object space, each glyph corner being offset in screen space
   static const char g_overlay_vert_code[] = R"(
 #version 450 core
-// #extension GL_EXT_debug_printf : enable
 
-layout (location = 0) in vec2 inPos;
-layout (location = 1) in vec2 inUV;
+layout (location = 0) in vec3 inAnchor;
+layout (location = 1) in uint inVisible;
+layout (location = 2) in vec2 inOffset;
+layout (location = 3) in vec2 inUV;
+
+layout (push_constant) uniform Params {
+  mat4 mvp;
+  vec2 glyphScale;  // font unit -> ndc
+  float depthBias;
+  int reversedZ;
+} params;
 
 layout (location = 0) out vec2 outUV;
 
@@ -29,13 +42,18 @@ out gl_PerVertex
 };
 
 void main(void) {
-  // debugPrintfEXT("gl_VertexIndex = %i", gl_VertexIndex);
-  // normal z
-	// gl_Position = vec4(inPos, 0.00001, 1.0);  // depth 0 reserved for selection box
-  // reverse-Z
-	gl_Position = vec4(inPos, 0.99999, 1.0);  // depth 0 reserved for selection box
-    // debugPrintfEXT("%f, %f; %f, %f\n", inPos.x, inPos.y, inUV.x, inUV.y);
 	outUV = inUV;
+	vec4 pos = params.mvp * vec4(inAnchor, 1.0);
+	if (inVisible == 0u || pos.w <= 0.0) {
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);  // degenerate, thus clipped
+		return;
+	}
+	vec3 ndc = pos.xyz / pos.w;
+	// pulled towards the camera, otherwise the annotated surface itself occludes the label
+	float depth = params.reversedZ != 0 ? ndc.z : 1.0 - ndc.z;
+	depth = clamp(depth * (1.0 + params.depthBias), 0.0, 1.0);
+	gl_Position = vec4(ndc.xy + vec2(inOffset.x, -inOffset.y) * params.glyphScale,
+	                   params.reversedZ != 0 ? depth : 1.0 - depth, 1.0);
 }
 
 )";
@@ -96,6 +114,9 @@ void main() {
 }
 )";
 
+  /// @note the glyphs of the index labels are generated in object space, one invocation per
+  /// vertex. a label takes as many glyphs as the digits of its index, thus its glyph offset is
+  /// known in closed form, and neither a counter nor a readback is needed.
   static const char g_gen_text_code[] = R"(
 #version 450
 
@@ -107,122 +128,203 @@ struct ImFontGlyph {
   float U0, V0, U1, V1;
 };
 
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) readonly buffer FontGlyph {
+  ImFontGlyph fontGlyph[];
+};
+layout(std430, binding = 1) readonly buffer Positions { float positions[]; };
+
+struct Vertex {
+  vec3 anchor;
+  uint visible;
+  vec2 offset;
+  vec2 uv;
+};
+layout(std430, binding = 2) writeonly buffer TextVerts { Vertex text[]; };
+
+layout(push_constant) uniform Params {
+  uint numLabels;
+} params;
+
+// number of glyphs of the labels [0, n)
+uint glyph_offset(uint n) {
+  uint ret = n;
+  for (uint p = 10; p < n; p *= 10) ret += n - p;
+  return ret;
+}
+
+vec3 anchor;
+uint dst;
+void emit(float x, float y, float u, float v) {
+  text[dst++] = Vertex(anchor, 0u, vec2(x, y), vec2(u, v));
+}
+
+void main() {
+  uint vid = gl_GlobalInvocationID.x;
+  if (vid >= params.numLabels) return;
+
+  anchor = vec3(positions[vid * 3], positions[vid * 3 + 1], positions[vid * 3 + 2]);
+  dst = glyph_offset(vid) * 6;
+
+  uint nBits = 0;
+  uint ns[10], n = vid;
+  do {
+    ns[nBits++] = n % 10;
+    n /= 10;
+  } while (n != 0);
+
+  float x = 0.0;
+  while (nBits > 0) {
+    const ImFontGlyph g = fontGlyph[ns[--nBits]];
+    emit(x + g.X0, g.Y0, g.U0, g.V0);
+    emit(x + g.X1, g.Y0, g.U1, g.V0);
+    emit(x + g.X0, g.Y1, g.U0, g.V1);
+    emit(x + g.X0, g.Y1, g.U0, g.V1);
+    emit(x + g.X1, g.Y0, g.U1, g.V0);
+    emit(x + g.X1, g.Y1, g.U1, g.V1);
+    x += g.AdvanceX;
+  }
+}
+)";
+
+  /// @note fallback of the above for vertex positions not bound as storage: the labels of the
+  /// visible vertices of the focused prim are gathered from the pick image and anchored in ndc
+  static const char g_gen_screen_text_code[] = R"(
+#version 450
+
+struct ImFontGlyph {
+  uint Flag;
+  float AdvanceX;
+  float X0, Y0, X1, Y1;
+  float U0, V0, U1, V1;
+};
+
 layout(local_size_x = 32, local_size_y = 32) in;
 
 layout(binding = 0, rgba32i) uniform readonly iimage2D pickImage;
-
-// layout(std140, binding = 1) readonly buffer StbFont {
-//   stb_fontchar stbFontData[];
-// };
 layout(std430, binding = 1) readonly buffer FontGlyph {
   ImFontGlyph fontGlyph[];
 };
+layout(std430, binding = 2) buffer Counter { uint numLetters; };
 
-layout(std430, binding = 2) buffer Counter { 
-  uint numLetters; 
-  // int selectedObjId; 
-};
 struct Vertex {
-  vec2 pos;
+  vec3 anchor;
+  uint visible;
+  vec2 offset;
   vec2 uv;
 };
-layout(std430, binding = 3) buffer TextVerts { Vertex text[]; };
+layout(std430, binding = 3) writeonly buffer TextVerts { Vertex text[]; };
 
-layout(push_constant) uniform Selection {
+layout(push_constant) uniform Params {
+  ivec2 extent;
   int focusId;
-  int numTotalVerts;
-  int width;
-  int height;
   uint limit;
-  // ivec2 selectPixel;
+  float depth;
 } params;
 
+vec3 anchor;
+uint dst;
+void emit(float x, float y, float u, float v) {
+  text[dst++] = Vertex(anchor, 1u, vec2(x, y), vec2(u, v));
+}
+
 void main() {
-  if (gl_GlobalInvocationID.x >= params.width || gl_GlobalInvocationID.y >= params.height)
+  ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+  if (p.x >= params.extent.x || p.y >= params.extent.y) return;
+  ivec2 ids = imageLoad(pickImage, p).rg;
+  if (ids.r != params.focusId || ids.g < 0) return;
+
+  uint nBits = 0;
+  uint ns[10], n = uint(ids.g);
+  do {
+    ns[nBits++] = n % 10;
+    n /= 10;
+  } while (n != 0);
+  uint offset = atomicAdd(numLetters, nBits);
+  if (offset + nBits > params.limit) {
+    atomicAdd(numLetters, uint(-int(nBits)));
     return;
-  ivec2 ids = imageLoad(pickImage,
-                        ivec2(gl_GlobalInvocationID.x, gl_GlobalInvocationID.y))
-                  .rg;
+  }
 
-  if (ids.r == params.focusId && ids.g >= 0) {
+  // the overlay is drawn with a negative viewport
+  anchor = vec3(2.0 * p.x / params.extent.x - 1.0, 1.0 - 2.0 * p.y / params.extent.y,
+                params.depth);
+  dst = offset * 6;
+  float x = 0.0;
+  while (nBits > 0) {
+    const ImFontGlyph g = fontGlyph[ns[--nBits]];
+    emit(x + g.X0, g.Y0, g.U0, g.V0);
+    emit(x + g.X1, g.Y0, g.U1, g.V0);
+    emit(x + g.X0, g.Y1, g.U0, g.V1);
+    emit(x + g.X0, g.Y1, g.U0, g.V1);
+    emit(x + g.X1, g.Y0, g.U1, g.V0);
+    emit(x + g.X1, g.Y1, g.U1, g.V1);
+    x += g.AdvanceX;
+  }
+}
+)";
 
-    const uint firstChar = 32; // STB_FONT_consolas_24_latin1_FIRST_CHAR
-    const float charW = 3.5 / params.width;
-    const float charH = 3.5 / params.height;
-    float x = 1.0 * gl_GlobalInvocationID.x / params.width * 2.0 - 1.0;
-    float y = 1.0 * gl_GlobalInvocationID.y / params.height * 2.0 - 1.0;
-
-    int nBits = 0;
-    int ns[11], n = ids.g;
-    while (n != 0) {
-      int tmp = nBits;
-      ns[tmp] = n % 10;
-      n /= 10;
-      nBits = nBits + 1;
-    }
+  /// @note screen-space density culling of the labels, which keeps the nearest label of each cell
+  /// (ties go to the lower index): 0. nearest depth per cell 1. its label 2. mark glyph visibility
+  static const char g_cull_text_code[] = R"(
+#version 450
 
-    uint offset = atomicAdd(numLetters, nBits);
+layout(local_size_x = 256) in;
 
-    if (offset + nBits > params.limit) {
-      atomicAdd(numLetters, -nBits);
-    } else {
-      offset *= 6;
-      float depth = 0.00001;
-      if (params.numTotalVerts > 0)
-        depth = 1.0 * ids.g / params.numTotalVerts;
-      while (nBits > 0) {
-        nBits--;
-/*
-        int letter = ns[nBits] + 48; // '0': 48
-        const stb_fontchar charData = stbFontData[letter - firstChar];
-        float u0 = charData.s0 - 0.002;
-        float u1 = charData.s1 + 0.002;
-        float v0 = charData.t0 - 0.002;
-        float v1 = charData.t1 + 0.002;
-        uint x0 = charData.x0y0 >> 16;
-        uint y0 = charData.x0y0 & 0xffff;
-        uint x1 = charData.x1y1 >> 16;
-        uint y1 = charData.x1y1 & 0xffff;
-*/
-        // int letter = ns[nBits] + 48;
-        // uint loc = fontLUT[letter];
-        const ImFontGlyph charData = fontGlyph[ns[nBits]];
-        float u0 = charData.U0;
-        float u1 = charData.U1;
-        float v0 = charData.V0;
-        float v1 = charData.V1;
-        float x0 = charData.X0;
-        float y0 = charData.Y0;
-        float x1 = charData.X1;
-        float y1 = charData.Y1;
-
-        /// 
-        Vertex vert;
-        vert.pos = vec2(x + x0 * charW, y + y0 * charH);
-        vert.uv = vec2(u0, v0);
-        text[offset++] = vert;
-        vert.pos = vec2(x + x1 * charW, y + y0 * charH);
-        vert.uv = vec2(u1, v0);
-        text[offset++] = vert;
-        vert.pos = vec2(x + x0 * charW, y + y1 * charH);
-        vert.uv = vec2(u0, v1);
-        text[offset++] = vert;
-        vert.pos = vec2(x + x0 * charW, y + y1 * charH);
-        vert.uv = vec2(u0, v1);
-        text[offset++] = vert;
-        vert.pos = vec2(x + x1 * charW, y + y0 * charH);
-        vert.uv = vec2(u1, v0);
-        text[offset++] = vert;
-        vert.pos = vec2(x + x1 * charW, y + y1 * charH);
-        vert.uv = vec2(u1, v1);
-        text[offset++] = vert;
-
-        x += charData.AdvanceX * charW;
-      }
-    }
+struct Vertex {
+  vec3 anchor;
+  uint visible;
+  vec2 offset;
+  vec2 uv;
+};
+layout(std430, binding = 0) buffer TextVerts { Vertex text[]; };
+layout(std430, binding = 1) buffer LabelCells { uint cells[]; };  // (depth key, label)
+
+layout(push_constant) uniform Params {
+  mat4 mvp;
+  ivec2 extent;
+  ivec2 cellExtent;
+  uint numLabels;
+  int reversedZ;
+  uint stage;
+} params;
+
+uint glyph_offset(uint n) {
+  uint ret = n;
+  for (uint p = 10; p < n; p *= 10) ret += n - p;
+  return ret;
+}
+
+void main() {
+  uint label = gl_GlobalInvocationID.x;
+  if (label >= params.numLabels) return;
+  uint first = glyph_offset(label) * 6;
+
+  vec4 pos = params.mvp * vec4(text[first].anchor, 1.0);
+  vec3 ndc = pos.xyz / pos.w;
+  bool inside = pos.w > 0.0 && all(lessThanEqual(abs(ndc.xy), vec2(1.0))) && ndc.z >= 0.0
+                && ndc.z <= 1.0;
+  uint cell = 0;
+  uint depthKey = 0;
+  if (inside) {
+    ivec2 numCells = (params.extent + params.cellExtent - 1) / params.cellExtent;
+    ivec2 c = ivec2((ndc.xy * 0.5 + 0.5) * vec2(params.extent)) / params.cellExtent;
+    c = clamp(c, ivec2(0), numCells - 1);
+    cell = uint(c.y * numCells.x + c.x) * 2;
+    // non-negative floats are ordered as their bits, the smaller the nearer
+    depthKey = floatBitsToUint(params.reversedZ != 0 ? 1.0 - ndc.z : ndc.z);
   }
 
-  // imageStore(resultImage, ivec2(gl_GlobalInvocationID.xy), res);
+  if (params.stage == 0) {
+    if (inside) atomicMin(cells[cell], depthKey);
+  } else if (params.stage == 1) {
+    if (inside && cells[cell] == depthKey) atomicMin(cells[cell + 1], label);
+  } else {
+    uint visible = inside && cells[cell + 1] == label ? 1u : 0u;
+    uint last = glyph_offset(label + 1) * 6;
+    for (uint i = first; i != last; ++i) text[i].visible = visible;
+  }
 }
 )";
 
@@ -315,13 +417,139 @@ void main() {
     }
   }
 }
+)";
+
+  /// @note the bitset over the elements of the selectable prims consists of one segment per prim,
+  /// ordered by prim id, thus (prim, element) pairs are ordered and deduplicated by the bitset,
+  /// which is then compacted through a prefix sum:
+  /// 0. mark 1. count per group 2. scan group counts 3. emit sorted ids
+  static const char g_compact_selection_code[] = R"(
+#version 450
+
+layout(local_size_x = 256) in;
+
+layout(binding = 0, rgba32i) uniform readonly iimage2D pickImage;
+layout(std430, binding = 1) buffer SelectedBits { uint bits[]; };
+layout(std430, binding = 2) buffer GroupSums { uint groupSums[]; };
+layout(std430, binding = 3) buffer Counter {
+  uint numSelected;
+  int selectedObjId;
+};
+layout(std430, binding = 4) buffer SelectedIds { ivec2 selectedIds[]; };
+// (prim id, first word, number of elements, -)
+layout(std430, binding = 5) readonly buffer Segments { ivec4 segments[]; };
+
+layout(push_constant) uniform Params {
+  uvec2 offset;
+  ivec2 extent;
+  uint numSegments;
+  uint numWords;
+  uint limit;
+  uint stage;
+} params;
+
+shared uint s_scan[256];
+
+int find_segment_of_prim(int primId) {
+  int lo = 0, hi = int(params.numSegments) - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) >> 1;
+    if (segments[mid].x == primId) return mid;
+    if (segments[mid].x < primId) lo = mid + 1;
+    else hi = mid - 1;
+  }
+  return -1;
+}
+
+// the last segment starting at or before the word
+int find_segment_of_word(uint word) {
+  int lo = 0, hi = int(params.numSegments) - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) >> 1;
+    if (uint(segments[mid].y) <= word) lo = mid;
+    else hi = mid - 1;
+  }
+  return lo;
+}
+
+// inclusive scan within the workgroup
+void scan_block(uint v) {
+  uint lid = gl_LocalInvocationID.x;
+  s_scan[lid] = v;
+  barrier();
+  for (uint d = 1; d < 256; d <<= 1) {
+    uint t = lid >= d ? s_scan[lid - d] : 0;
+    barrier();
+    s_scan[lid] += t;
+    barrier();
+  }
+}
+
+void main() {
+  uint lid = gl_LocalInvocationID.x;
+  uint gid = gl_GlobalInvocationID.x;
+  if (params.stage == 0) {
+    if (gid >= params.extent.x) return;
+    ivec2 ids = imageLoad(pickImage, ivec2(params.offset.x + gid,
+                                           params.offset.y + gl_WorkGroupID.y)).rg;
+    if (ids.g < 0) return;
+    int s = find_segment_of_prim(ids.r);
+    if (s >= 0 && ids.g < segments[s].z)
+      atomicOr(bits[segments[s].y + (ids.g >> 5)], 1u << (ids.g & 31));
+  } else if (params.stage == 1) {
+    scan_block(gid < params.numWords ? bitCount(bits[gid]) : 0);
+    if (lid == 255) groupSums[gl_WorkGroupID.x] = s_scan[255];
+  } else if (params.stage == 2) {
+    uint numGroups = (params.numWords + 255) / 256;
+    uint carry = 0;
+    for (uint base = 0; base < numGroups; base += 256) {
+      uint i = base + lid;
+      uint v = i < numGroups ? groupSums[i] : 0;
+      scan_block(v);
+      if (i < numGroups) groupSums[i] = carry + s_scan[lid] - v;
+      carry += s_scan[255];
+      barrier();
+    }
+    if (lid == 0) {
+      numSelected = min(carry, params.limit);
+      selectedObjId = params.numSegments == 1 ? segments[0].x : -1;
+    }
+  } else {
+    uint word = gid < params.numWords ? bits[gid] : 0;
+    uint cnt = bitCount(word);
+    scan_block(cnt);
+    if (word == 0) return;
+    uint dst = groupSums[gl_WorkGroupID.x] + s_scan[lid] - cnt;
+    ivec4 seg = segments[find_segment_of_word(gid)];
+    int base = int(gid - uint(seg.y)) * 32;
+    for (; word != 0 && dst < params.limit; word &= word - 1, ++dst)
+      selectedIds[dst] = ivec2(seg.x, base + findLSB(word));
+  }
+}
 )";
 
   struct GenTextParam {
-    glm::ivec2 ids;
+    u32 numLabels;
+  };
+  struct GenScreenTextParam {
     glm::ivec2 extent;
+    int focusObjId;
     u32 limit;
-    // glm::ivec2 selectPixel;
+    float depth;
+  };
+  struct CullTextParam {
+    glm::mat4 mvp;
+    glm::ivec2 extent;
+    glm::ivec2 cellExtent;
+    u32 numLabels;
+    int reversedZ;
+    u32 stage;
+  };
+  struct OverlayTextParam {
+    glm::mat4 mvp;
+    glm::vec2 glyphScale;
+    float depthBias;
+    int reversedZ;
   };
 
   struct SelectionParam {
@@ -330,6 +558,14 @@ void main() {
     int focusObjId;
     u32 limit;
   };
+  struct SelectionCompactParam {
+    glm::uvec2 offset;
+    glm::ivec2 extent;
+    u32 numSegments;
+    u32 numWords;
+    u32 limit;
+    u32 stage;
+  };
   struct PaintParam {
     glm::uvec2 offset;
     glm::ivec2 center;
@@ -338,9 +574,25 @@ void main() {
     u32 limit;
   };
   struct TextVertex {
-    glm::vec2 pos;
+    glm::vec3 anchor;
+    u32 visible;
+    glm::vec2 offset;
     glm::vec2 uv;
   };
+  static_assert(sizeof(TextVertex) == 32, "must match the std430 layout of the text shaders");
+
+  /// @note number of glyphs of the index labels [0, n), matching glyph_offset of the shaders
+  static u32 overlay_text_glyph_offset(u32 n) {
+    u32 ret = n;
+    for (u32 p = 10; p < n; p *= 10) ret += n - p;
+    return ret;
+  }
+
+  /// @note the zsmesh points provide the positions of the model vertices if they map onto them
+  static bool has_zsmesh_positions(ZsPrimitive &prim, u32 numVerts) {
+    const auto &points = prim.points();
+    return points.size() == numVerts && points.hasAttrib(ATTRIB_POS_TAG);
+  }
 
   void SceneEditor::setupAugmentResources() {
     auto &ctx = this->ctx();
@@ -381,12 +633,31 @@ void main() {
     auto &genTextShader = ResourceSystem::get_shader("default_gen_overlay_text.comp");
     ctx.acquireSet(genTextShader.layout(0), sceneAugmentRenderer.textGenSet);
     sceneAugmentRenderer.genTextPipeline = Pipeline{genTextShader, sizeof(GenTextParam)};
+    ResourceSystem::load_shader(ctx, "default_gen_screen_overlay_text.comp",
+                                vk::ShaderStageFlagBits::eCompute, g_gen_screen_text_code);
+    auto &genScreenTextShader = ResourceSystem::get_shader("default_gen_screen_overlay_text.comp");
+    ctx.acquireSet(genScreenTextShader.layout(0), sceneAugmentRenderer.textScreenGenSet);
+    sceneAugmentRenderer.genScreenTextPipeline
+        = Pipeline{genScreenTextShader, sizeof(GenScreenTextParam)};
+    // cull overlay text (compute)
+    ResourceSystem::load_shader(ctx, "default_cull_overlay_text.comp",
+                                vk::ShaderStageFlagBits::eCompute, g_cull_text_code);
+    auto &cullTextShader = ResourceSystem::get_shader("default_cull_overlay_text.comp");
+    ctx.acquireSet(cullTextShader.layout(0), sceneAugmentRenderer.textCullSet);
+    sceneAugmentRenderer.cullTextPipeline = Pipeline{cullTextShader, sizeof(CullTextParam)};
     // gather selection indices (compute)
     ResourceSystem::load_shader(ctx, "default_selection.comp", vk::ShaderStageFlagBits::eCompute,
                                 g_gather_selection_code);  // sceneAugmentRenderer.selectionShader
     auto &selectionShader = ResourceSystem::get_shader("default_selection.comp");
     ctx.acquireSet(selectionShader.layout(0), sceneAugmentRenderer.selectionSet);
     sceneAugmentRenderer.selectionPipeline = Pipeline{selectionShader, sizeof(SelectionParam)};
+    // deduplicate and sort box selection indices (compute)
+    ResourceSystem::load_shader(ctx, "default_selection_compact.comp",
+                                vk::ShaderStageFlagBits::eCompute, g_compact_selection_code);
+    auto &selectionCompactShader = ResourceSystem::get_shader("default_selection_compact.comp");
+    ctx.acquireSet(selectionCompactShader.layout(0), sceneAugmentRenderer.selectionCompactSet);
+    sceneAugmentRenderer.selectionCompactPipeline
+        = Pipeline{selectionCompactShader, sizeof(SelectionCompactParam)};
     // paint indices (compute)
     ResourceSystem::load_shader(ctx, "default_paint.comp", vk::ShaderStageFlagBits::eCompute,
                                 g_gather_painted_code);
@@ -455,12 +726,26 @@ void main() {
       sceneAugmentRenderer.counterBuffer = ctx.createBuffer(
           sizeof(u32) + sizeof(i32), vk::BufferUsageFlagBits::eStorageBuffer,
           vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCached);
+      /// @note host visible buffers read back every frame stay mapped
+      sceneAugmentRenderer.counterBuffer.get().map();
     }
     {
       // selection buffer
       sceneAugmentRenderer.selectedIndicesBuffer = ctx.createBuffer(
           sizeof(glm::ivec2) * MAX_SELECTION_INDICES, vk::BufferUsageFlagBits::eStorageBuffer,
           vk::MemoryPropertyFlagBits::eHostVisible);
+      sceneAugmentRenderer.selectedIndicesBuffer.get().map();
+      // box selection result, the rest is allocated upon demand
+      sceneAugmentRenderer.selectionResultCounterBuffer = ctx.createBuffer(
+          sizeof(u32) + sizeof(i32), vk::BufferUsageFlagBits::eStorageBuffer,
+          vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+      sceneAugmentRenderer.selectionResultCounterBuffer.get().map();
+      sceneAugmentRenderer.selectionCapacity = 0;
+      sceneAugmentRenderer.selectionSegmentCapacity = 0;
+      sceneAugmentRenderer.selectionCmd
+          = ctx.createCommandBuffer(vk_cmd_usage_e::reset, vk_queue_e::graphics, false);
+      sceneAugmentRenderer.selectionFence = Fence(ctx, true);
+      sceneAugmentRenderer.selectionPending = false;
     }
 
     // render pass
@@ -505,12 +790,20 @@ void main() {
                                                   : vk::CompareOp::eLessOrEqual)
         .setShader(overlayVertShader)
         .setShader(overlayFragShader)
+        .setPushConstantRange({vk::ShaderStageFlagBits::eVertex, 0, sizeof(OverlayTextParam)})
         .setBindingDescriptions({vk::VertexInputBindingDescription{0, sizeof(TextVertex),
                                                                    vk::VertexInputRate::eVertex}})
         .setAttributeDescriptions(
             {vk::VertexInputAttributeDescription{/*location*/ 0,
-                                                 /*binding*/ 0, vk::Format::eR32G32Sfloat, (u32)0},
+                                                 /*binding*/ 0, vk::Format::eR32G32B32Sfloat,
+                                                 (u32)offsetof(TextVertex, anchor)},
              vk::VertexInputAttributeDescription{/*location*/ 1,
+                                                 /*binding*/ 0, vk::Format::eR32Uint,
+                                                 (u32)offsetof(TextVertex, visible)},
+             vk::VertexInputAttributeDescription{/*location*/ 2,
+                                                 /*binding*/ 0, vk::Format::eR32G32Sfloat,
+                                                 (u32)offsetof(TextVertex, offset)},
+             vk::VertexInputAttributeDescription{/*location*/ 3,
                                                  /*binding*/ 0, vk::Format::eR32G32Sfloat,
                                                  (u32)offsetof(TextVertex, uv)}});
     sceneAugmentRenderer.overlayPipeline = pipelineBuilder.build();
@@ -539,24 +832,49 @@ void main() {
         {(vk::ImageView)sceneAttachments.color.get(), (vk::ImageView)sceneAttachments.depth.get()},
         vkCanvasExtent, sceneAugmentRenderer.renderPass.get());
 
-    /// overlay text generation
+    /// overlay text generation, the vertex positions are bound upon generation
+    {
+      ctx().writeDescriptorSet(guiRenderer->_fontGlyphs.get().descriptorInfo(),
+                               sceneAugmentRenderer.textGenSet, vk::DescriptorType::eStorageBuffer,
+                               /*binding*/ 0);
+      /// text buffers
+      ctx().writeDescriptorSet(sceneAugmentRenderer.overlayTextBuffer.get().descriptorInfo(),
+                               sceneAugmentRenderer.textGenSet, vk::DescriptorType::eStorageBuffer,
+                               /*binding*/ 2);
+    }
+    /// overlay text generation in screen space
     {
       vk::DescriptorImageInfo imageInfo{};
       imageInfo.sampler = VK_NULL_HANDLE;
       imageInfo.imageView = scenePickPass.pickBuffer.get();
       imageInfo.imageLayout = vk::ImageLayout::eGeneral;
-      ctx().writeDescriptorSet(imageInfo, sceneAugmentRenderer.textGenSet,
+      ctx().writeDescriptorSet(imageInfo, sceneAugmentRenderer.textScreenGenSet,
                                vk::DescriptorType::eStorageImage, /*binding*/ 0);
       ctx().writeDescriptorSet(guiRenderer->_fontGlyphs.get().descriptorInfo(),
-                               sceneAugmentRenderer.textGenSet, vk::DescriptorType::eStorageBuffer,
-                               /*binding*/ 1);
+                               sceneAugmentRenderer.textScreenGenSet,
+                               vk::DescriptorType::eStorageBuffer, /*binding*/ 1);
       ctx().writeDescriptorSet(sceneAugmentRenderer.counterBuffer.get().descriptorInfo(),
-                               sceneAugmentRenderer.textGenSet, vk::DescriptorType::eStorageBuffer,
-                               /*binding*/ 2);
-      /// text buffers
+                               sceneAugmentRenderer.textScreenGenSet,
+                               vk::DescriptorType::eStorageBuffer, /*binding*/ 2);
       ctx().writeDescriptorSet(sceneAugmentRenderer.overlayTextBuffer.get().descriptorInfo(),
-                               sceneAugmentRenderer.textGenSet, vk::DescriptorType::eStorageBuffer,
-                               /*binding*/ 3);
+                               sceneAugmentRenderer.textScreenGenSet,
+                               vk::DescriptorType::eStorageBuffer, /*binding*/ 3);
+    }
+    /// overlay text culling, one label per cell of the canvas
+    {
+      const u32 numCells
+          = ((vkCanvasExtent.width + TEXTOVERLAY_CELL_WIDTH - 1) / TEXTOVERLAY_CELL_WIDTH)
+            * ((vkCanvasExtent.height + TEXTOVERLAY_CELL_HEIGHT - 1) / TEXTOVERLAY_CELL_HEIGHT);
+      sceneAugmentRenderer.overlayTextCellBuffer = ctx().createBuffer(
+          sizeof(u32) * 2 * std::max(numCells, (u32)1),
+          vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+          vk::MemoryPropertyFlagBits::eDeviceLocal);
+      ctx().writeDescriptorSet(sceneAugmentRenderer.overlayTextBuffer.get().descriptorInfo(),
+                               sceneAugmentRenderer.textCullSet, vk::DescriptorType::eStorageBuffer,
+                               /*binding*/ 0);
+      ctx().writeDescriptorSet(sceneAugmentRenderer.overlayTextCellBuffer.get().descriptorInfo(),
+                               sceneAugmentRenderer.textCullSet, vk::DescriptorType::eStorageBuffer,
+                               /*binding*/ 1);
     }
     /// index selection generation
     {
@@ -576,6 +894,19 @@ void main() {
                                vk::DescriptorType::eStorageBuffer,
                                /*binding*/ 2);
     }
+    /// box selection compaction
+    {
+      vk::DescriptorImageInfo imageInfo{};
+      imageInfo.sampler = VK_NULL_HANDLE;
+      imageInfo.imageView = scenePickPass.pickBuffer.get();
+      imageInfo.imageLayout = vk::ImageLayout::eGeneral;
+      ctx().writeDescriptorSet(imageInfo, sceneAugmentRenderer.selectionCompactSet,
+                               vk::DescriptorType::eStorageImage, /*binding*/ 0);
+      ctx().writeDescriptorSet(
+          sceneAugmentRenderer.selectionResultCounterBuffer.get().descriptorInfo(),
+          sceneAugmentRenderer.selectionCompactSet, vk::DescriptorType::eStorageBuffer,
+          /*binding*/ 3);
+    }
     /// paint selection generation
     {
       vk::DescriptorImageInfo imageInfo{};
@@ -602,69 +933,262 @@ void main() {
                              vk::DescriptorType::eCombinedImageSampler, 0);
   }
 
-  void SceneEditor::renderSceneAugmentView() {
+  u32 SceneEditor::generateScreenSpaceText(PrimIndex primId) {
     auto &ctx = this->ctx();
+    auto &r = sceneAugmentRenderer;
+    auto &counter = r.counterBuffer.get();
+    *(u32 *)counter.mappedAddress() = 0;
+    counter.flush();
+
+    GenScreenTextParam params;
+    params.extent = glm::ivec2{(int)vkCanvasExtent.width, (int)vkCanvasExtent.height};
+    params.focusObjId = primId;
+    params.limit = TEXTOVERLAY_MAX_CHAR_COUNT;
+    /// @note in front of the scene, as the former screen-space labels
+    params.depth = SceneEditor::reversedZ ? 0.99999f : 0.00001f;
 
     fence.get().wait();
-
     auto &cmd = this->cmd.get();
+    cmd.begin();
+    (*cmd).bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                              /*pipeline layout*/ r.genScreenTextPipeline.get(),
+                              /*firstSet*/ 0,
+                              /*descriptor sets*/ {r.textScreenGenSet},
+                              /*dynamic offset*/ {}, ctx.dispatcher);
+    (*cmd).bindPipeline(vk::PipelineBindPoint::eCompute, r.genScreenTextPipeline.get());
+    (*cmd).pushConstants(r.genScreenTextPipeline.get(), vk::ShaderStageFlagBits::eCompute, 0,
+                         sizeof(params), &params);
+    (*cmd).dispatch((vkCanvasExtent.width + 31) / 32, (vkCanvasExtent.height + 31) / 32, 1);
+    cmd.end();
+    cmd.submit(fence.get(), /*reset fence*/ true, /*reset config*/ true);
+    fence.get().wait();
 
-#if ENABLE_PROFILE
-    CppTimer timer;
-#endif
+    return std::min(*(const u32 *)counter.mappedAddress(), (u32)TEXTOVERLAY_MAX_CHAR_COUNT);
+  }
 
-    if (sceneAugmentRenderer.overlayTextNeedUpdate) {
-#if ENABLE_PROFILE
-      timer.tick();
-#endif
-      auto mapped = beginText();
+  void SceneEditor::ensureSelectionCompactBuffers(u32 numWords, u32 numSegments) {
+    auto &ctx = this->ctx();
+    auto &r = sceneAugmentRenderer;
+    if (numSegments > r.selectionSegmentCapacity) {
+      numSegments = std::max(numSegments, r.selectionSegmentCapacity * 2);
+      r.selectionSegmentsBuffer = ctx.createBuffer(
+          sizeof(glm::ivec4) * numSegments, vk::BufferUsageFlagBits::eStorageBuffer,
+          vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+      r.selectionSegmentsBuffer.get().map();
+      r.selectionSegmentCapacity = numSegments;
+      ctx.writeDescriptorSet(r.selectionSegmentsBuffer.get().descriptorInfo(),
+                             r.selectionCompactSet, vk::DescriptorType::eStorageBuffer,
+                             /*binding*/ 5);
+    }
+    if (numWords * 32 <= r.selectionCapacity) return;
+    /// @note grow geometrically to avoid reallocations when switching between prims
+    numWords = std::max(numWords, (r.selectionCapacity + r.selectionCapacity / 2) / 32);
+    const u32 numGroups = (numWords + 255) / 256;
+    r.selectionBitsBuffer = ctx.createBuffer(
+        sizeof(u32) * numWords,
+        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    r.selectionGroupSumsBuffer
+        = ctx.createBuffer(sizeof(u32) * numGroups, vk::BufferUsageFlagBits::eStorageBuffer,
+                           vk::MemoryPropertyFlagBits::eDeviceLocal);
+    r.selectionResultBuffer = ctx.createBuffer(
+        sizeof(glm::ivec2) * std::min(numWords * 32, (u32)MAX_SELECTION_INDICES),
+        vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    r.selectionResultBuffer.get().map();
+    r.selectionCapacity = numWords * 32;
+
+    ctx.writeDescriptorSet(r.selectionBitsBuffer.get().descriptorInfo(), r.selectionCompactSet,
+                           vk::DescriptorType::eStorageBuffer, /*binding*/ 1);
+    ctx.writeDescriptorSet(r.selectionGroupSumsBuffer.get().descriptorInfo(),
+                           r.selectionCompactSet, vk::DescriptorType::eStorageBuffer,
+                           /*binding*/ 2);
+    ctx.writeDescriptorSet(r.selectionResultBuffer.get().descriptorInfo(), r.selectionCompactSet,
+                           vk::DescriptorType::eStorageBuffer, /*binding*/ 4);
+  }
 
-      auto extent = scenePickPass.pickBuffer.get().getExtent();
-      /// generate overlay text
-      GenTextParam genTextParams;
-      if (auto focusPrim = focusPrimPtr.lock()) {
-        auto pModel = focusPrim->queryVkTriMesh(ctx, sceneRenderData.currentTimeCode);
-        if (pModel && currentVisiblePrimsDrawn.at(focusPrim.get())) {
-          const auto &model = *pModel;
+  bool SceneEditor::issueBoxSelection(const SelectionRegion &region, ZsPrimitive *focusPrim) {
+    auto &ctx = this->ctx();
+    auto &r = sceneAugmentRenderer;
+
+    /// @note (prim id, first word, number of elements, -), the focused prim only if any
+    std::vector<glm::ivec4> segments;
+    auto addSegment = [&](ZsPrimitive *prim) {
+      auto pModel = prim->queryVkTriMesh(ctx, sceneRenderData.currentTimeCode);
+      const u32 numElements = pModel ? (u32)pModel->verts.vertexCount : 0;
+      if (numElements) segments.emplace_back(prim->id(), 0, (int)numElements, 0);
+    };
+    if (focusPrim)
+      addSegment(focusPrim);
+    else
+      for (auto prim : getCurrentVisiblePrims()) {
+        if (!prim || prim->empty()) continue;
+        auto it = currentVisiblePrimsDrawn.find(prim);
+        if (it != currentVisiblePrimsDrawn.end() && it->second) addSegment(prim);
+      }
+    std::sort(std::begin(segments), std::end(segments),
+              [](const glm::ivec4 &a, const glm::ivec4 &b) { return a.x < b.x; });
+    u32 numWords = 0;
+    for (auto &segment : segments) {
+      segment.y = (int)numWords;
+      numWords += ((u32)segment.z + 31) / 32;
+    }
+    if (numWords == 0 || region.extent.x == 0 || region.extent.y == 0) return false;
 
-          cmd.begin();
+    ensureSelectionCompactBuffers(numWords, (u32)segments.size());
+    std::memcpy(r.selectionSegmentsBuffer.get().mappedAddress(), segments.data(),
+                sizeof(glm::ivec4) * segments.size());
 
-          (*cmd).bindDescriptorSets(vk::PipelineBindPoint::eCompute,
-                                    /*pipeline layout*/ sceneAugmentRenderer.genTextPipeline.get(),
-                                    /*firstSet*/ 0,
-                                    /*descriptor sets*/ {sceneAugmentRenderer.textGenSet},
-                                    /*dynamic offset*/ {}, ctx.dispatcher);
-          (*cmd).bindPipeline(vk::PipelineBindPoint::eCompute,
-                              sceneAugmentRenderer.genTextPipeline.get());
+    SelectionCompactParam params;
+    params.offset = region.offset;
+    params.extent = glm::ivec2(region.extent);
+    params.numSegments = (u32)segments.size();
+    params.numWords = numWords;
+    params.limit = MAX_SELECTION_INDICES;
+    const u32 numGroups = (params.numWords + 255) / 256;
 
-          genTextParams.limit = TEXTOVERLAY_MAX_CHAR_COUNT;
-          genTextParams.extent = glm::ivec2{(int)vkCanvasExtent.width, (int)vkCanvasExtent.height};
-          genTextParams.ids
-              // = glm::ivec2{focusObjId, sceneRenderData.models[focusObjId].verts.vertexCount};
-              = glm::ivec2{focusPrim->id(), /*focusPrim->vkTriMesh(ctx)*/ model.verts.vertexCount};
+    auto &cmd = r.selectionCmd.get();
+    cmd.begin();
+    (*cmd).fillBuffer(r.selectionBitsBuffer.get(), 0, sizeof(u32) * params.numWords, 0,
+                      ctx.dispatcher);
+    (*cmd).pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+        vk::DependencyFlags(),
+        {vk::MemoryBarrier{vk::AccessFlagBits::eTransferWrite,
+                           vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite}},
+        {}, {}, ctx.dispatcher);
+    (*cmd).bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                              /*pipeline layout*/ r.selectionCompactPipeline.get(),
+                              /*firstSet*/ 0,
+                              /*descriptor sets*/ {r.selectionCompactSet},
+                              /*dynamic offset*/ {}, ctx.dispatcher);
+    (*cmd).bindPipeline(vk::PipelineBindPoint::eCompute, r.selectionCompactPipeline.get());
+    const glm::uvec3 groups[4] = {{(region.extent.x + 255) / 256, region.extent.y, 1},
+                                  {numGroups, 1, 1},
+                                  {1, 1, 1},
+                                  {numGroups, 1, 1}};
+    for (u32 stage = 0; stage != 4; ++stage) {
+      if (stage)
+        (*cmd).pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+            vk::DependencyFlags(),
+            {vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite,
+                               vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite}},
+            {}, {}, ctx.dispatcher);
+      params.stage = stage;
+      (*cmd).pushConstants(r.selectionCompactPipeline.get(), vk::ShaderStageFlagBits::eCompute, 0,
+                           sizeof(params), &params);
+      (*cmd).dispatch(groups[stage].x, groups[stage].y, groups[stage].z);
+    }
+    (*cmd).pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost,
+        vk::DependencyFlags(),
+        {vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eHostRead}}, {},
+        {}, ctx.dispatcher);
+    cmd.end();
+    cmd.submit(r.selectionFence.get(), /*reset fence*/ true, /*reset config*/ true);
+    r.selectionPending = true;
+    return true;
+  }
 
-          (*cmd).pushConstants(sceneAugmentRenderer.genTextPipeline.get(),
-                               vk::ShaderStageFlagBits::eCompute, 0, sizeof(genTextParams),
-                               &genTextParams);
-          (*cmd).dispatch((extent.width + 31) / 32, (extent.height + 31) / 32, 1);
+  bool SceneEditor::retrieveBoxSelection() {
+    auto &ctx = this->ctx();
+    auto &r = sceneAugmentRenderer;
+    if (!r.selectionPending) return false;
+    if (ctx.device.getFenceStatus((vk::Fence)r.selectionFence.get(), ctx.dispatcher)
+        != vk::Result::eSuccess)
+      return false;
+    r.selectionPending = false;
+
+    const u32 numSelectedIndices
+        = *(const u32 *)r.selectionResultCounterBuffer.get().mappedAddress();
+    selectedIndices.resize(numSelectedIndices);
+    if (numSelectedIndices)
+      std::memcpy(selectedIndices.data(), r.selectionResultBuffer.get().mappedAddress(),
+                  sizeof(glm::ivec2) * numSelectedIndices);
+    return true;
+  }
 
-          cmd.end();
-          cmd.submit(fence.get(), /*reset fence*/ true, /*reset config*/ true);
+  void SceneEditor::renderSceneAugmentView() {
+    auto &ctx = this->ctx();
 
-          fence.get().wait();
-        }
-      }
+    fence.get().wait();
 
-      endText();
+    retrieveBoxSelection();
 
-      sceneAugmentRenderer.counterBuffer.get().map();
-      sceneAugmentRenderer.numLetters
-          = *(u32 *)sceneAugmentRenderer.counterBuffer.get().mappedAddress();
-      sceneAugmentRenderer.counterBuffer.get().unmap();
+    auto &cmd = this->cmd.get();
 
 #if ENABLE_PROFILE
-      timer.tock("SceneEditor::update overlay text");
+    CppTimer timer;
 #endif
+
+    /// @note index labels of the focused prim, the glyphs are only regenerated upon focus or
+    /// geometry changes, whereas camera motion is handled by the vertex shader
+    auto textPrim = focusPrimPtr.lock();
+    const VkModel *textModel = nullptr;
+    if (showIndex && textPrim) {
+      auto pModel = textPrim->queryVkTriMesh(ctx, sceneRenderData.currentTimeCode);
+      if (pModel && pModel->verts.vertexCount && currentVisiblePrimsDrawn.at(textPrim.get()))
+        textModel = pModel;
+    }
+    bool genText = false;
+    {
+      auto &r = sceneAugmentRenderer;
+      const bool screenSpace
+          = textModel && !has_zsmesh_positions(*textPrim, (u32)textModel->verts.vertexCount);
+      glm::mat4 mvp{0.f};
+      if (textModel && screenSpace) {
+        const auto &cam = sceneRenderData.camera.get();
+        mvp = cam.matrices.perspective * cam.matrices.view
+              * textPrim->currentTimeVisualTransform();
+      }
+      if (!textModel) {
+        r.numLabels = r.numLetters = 0;
+      } else if (screenSpace) {
+        /// @note the pick buffer of the frame is reread once the view or the geometry changes
+        if (!r.overlayTextScreenSpace || r.overlayTextNeedUpdate || r.overlayTextMvp != mvp
+            || r.overlayTextModel != textModel || r.overlayTextPrimId != textPrim->id()
+            || r.overlayTextTimeCode != sceneRenderData.currentTimeCode) {
+          r.overlayTextModel = textModel;
+          r.overlayTextPrimId = textPrim->id();
+          r.overlayTextTimeCode = sceneRenderData.currentTimeCode;
+          r.overlayTextMvp = mvp;
+          r.overlayTextNeedUpdate = false;
+          r.overlayTextScreenSpace = true;
+          r.numLetters = r.numLabels = generateScreenSpaceText(textPrim->id());
+        }
+      } else if (r.overlayTextScreenSpace || r.overlayTextNeedUpdate
+                 || r.overlayTextModel != textModel
+                 || r.overlayTextPrimId != textPrim->id()
+                 || r.overlayTextVertexCount != (u32)textModel->verts.vertexCount
+                 || r.overlayTextTimeCode != sceneRenderData.currentTimeCode) {
+        r.overlayTextModel = textModel;
+        r.overlayTextPrimId = textPrim->id();
+        r.overlayTextVertexCount = (u32)textModel->verts.vertexCount;
+        r.overlayTextTimeCode = sceneRenderData.currentTimeCode;
+        r.overlayTextNeedUpdate = false;
+        r.overlayTextScreenSpace = false;
+        /// @note the labels that fit into the glyph budget as a whole
+        u32 lo = 0, hi = r.overlayTextVertexCount;
+        while (lo < hi) {
+          u32 mid = lo + (hi - lo + 1) / 2;
+          if (overlay_text_glyph_offset(mid) <= TEXTOVERLAY_MAX_CHAR_COUNT)
+            lo = mid;
+          else
+            hi = mid - 1;
+        }
+        r.numLabels = lo;
+        r.numLetters = overlay_text_glyph_offset(lo);
+        genText = true;
+      }
+    }
+
+    /// @note a stroke ends once a frame passes without a dab, the dab in flight is shown once done
+    if (!(viewportHovered && interactionMode.isPaintMode() && paintCenter)) flushPaintStroke();
+    retrievePaintRecords(/*wait*/ false);
+    if (scenePaintHistory.requestedStep) {
+      stepPaintHistory(scenePaintHistory.requestedStep);
+      scenePaintHistory.requestedStep = 0;
     }
 
     if (viewportHovered) {
@@ -680,6 +1204,10 @@ void main() {
         // fmt::print("painting focus prim id: {} (name {})\n", paintParams.focusObjId, focusPrim ?
         // focusPrim->label() : "null");
 
+        /// @note the footprint is gathered for both brushes, the gpu one only takes its prims.
+        /// both upload into the model color buffers
+        const bool brushOnGpu
+            = paintOnGpu && modelBufferSupports(vk::BufferUsageFlagBits::eTransferDst);
         glm::uvec2 extent;
         if (paintCenter) {
           auto center = (*paintCenter);
@@ -698,10 +1226,8 @@ void main() {
           paintParams.radius = 0;
         }
 
-        sceneAugmentRenderer.counterBuffer.get().map();
         *((u32 *)sceneAugmentRenderer.counterBuffer.get().mappedAddress()) = 0;
         *((int *)sceneAugmentRenderer.counterBuffer.get().mappedAddress() + 1) = -1;
-        sceneAugmentRenderer.counterBuffer.get().unmap();
         sceneAugmentRenderer.counterBuffer.get().flush();
 
         {
@@ -725,7 +1251,6 @@ void main() {
           fence.get().wait();  // wait for computation then retrieve indices
         }
 
-        sceneAugmentRenderer.counterBuffer.get().map();
         auto numSelectedIndices
             = *((u32 *)sceneAugmentRenderer.counterBuffer.get().mappedAddress());
         PrimIndex hoveredObjId
@@ -733,67 +1258,32 @@ void main() {
         static_assert(is_same_v<PrimIndex, int>, "PrimIndex should be of type int.");
         hoveredPrimPtr = getScenePrimById(hoveredObjId);
         if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) focusPrimPtr = hoveredPrimPtr;
-        sceneAugmentRenderer.counterBuffer.get().unmap();
 
         if (paintCenter) {
           selectedIndices.resize(numSelectedIndices);
-          sceneAugmentRenderer.selectedIndicesBuffer.get().map();
           std::memcpy(selectedIndices.data(),
                       sceneAugmentRenderer.selectedIndicesBuffer.get().mappedAddress(),
                       sizeof(glm::ivec2) * numSelectedIndices);
-          sceneAugmentRenderer.selectedIndicesBuffer.get().unmap();
 
-          zs::Buffer *prevClrBuffer = nullptr;
-          std::sort(selectedIndices.begin(), selectedIndices.end(),
-                    [](const glm::ivec2 &a, const glm::ivec2 &b) { return a[0] < b[0]; });
-          /// actual painting
-
-          // zs_execution().ref_event_scheduler().enqueue([&ctx, this]() {});
+          /// @note group the painted vertices by prim
           std::map<ZsPrimitive *, std::vector<PrimIndex>> paintJobs;
-          for (int i = 0; i < numSelectedIndices; ++i) {
+          for (u32 i = 0; i != numSelectedIndices; ++i) {
             auto ids = selectedIndices[i];
-
-            auto primPtr = getScenePrimById(ids.x);
-            // if (primPtr.expired()) continue;
-            auto prim = primPtr.lock();
-            // fmt::print("iterating prim (label: {}, id: {}) [{}] vert [{}]\n", prim->label(),
-            // prim->id(), ids.x, ids.y);
+            auto prim = getScenePrimById(ids.x).lock();
+            if (!prim) continue;
             auto pModel = prim->queryVkTriMesh(ctx, sceneRenderData.currentTimeCode);
             if (!pModel || currentVisiblePrimsDrawn.at(prim.get()) == 0) continue;
-            auto &model = *pModel;
-
+            /// @note only time-invariant colors are written back to the zsmesh
+            if (!prim->details().isAttribTimeInvariant(KEYFRAME_ATTRIB_COLOR_LABEL)) continue;
             paintJobs[prim.get()].push_back(ids.y);
-#if 0
-            // auto &clrBuffer = sceneRenderData.models[ids.x].getColorBuffer();
-            // auto &clrBuffer = getScenePrimByIndex(ids.x)->vkTriMesh(ctx).getColorBuffer();
-            auto &clrBuffer = model.getColorBuffer();
-            if (&clrBuffer != prevClrBuffer) {
-              if (prevClrBuffer) {
-                (*prevClrBuffer).unmap();
-                (*prevClrBuffer).flush();
-              }
-              prevClrBuffer = &clrBuffer;
-              clrBuffer.map();
-            }
-            *((glm::vec3 *)clrBuffer.mappedAddress() + ids.y) = paintColor;
-#endif
-          }
-#if 0
-          if (prevClrBuffer) {
-            (*prevClrBuffer).unmap();
-            (*prevClrBuffer).flush();
           }
-#endif
-          ZS_EVENT_SCHEDULER().emplace(
-              [paintJobs = zs::move(paintJobs),
-               paintColor = zs::vec<float, 3>{paintColor[0], paintColor[1], paintColor[2]}]() {
-                /// @note currently the prim is totally updated!
-                for (const auto &[primPtr, jobs] : paintJobs) {
-                  // changes happened at zsmesh,
-                  if (primPtr->details().isAttribTimeInvariant(KEYFRAME_ATTRIB_COLOR_LABEL))
-                    assign_zsmesh_colors(*primPtr, jobs, paintColor);
-                }
-              });
+          /// @note every prim under the brush (restricted to the focused one, as the gather) the
+          /// gpu brush is able to paint, the cpu path takes the rest
+          if (brushOnGpu)
+            for (auto it = std::begin(paintJobs); it != std::end(paintJobs);)
+              it = applyPaintBrush(*it->first, glm::ivec2(*paintCenter)) ? paintJobs.erase(it)
+                                                                          : std::next(it);
+          uploadPaintedColors(paintJobs);
 
           paintCenter = {};
         }
@@ -810,20 +1300,14 @@ void main() {
         selectionParams.focusObjId = focusPrim ? focusPrim->id() : -1;
         selectionParams.limit = MAX_SELECTION_INDICES;
 
-        glm::ivec2 extent;
-        if (selectionBox) {
-          selectionParams.offset = (*selectionBox).offset;
-          extent = (*selectionBox).extent;
-        } else {
-          selectionParams.offset = glm::ivec2(canvasLocalMousePos[0], canvasLocalMousePos[1]);
-          extent = glm::uvec2(1, 1);
-        }
+        /// @note only the hovered pixel is gathered here, box selection is compacted on the gpu
+        /// and retrieved asynchronously by retrieveBoxSelection()
+        glm::ivec2 extent = glm::uvec2(1, 1);
+        selectionParams.offset = glm::ivec2(canvasLocalMousePos[0], canvasLocalMousePos[1]);
         selectionParams.extent = extent;
 
-        sceneAugmentRenderer.counterBuffer.get().map();
         *((u32 *)sceneAugmentRenderer.counterBuffer.get().mappedAddress()) = 0;
         *((int *)sceneAugmentRenderer.counterBuffer.get().mappedAddress() + 1) = -1;
-        sceneAugmentRenderer.counterBuffer.get().unmap();
         sceneAugmentRenderer.counterBuffer.get().flush();
 
         {
@@ -848,7 +1332,6 @@ void main() {
           fence.get().wait();  // wait for computation then retrieve indices
         }
 
-        sceneAugmentRenderer.counterBuffer.get().map();
         auto numSelectedIndices
             = *((u32 *)sceneAugmentRenderer.counterBuffer.get().mappedAddress());
         // hoveredObjId = *((int *)sceneAugmentRenderer.counterBuffer.get().mappedAddress() + 1);
@@ -856,27 +1339,27 @@ void main() {
         PrimIndex hoveredObjId
             = *((int *)sceneAugmentRenderer.counterBuffer.get().mappedAddress() + 1);
         static_assert(is_same_v<PrimIndex, int>, "PrimIndex should be of type int.");
-        hoveredPrimPtr = getScenePrimById(hoveredObjId);
-        if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) focusPrimPtr = hoveredPrimPtr;
-
-        if (auto hoveredPrim = hoveredPrimPtr.lock()) {
-          if (get_ray_intersection_with_prim(getCameraPosition(),
-                                             getScreenPointCameraRayDirection(), *hoveredPrim,
-                                             &hoveredHitPt)) {
-            ;
-          }
+        /// @note the ray query picks the closest triangle mesh, the picked id covers the rest
+        const auto rayOrigin = getCameraPosition();
+        const auto rayDir = getScreenPointCameraRayDirection();
+        if (auto rayHitPrim = pickPrimByRay(rayOrigin, rayDir, &hoveredHitPt))
+          hoveredPrimPtr = getScenePrimById(rayHitPrim->id());
+        else {
+          hoveredPrimPtr = getScenePrimById(hoveredObjId);
+          if (auto hoveredPrim = hoveredPrimPtr.lock())
+            getRayIntersectionWithPrim(rayOrigin, rayDir, *hoveredPrim, &hoveredHitPt);
         }
+        if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) focusPrimPtr = hoveredPrimPtr;
 
-        sceneAugmentRenderer.counterBuffer.get().unmap();
 
+        /// @note the box refers to the current pick buffer, thus a selection still in flight is
+        /// completed first rather than deferring the new one
         if (selectionBox) {
-          selectedIndices.resize(numSelectedIndices);
-          sceneAugmentRenderer.selectedIndicesBuffer.get().map();
-          std::memcpy(selectedIndices.data(),
-                      sceneAugmentRenderer.selectedIndicesBuffer.get().mappedAddress(),
-                      sizeof(glm::ivec2) * numSelectedIndices);
-          sceneAugmentRenderer.selectedIndicesBuffer.get().unmap();
-
+          if (sceneAugmentRenderer.selectionPending) {
+            sceneAugmentRenderer.selectionFence.get().wait();
+            retrieveBoxSelection();
+          }
+          if (!issueBoxSelection(*selectionBox, focusPrim.get())) selectedIndices.clear();
           selectionBox = {};
         }
 #if ENABLE_PROFILE
@@ -891,6 +1374,97 @@ void main() {
 #endif
     cmd.begin();
 
+    if (sceneAugmentRenderer.numLabels && !sceneAugmentRenderer.overlayTextScreenSpace) {
+#if ENABLE_PROFILE
+      CppTimer textTimer;
+      textTimer.tick();
+#endif
+      auto &r = sceneAugmentRenderer;
+      const u32 numGroups = (r.numLabels + 255) / 256;
+      if (genText) {
+        /// @note the model buffers are vertex input only, thus the positions are copied from the
+        /// zsmesh points
+        const u32 numVerts = r.overlayTextVertexCount;
+        auto &capacity = r.overlayTextPositionCapacity;
+        if (numVerts > capacity) {
+          capacity = std::max(numVerts, capacity + capacity / 2);
+          r.overlayTextPositionBuffer = ctx.createBuffer(
+              sizeof(glm::vec3) * capacity, vk::BufferUsageFlagBits::eStorageBuffer,
+              vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+          r.overlayTextPositionBuffer.get().map();
+        }
+        const auto pos = textPrim->points().getAttrib(ATTRIB_POS_TAG, wrapt<glm::vec3>{});
+        auto dst = (glm::vec3 *)r.overlayTextPositionBuffer.get().mappedAddress();
+        for (u32 i = 0; i != numVerts; ++i) dst[i] = pos[i];
+        ctx.writeDescriptorSet(r.overlayTextPositionBuffer.get().descriptorInfo(), r.textGenSet,
+                               vk::DescriptorType::eStorageBuffer, /*binding*/ 1);
+        (*cmd).bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                  /*pipeline layout*/ r.genTextPipeline.get(),
+                                  /*firstSet*/ 0,
+                                  /*descriptor sets*/ {r.textGenSet},
+                                  /*dynamic offset*/ {}, ctx.dispatcher);
+        (*cmd).bindPipeline(vk::PipelineBindPoint::eCompute, r.genTextPipeline.get());
+        GenTextParam genTextParams;
+        genTextParams.numLabels = r.numLabels;
+        (*cmd).pushConstants(r.genTextPipeline.get(), vk::ShaderStageFlagBits::eCompute, 0,
+                             sizeof(genTextParams), &genTextParams);
+        (*cmd).dispatch(numGroups, 1, 1);
+        (*cmd).pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+            vk::DependencyFlags(),
+            {vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite,
+                               vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite}},
+            {}, {}, ctx.dispatcher);
+      }
+
+      /// density culling, which depends on the view thus runs every frame
+      (*cmd).fillBuffer(r.overlayTextCellBuffer.get(), 0, VK_WHOLE_SIZE, ~(u32)0,
+                        ctx.dispatcher);
+      (*cmd).pipelineBarrier(
+          vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+          vk::DependencyFlags(),
+          {vk::MemoryBarrier{vk::AccessFlagBits::eTransferWrite,
+                             vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite}},
+          {}, {}, ctx.dispatcher);
+      (*cmd).bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                /*pipeline layout*/ r.cullTextPipeline.get(),
+                                /*firstSet*/ 0,
+                                /*descriptor sets*/ {r.textCullSet},
+                                /*dynamic offset*/ {}, ctx.dispatcher);
+      (*cmd).bindPipeline(vk::PipelineBindPoint::eCompute, r.cullTextPipeline.get());
+      const auto &cam = sceneRenderData.camera.get();
+      CullTextParam cullTextParams;
+      cullTextParams.mvp = cam.matrices.perspective * cam.matrices.view
+                           * textPrim->currentTimeVisualTransform();
+      cullTextParams.extent = glm::ivec2{(int)vkCanvasExtent.width, (int)vkCanvasExtent.height};
+      cullTextParams.cellExtent = glm::ivec2{TEXTOVERLAY_CELL_WIDTH, TEXTOVERLAY_CELL_HEIGHT};
+      cullTextParams.numLabels = r.numLabels;
+      cullTextParams.reversedZ = SceneEditor::reversedZ;
+      for (u32 stage = 0; stage != 3; ++stage) {
+        if (stage)
+          (*cmd).pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                 vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(),
+                                 {vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite,
+                                                    vk::AccessFlagBits::eShaderRead
+                                                        | vk::AccessFlagBits::eShaderWrite}},
+                                 {}, {}, ctx.dispatcher);
+        cullTextParams.stage = stage;
+        (*cmd).pushConstants(r.cullTextPipeline.get(), vk::ShaderStageFlagBits::eCompute, 0,
+                             sizeof(cullTextParams), &cullTextParams);
+        (*cmd).dispatch(numGroups, 1, 1);
+      }
+      (*cmd).pipelineBarrier(
+          vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eVertexInput,
+          vk::DependencyFlags(),
+          {vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite,
+                             vk::AccessFlagBits::eVertexAttributeRead}},
+          {}, {}, ctx.dispatcher);
+#if ENABLE_PROFILE
+      textTimer.tock(genText ? "\tSceneEditor:: overlay text generation & culling record"
+                             : "\tSceneEditor:: overlay text culling record");
+#endif
+    }
+
     vk::Rect2D rect = vk::Rect2D(vk::Offset2D(), vkCanvasExtent);
     std::array<vk::ClearValue, 2> clearValues{};
     // clearValues[0].color = vk::ClearColorValue{0.1f, 0.7f, 0.2f, 0.f};
@@ -1049,14 +1623,14 @@ void main() {
     }
 
     /// render text overlay
-    if (showIndex) {
+    if (sceneAugmentRenderer.numLabels) {
       (*cmd).beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
       auto viewport
           = vk::Viewport()
                 .setX(0 /*offsetx*/)
-                .setY(0 /*-offsety*/)
+                .setY(vkCanvasExtent.height /*-offsety*/)
                 .setWidth(float(vkCanvasExtent.width))
-                .setHeight(float(vkCanvasExtent.height))  // negative viewport, opengl conformant
+                .setHeight(-float(vkCanvasExtent.height))  // negative viewport, opengl conformant
                 .setMinDepth(0.0f)
                 .setMaxDepth(1.0f);
       (*cmd).setViewport(0, {viewport});
@@ -1074,8 +1648,22 @@ void main() {
       (*cmd).bindVertexBuffers(0, {(vk::Buffer)sceneAugmentRenderer.overlayTextBuffer.get()},
                                offsets, ctx.dispatcher);
 
-      if (sceneAugmentRenderer.numLetters)
-        (*cmd).draw(6 * sceneAugmentRenderer.numLetters, 1, 0, 0, ctx.dispatcher);
+      const auto &cam = sceneRenderData.camera.get();
+      OverlayTextParam overlayTextParams;
+      /// @note screen-space labels are anchored in ndc already
+      overlayTextParams.mvp = sceneAugmentRenderer.overlayTextScreenSpace
+                                  ? glm::mat4(1.f)
+                                  : cam.matrices.perspective * cam.matrices.view
+                                        * textPrim->currentTimeVisualTransform();
+      /// @note same glyph size as the former screen-space labels
+      overlayTextParams.glyphScale
+          = glm::vec2{3.5f / vkCanvasExtent.width, 3.5f / vkCanvasExtent.height};
+      overlayTextParams.depthBias = 1e-3f;
+      overlayTextParams.reversedZ = SceneEditor::reversedZ;
+      (*cmd).pushConstants(sceneAugmentRenderer.overlayPipeline.get(),
+                           vk::ShaderStageFlagBits::eVertex, 0, sizeof(overlayTextParams),
+                           &overlayTextParams);
+      (*cmd).draw(6 * sceneAugmentRenderer.numLetters, 1, 0, 0, ctx.dispatcher);
 
       (*cmd).endRenderPass();
     }
@@ -80,7 +80,6 @@ namespace zs {
 
     if (_dirty) {
       camera.updateViewMatrix();
-      _editor->sceneAugmentRenderer.overlayTextNeedUpdate = true;
       _dirty = false;
     }
   }
@@ -1,15 +1,25 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
 #include "SceneEditor.hpp"
 #include "world/scene/Primitive.hpp"
 
+/// @note per-cluster light lists are built by a compute pass, otherwise by the render workers
+#define CLUSTER_LIGHT_CULLING_ON_GPU 1
+
 namespace zs {
-  static const char g_cluster_light[] = R"(
+  /// @note one invocation per cluster, the lights are streamed through shared memory in view
+  /// space. the lights of a cluster are counted first, then a range of the pool is reserved and
+  /// filled in light order.
+  static const char g_cluster_light_cull[] = R"(
 #version 450
 
 const int CLUSTER_PIXEL_SIZE = 32;
 const int CLUSTER_Z_SIZE = 32;
-const int CLUSTER_LIGHT_CAPACITY = 63;
+const int LIGHT_TILE_SIZE = 64;
 
-layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+layout(local_size_x = 64) in;
 
 const float Deg2Rad = 3.1415926535 / 180.0;
 
@@ -27,56 +37,49 @@ struct LightInfo{
 layout(push_constant) uniform CameraInfo {
   layout (offset = 0) mat4 view;
   layout (offset = 64) vec4 cameraInfo; // fov, aspect, near, far
-  layout (offset = 80) ivec3 screenAndLightInfo; // screen width, screen height, light count
+  layout (offset = 80) ivec4 screenAndLightInfo; // screen width, screen height, light count, light index capacity
 } CameraUbo;
 layout(std430, binding = 0) readonly buffer LightList {
   LightInfo lightList[];
 };
 /* output */
-layout(std430, binding = 1) buffer ClusterLightList {
-  // for each k in [0, clusterCount):
-  // lightIndices[k*32]: size of light index, range [0, 31]
-  // lightIndices[k*32+1 to k*32+31]: light indices
+layout(std430, binding = 1) writeonly buffer ClusterLightList {
+  // [2k, 2k + 1]: offset (into lightIndices) and size of the light list of cluster k,
+  // followed by the pool of light indices
   int lightIndices[];
 };
+layout(std430, binding = 2) buffer LightIndexCounter {
+  uint numRequested; // might exceed the capacity
+  uint numOverflown;
+};
 
-void getPlanes(vec2 nearPlaneUV, vec2 nearPlaneUVNext, in mat4 invView, out vec4 planes[5]){
-  float halfNearHeight = CameraUbo.cameraInfo.z * tan(CameraUbo.cameraInfo.x * Deg2Rad * 0.5); // near-z * tan(0.5 * fov)
-  float halfNearWidth = halfNearHeight * CameraUbo.cameraInfo.y; // half near-height * aspect
-  // min/max view space vector of current cluster
-  nearPlaneUV = nearPlaneUV * 2.0 - 1.0; // map to [-1, 1]
-  nearPlaneUVNext = nearPlaneUVNext * 2.0 - 1.0; // map to [-1, 1]
-  vec3 nearLeftDown = normalize(vec3(vec2(halfNearWidth, halfNearHeight) * nearPlaneUV, -CameraUbo.cameraInfo.z));
-  vec3 nearRightUp = normalize(vec3(vec2(halfNearWidth, halfNearHeight) * nearPlaneUVNext, -CameraUbo.cameraInfo.z));
-  const vec3 nearUp = vec3(0.0, 1.0, 0.0);
-  const vec3 nearRight = vec3(1.0, 0.0, 0.0);
-  // calculate plane normals base on current cluster
-  planes[0].xyz = normalize(cross(nearUp, nearLeftDown)); // left
-  planes[1].xyz = normalize(cross(nearRightUp, nearUp)); // right
-  planes[2].xyz = normalize(cross(nearRight, nearRightUp)); // top
-  planes[3].xyz = normalize(cross(nearLeftDown, nearRight)); // down
-
-  // convert into world space
-  for (int i=0; i<4; ++i){
-    planes[i].w = 0.0;
-    planes[i].xyz = normalize((invView * planes[i]).xyz); // convert normal from view space to world space
-    planes[i].w = dot(planes[i].xyz, invView[3].xyz /* camera world pos */ ); // plane offset
-  }
-}
-
-float intersect(in vec4 planes[5], in vec2 depthRange, in LightInfo lightInfo){
-  float result = 1.0;
+// view space center and radius, negative radius for distant (-1) or unsupported (-2) lights
+shared vec4 s_lights[LIGHT_TILE_SIZE];
 
-  // check interection with four planes for current cluster
-  for (int i=0; i<4; ++i){
-    result *= step(dot(planes[i].xyz, lightInfo.lightVec.xyz) - planes[i].w, lightInfo.lightVec.w);
-  }
+vec3 planes[4]; // left, right, top, down
+vec2 depthRange;
 
-  // deal with forward direction
-  float depth = dot(planes[4].xyz, lightInfo.lightVec.xyz) - planes[4].w; // positive view space depth
-  result *= step(depthRange.x, depth + lightInfo.lightVec.w) * step(depth - lightInfo.lightVec.w, depthRange.y); // sphere depth should be in depth range
+bool intersect(vec4 light){
+  if (light.w < 0.0) return light.w == -1.0;
+  for (int i=0; i<4; ++i)
+    if (dot(planes[i], light.xyz) > light.w) return false;
+  float depth = -light.z; // positive view space depth
+  return depth + light.w >= depthRange.x && depth - light.w <= depthRange.y; // sphere depth should be in depth range
+}
 
-  return result;
+void loadLights(int base){
+  int i = base + int(gl_LocalInvocationID.x);
+  barrier();
+  if (i < CameraUbo.screenAndLightInfo.z){
+    LightInfo light = lightList[i];
+    vec4 viewLight = vec4(0.0, 0.0, 0.0, -2.0);
+    if (light.lightSourceType.x == 0) // distant light
+      viewLight.w = -1.0;
+    else if (light.lightSourceType.x == 1) // point light
+      viewLight = vec4((CameraUbo.view * vec4(light.lightVec.xyz, 1.0)).xyz, light.lightVec.w);
+    s_lights[gl_LocalInvocationID.x] = viewLight;
+  }
+  barrier();
 }
 
 void main() {
@@ -84,106 +87,179 @@ void main() {
   const ivec2 cluster_size = (CameraUbo.screenAndLightInfo.xy + CLUSTER_PIXEL_SIZE - 1) / CLUSTER_PIXEL_SIZE;
   const int cluster_screen_count = cluster_size.x * cluster_size.y;
   const int cluster_count = CLUSTER_Z_SIZE * cluster_screen_count;
+  const int light_count = CameraUbo.screenAndLightInfo.z;
   const float depthPerCluster = CameraUbo.cameraInfo.w / float(CLUSTER_Z_SIZE);
 
-  const int TOTAL_THREAD_SIZE = int(gl_NumWorkGroups.x * gl_WorkGroupSize.x * gl_NumWorkGroups.y * gl_WorkGroupSize.y * gl_NumWorkGroups.z * gl_WorkGroupSize.z);
-  int tid = int(gl_GlobalInvocationID.x + gl_GlobalInvocationID.y * gl_NumWorkGroups.x * gl_WorkGroupSize.x);
-
-  vec4 planes[5]; // left, right, top, down and forward
-  const mat4 invView = transpose(CameraUbo.view);
-
-  // calculate forward direction once
-  planes[4] = -invView[2]; // world space camera forward
-  planes[4].xyz = normalize(planes[4].xyz);
-  planes[4].w = dot(planes[4].xyz, invView[3].xyz /* world camera pos */); // plane offset
-
-  for (int cid = tid; cid < cluster_count; cid += TOTAL_THREAD_SIZE){
-    // convert cluster id from cid to (cidx, cidy, cidz)
-    int cidz = cid / cluster_screen_count;
-    int screen_cid = cid - cidz * cluster_screen_count;
-    int cidy = screen_cid / cluster_size.x;
-    int cidx = screen_cid - cidy * cluster_size.x;
-    cidy = cluster_size.y - 1 - cidy; // y = 0 is at the top of screen
-
-    vec2 depthRange = vec2(cidz, cidz + 1.0) * depthPerCluster;
-
-    // construct cluster data for intersection check
-    vec2 current_pixel = vec2(cidx, cidy) * CLUSTER_PIXEL_SIZE;
-    getPlanes(
-      current_pixel / vec2(CameraUbo.screenAndLightInfo.xy),
-      (current_pixel + 32.0) / vec2(CameraUbo.screenAndLightInfo.xy),
-      invView, planes
-    );
+  const int cid = int(gl_GlobalInvocationID.x);
+  const bool active = cid < cluster_count;
 
-    // traverse lights and check intersection
-    int clusterLightCount = 0;
-    int clusterLightIndexBase = cid << 6; // 1(size of index) + 31(index list) ints for each cluster
-    for (int i=0; i<CameraUbo.screenAndLightInfo.z && clusterLightCount<CLUSTER_LIGHT_CAPACITY; ++i){
-      if (lightList[i].lightSourceType.x == 0){ // distant light
-        ++clusterLightCount;
-        lightIndices[clusterLightIndexBase + clusterLightCount] = i;
-      } else if (intersect(planes, depthRange, lightList[i]) > 0.5){ // point light
-        ++clusterLightCount;
-        lightIndices[clusterLightIndexBase + clusterLightCount] = i;
-      }
-    }
-    lightIndices[clusterLightIndexBase] = clusterLightCount;
+  // convert cluster id from cid to (cidx, cidy, cidz)
+  int cidz = cid / cluster_screen_count;
+  int screen_cid = cid - cidz * cluster_screen_count;
+  int cidy = screen_cid / cluster_size.x;
+  int cidx = screen_cid - cidy * cluster_size.x;
+  cidy = cluster_size.y - 1 - cidy; // y = 0 is at the top of screen
+
+  // cluster bounding planes in view space, which pass through the camera
+  float halfNearHeight = CameraUbo.cameraInfo.z * tan(CameraUbo.cameraInfo.x * Deg2Rad * 0.5); // near-z * tan(0.5 * fov)
+  float halfNearWidth = halfNearHeight * CameraUbo.cameraInfo.y; // half near-height * aspect
+  vec2 uv0 = vec2(cidx, cidy) * CLUSTER_PIXEL_SIZE / vec2(CameraUbo.screenAndLightInfo.xy) * 2.0 - 1.0;
+  vec2 uv1 = vec2(cidx + 1, cidy + 1) * CLUSTER_PIXEL_SIZE / vec2(CameraUbo.screenAndLightInfo.xy) * 2.0 - 1.0;
+  planes[0] = normalize(vec3(-CameraUbo.cameraInfo.z, 0.0, -halfNearWidth * uv0.x));
+  planes[1] = normalize(vec3(CameraUbo.cameraInfo.z, 0.0, halfNearWidth * uv1.x));
+  planes[2] = normalize(vec3(0.0, CameraUbo.cameraInfo.z, halfNearHeight * uv1.y));
+  planes[3] = normalize(vec3(0.0, -CameraUbo.cameraInfo.z, -halfNearHeight * uv0.y));
+  depthRange = vec2(cidz, cidz + 1.0) * depthPerCluster;
+
+  // 1. count
+  uint count = 0;
+  for (int base = 0; base < light_count; base += LIGHT_TILE_SIZE){
+    loadLights(base);
+    int n = min(LIGHT_TILE_SIZE, light_count - base);
+    for (int j = 0; j < n; ++j)
+      if (active && intersect(s_lights[j])) ++count;
+  }
+
+  // 2. reserve, the light indices beyond the capacity are dropped
+  const uint capacity = uint(CameraUbo.screenAndLightInfo.w);
+  const uint poolBase = uint(cluster_count) * 2;
+  uint offset = 0;
+  uint size = 0;
+  if (active){
+    if (count > 0) offset = atomicAdd(numRequested, count);
+    size = offset < capacity ? min(count, capacity - offset) : 0;
+    if (size < count) atomicAdd(numOverflown, count - size);
+    lightIndices[cid * 2] = int(poolBase + offset);
+    lightIndices[cid * 2 + 1] = int(size);
+  }
+
+  // 3. fill
+  uint written = 0;
+  for (int base = 0; base < light_count; base += LIGHT_TILE_SIZE){
+    loadLights(base);
+    int n = min(LIGHT_TILE_SIZE, light_count - base);
+    for (int j = 0; j < n; ++j)
+      if (written < size && intersect(s_lights[j]))
+        lightIndices[poolBase + offset + written++] = base + j;
   }
 }
 )";
 
+  struct LightCullParams {
+    glm::mat4 view;
+    glm::vec4 cameraInfo;          // fov, aspect, near, far
+    glm::ivec4 screenAndLightInfo;  // screen width, screen height, light count, index capacity
+  };
+
   void SceneEditor::setupLightingResources() {
     auto& ctx = this->ctx();
 
-    ResourceSystem::load_shader(ctx, "default_cluster_light.comp",
-                                vk::ShaderStageFlagBits::eCompute, g_cluster_light);
-    auto& clusterLightShader = ResourceSystem::get_shader("default_cluster_light.comp");
-    ctx.acquireSet(clusterLightShader.layout(0), sceneLighting.clusterLightingSet);
+#if CLUSTER_LIGHT_CULLING_ON_GPU
+    ResourceSystem::load_shader(ctx, "default_cluster_light_cull.comp",
+                                vk::ShaderStageFlagBits::eCompute, g_cluster_light_cull);
+    auto& lightCullShader = ResourceSystem::get_shader("default_cluster_light_cull.comp");
+    sceneLighting.lightCullPipeline = Pipeline{lightCullShader, sizeof(LightCullParams)};
+#endif
+    for (auto& frame : sceneLighting.frames) {
+#if CLUSTER_LIGHT_CULLING_ON_GPU
+      ctx.acquireSet(lightCullShader.layout(0), frame.lightCullSet);
+      frame.cmd = ctx.createCommandBuffer(vk_cmd_usage_e::reset, vk_queue_e::graphics, false);
+      frame.fence = Fence(ctx, true);
+#endif
+      frame.counterBuffer = ctx.createBuffer(
+          sizeof(u32) * 2,
+          vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+          vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+      frame.counterBuffer.get().map();
+      std::memset(frame.counterBuffer.get().mappedAddress(), 0, sizeof(u32) * 2);
+#if CLUSTER_LIGHT_CULLING_ON_GPU
+      ctx.writeDescriptorSet(frame.counterBuffer.get().descriptorInfo(), frame.lightCullSet,
+                             vk::DescriptorType::eStorageBuffer, 2 /* binding */
+      );
+#endif
+    }
 
     sceneLighting.lightList.reserve(32);
 
-    sceneLighting.clusterLightPipeline = Pipeline{
-        clusterLightShader, sizeof(glm::mat4) + sizeof(glm::vec4) + sizeof(glm::ivec3)};
-
     sceneLighting.clusterDimUbo = ctx.createBuffer(
         sizeof(glm::ivec2), vk::BufferUsageFlagBits::eUniformBuffer,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eDeviceLocal);
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+            | vk::MemoryPropertyFlagBits::eDeviceLocal);
     sceneLighting.clusterDimUbo.get().map();
 
     rebuildLightingFBO();
   }
 
-  void SceneEditor::ensureLightListBuffer() {
+  void SceneEditor::ensureLightListBuffer(SceneLighting::FrameResource& frame) {
     size_t targetBufferBytes = std::max((size_t)32, sceneLighting.lightList.size())
                                * sizeof(SceneEditor::SceneLightInfo);
-    if (!sceneLighting.lightInfoBuffer
-        || sceneLighting.lightInfoBuffer.get().getSize() < targetBufferBytes) {
-      sceneLighting.lightInfoBuffer = ctx().createBuffer(
+    if (!frame.lightInfoBuffer || frame.lightInfoBuffer.get().getSize() < targetBufferBytes) {
+      frame.lightInfoBuffer = ctx().createBuffer(
           targetBufferBytes, vk::BufferUsageFlagBits::eStorageBuffer,
-          vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCached);
-      sceneLighting.lightInfoBuffer.get().map();
-
+          vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+      frame.lightInfoBuffer.get().map();
+      frame.lightListVersion = 0;
 
       ctx().writeDescriptorSet(
-        sceneLighting.lightInfoBuffer.get().descriptorInfo(),
-        sceneLighting.clusterLightingSet,
+        frame.lightInfoBuffer.get().descriptorInfo(),
+        frame.lightTableSet,
         vk::DescriptorType::eStorageBuffer,
         0 /* binding */
       );
+#if CLUSTER_LIGHT_CULLING_ON_GPU
       ctx().writeDescriptorSet(
-        sceneLighting.lightInfoBuffer.get().descriptorInfo(),
-        sceneLighting.lightTableSet,
+        frame.lightInfoBuffer.get().descriptorInfo(),
+        frame.lightCullSet,
         vk::DescriptorType::eStorageBuffer,
         0 /* binding */
       );
+#endif
     }
   }
 
-  void SceneEditor::rebuildLightingFBO() {
+  void SceneEditor::allocateClusterLightBuffer(SceneLighting::FrameResource& frame,
+                                               size_t capacity) {
     auto& ctx = this->ctx();
+    frame.lightIndexCapacity = capacity;
+    frame.clusterLightInfoBuffer = ctx.createBuffer(
+        (sceneLighting.clusterCount * 2 + capacity) * sizeof(int),  // cluster light index list
+        vk::BufferUsageFlagBits::eStorageBuffer,
+#if CLUSTER_LIGHT_CULLING_ON_GPU
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+#else
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    frame.clusterLightInfoBuffer.get().map();
+    // no light until the first update
+    std::memset(frame.clusterLightInfoBuffer.get().mappedAddress(), 0,
+                sceneLighting.clusterCount * 2 * sizeof(int));
+#endif
+
+    ctx.writeDescriptorSet(frame.clusterLightInfoBuffer.get().descriptorInfo(),
+                           frame.lightTableSet, vk::DescriptorType::eStorageBuffer,
+                           1 /* binding */
+    );
+#if CLUSTER_LIGHT_CULLING_ON_GPU
+    ctx.writeDescriptorSet(frame.clusterLightInfoBuffer.get().descriptorInfo(),
+                           frame.lightCullSet, vk::DescriptorType::eStorageBuffer,
+                           1 /* binding */
+    );
+#endif
+  }
+
+  void SceneEditor::growClusterLightBuffers(size_t capacity) {
+#if CLUSTER_LIGHT_CULLING_ON_GPU
+    for (auto& frame : sceneLighting.frames) frame.fence.get().wait();
+#endif
+    for (auto& frame : sceneLighting.frames) {
+      if (frame.lightIndexCapacity < capacity) allocateClusterLightBuffer(frame, capacity);
+      std::memset(frame.counterBuffer.get().mappedAddress(), 0, sizeof(u32) * 2);
+    }
+  }
 
-    // initialize lightInfoBuffer
-    ensureLightListBuffer();
+  void SceneEditor::rebuildLightingFBO() {
+#if CLUSTER_LIGHT_CULLING_ON_GPU
+    for (auto& frame : sceneLighting.frames) frame.fence.get().wait();
+#endif
 
     // divide screen width per 32 pixels
     sceneLighting.clusterCountPerLine
@@ -203,33 +279,17 @@ void main() {
     sceneLighting.clusterCount
         = sceneLighting.clusterCountPerDepth
           * SceneLighting::CLUSTER_Z_SLICE;  // divide screen depth into 32 parts
-    sceneLighting.clusterLightInfoBuffer = ctx.createBuffer(
-        sceneLighting.clusterCount * SceneLighting::CLUSTER_LIGHT_INDEX_CAPACITY
-            * sizeof(int),  // cluster light index list
-        vk::BufferUsageFlagBits::eStorageBuffer,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCached);
-
-    ctx.writeDescriptorSet(sceneLighting.lightInfoBuffer.get().descriptorInfo(),
-                           sceneLighting.clusterLightingSet, vk::DescriptorType::eStorageBuffer,
-                           0 /* binding */
-    );
-    ctx.writeDescriptorSet(sceneLighting.clusterLightInfoBuffer.get().descriptorInfo(),
-                           sceneLighting.clusterLightingSet, vk::DescriptorType::eStorageBuffer,
-                           1 /* binding */
-    );
-
-    ctx.writeDescriptorSet(sceneLighting.lightInfoBuffer.get().descriptorInfo(),
-                           sceneLighting.lightTableSet, vk::DescriptorType::eStorageBuffer,
-                           0 /* binding */
-    );
-    ctx.writeDescriptorSet(sceneLighting.clusterLightInfoBuffer.get().descriptorInfo(),
-                           sceneLighting.lightTableSet, vk::DescriptorType::eStorageBuffer,
-                           1 /* binding */
-    );
-    ctx.writeDescriptorSet(sceneLighting.clusterDimUbo.get().descriptorInfo(),
-                           sceneLighting.lightTableSet, vk::DescriptorType::eUniformBufferDynamic,
-                           2 /* binding */
-    );
+    for (auto& frame : sceneLighting.frames) {
+      // initialize lightInfoBuffer
+      ensureLightListBuffer(frame);
+      allocateClusterLightBuffer(
+          frame, sceneLighting.clusterCount * SceneLighting::CLUSTER_LIGHT_INDEX_CAPACITY);
+
+      ctx().writeDescriptorSet(sceneLighting.clusterDimUbo.get().descriptorInfo(),
+                               frame.lightTableSet, vk::DescriptorType::eUniformBufferDynamic,
+                               2 /* binding */
+      );
+    }
   }
 
   glm::vec3 colorTemperatureToRGB(float temperatureInKelvins) {
@@ -287,23 +347,110 @@ void main() {
     maxPos = center + radius;
   }
 
+  /// @note first and last tile whose bounding planes [lo] and [hi] both pass the sphere (in view
+  /// space), which is an interval as either test is monotone along the tiles
+  static glm::ivec2 _getTileRange(const std::vector<glm::vec3>& planes, const glm::vec3& center,
+                                  float radius) {
+    glm::ivec2 range{0, -1};
+    const int numTiles = (int)planes.size() / 2;
+    for (int t = 0; t != numTiles; ++t)
+      if (glm::dot(planes[t * 2], center) <= radius
+          && glm::dot(planes[t * 2 + 1], center) <= radius) {
+        if (range[1] < range[0]) range[0] = t;
+        range[1] = t;
+      }
+    return range;
+  }
+
   void SceneEditor::updateClusterLighting() {
-    ensureLightListBuffer();
+    auto& lighting = sceneLighting;
+    lighting.frameNo = (lighting.frameNo + 1) % SceneLighting::NUM_FRAMES;
+    auto& frame = lighting.currentFrame();
+#if CLUSTER_LIGHT_CULLING_ON_GPU
+    /// @note submitted NUM_FRAMES frames ago, thus normally signaled already
+    frame.fence.get().wait();
+#endif
+
+    // grow the light index pools of all frames once any of them overflew
+    {
+      size_t capacity = 0;
+      for (auto& f : lighting.frames) {
+        auto counters = (const u32*)f.counterBuffer.get().mappedAddress();
+        if (counters[1])
+          capacity = std::max({capacity, (size_t)counters[0],
+                               f.lightIndexCapacity + f.lightIndexCapacity / 2});
+      }
+      if (capacity) growClusterLightBuffers(capacity);
+    }
+
+    auto& cam = sceneRenderData.camera.get();
+    const int numLights = (int)lighting.lightList.size();
+#if CLUSTER_LIGHT_CULLING_ON_GPU
+    /// @note lights are only uploaded when changed, frustum culling is left to the clusters
+    if (frame.lightListVersion != lighting.lightListVersion) {
+      ensureLightListBuffer(frame);
+      if (numLights)
+        std::memcpy(frame.lightInfoBuffer.get().mappedAddress(), lighting.lightList.data(),
+                    sizeof(SceneEditor::SceneLightInfo) * numLights);
+      frame.lightListVersion = lighting.lightListVersion;
+    }
+
+    auto& ctx = this->ctx();
+    auto& cmd = frame.cmd.get();
+    cmd.begin();
+    (*cmd).fillBuffer(frame.counterBuffer.get(), 0, sizeof(u32) * 2, 0, ctx.dispatcher);
+    (*cmd).pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+        vk::DependencyFlags(),
+        {vk::MemoryBarrier{vk::AccessFlagBits::eTransferWrite,
+                           vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite}},
+        {}, {}, ctx.dispatcher);
+
+    (*cmd).bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                              /*pipeline layout*/ lighting.lightCullPipeline.get(),
+                              /*firstSet*/ 0,
+                              /*descriptor sets*/ {frame.lightCullSet},
+                              /*dynamic offset*/ {}, ctx.dispatcher);
+    (*cmd).bindPipeline(vk::PipelineBindPoint::eCompute, lighting.lightCullPipeline.get());
+
+    LightCullParams params;
+    params.view = cam.matrices.view;
+    params.cameraInfo
+        = glm::vec4(cam.getFov(), cam.getAspect(), cam.getNearClip(), cam.getFarClip());
+    params.screenAndLightInfo = glm::ivec4{vkCanvasExtent.width, vkCanvasExtent.height, numLights,
+                                           (int)frame.lightIndexCapacity};
+    (*cmd).pushConstants(lighting.lightCullPipeline.get(), vk::ShaderStageFlagBits::eCompute, 0,
+                         sizeof(params), &params);
+    (*cmd).dispatch((lighting.clusterCount + 63) / 64, 1, 1);
+
+    /// @note the scene passes are submitted later to the same queue
+    (*cmd).pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eHost,
+        vk::DependencyFlags(),
+        {vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite,
+                           vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eHostRead}},
+        {}, {}, ctx.dispatcher);
+    (*cmd).end();
+    cmd.submit(frame.fence.get(), /*reset fence*/ true, /*reset config*/ true);
+#else
+    ensureLightListBuffer(frame);
 
     // check frustum visibility and emplace lights into
     glm::vec3 minPos, maxPos;
-    const glm::vec3& cameraPos = -sceneRenderData.camera.get().position;
+    const glm::vec3& cameraPos = -cam.position;
+    auto lights = (SceneEditor::SceneLightInfo*)frame.lightInfoBuffer.get().mappedAddress();
     int renderingLights = 0;
-    for (auto& lightInfo : sceneLighting.lightList) {
+    for (auto& lightInfo : lighting.lightList) {
       if (lightInfo.lightSourceType.x == 0) { // distant light
         ; // always pass
       } else if (lightInfo.lightSourceType.x == 1) { // point light
         // need to check sphere intersection
         const glm::vec3& center = lightInfo.lightVec;
         // if camera is not inside light sphere, then check if the sphere is visible in view
-        if ((center - cameraPos).length() > lightInfo.lightVec.w) {
+        if (glm::length(center - cameraPos) > lightInfo.lightVec.w) {
           _getAABBFromSphere(center, lightInfo.lightVec.w, minPos, maxPos);
-          if (!sceneRenderData.camera.get().isAABBVisible(minPos, maxPos)) {  // light is not visible
+          if (!cam.isAABBVisible(minPos, maxPos)) {  // light is not visible
             continue;
           }
         }
@@ -311,50 +458,120 @@ void main() {
         continue;
       }
 
-      memcpy((SceneEditor::SceneLightInfo*)sceneLighting.lightInfoBuffer.get().mappedAddress()
-                 + renderingLights,
-             &lightInfo, sizeof(SceneEditor::SceneLightInfo));
+      memcpy(lights + renderingLights, &lightInfo, sizeof(SceneEditor::SceneLightInfo));
       ++renderingLights;
     }
-    if (renderingLights == 0) {
-      return;
+    frame.lightListVersion = 0;  // filtered by the current view
+
+    /// cluster bounding planes in view space, the ones of a column (row) depend on x (y) only
+    const int numX = (int)lighting.clusterCountPerLine;
+    const int numY = (int)(lighting.clusterCountPerDepth / lighting.clusterCountPerLine);
+    const int numZ = (int)SceneLighting::CLUSTER_Z_SLICE;
+    const float nearClip = cam.getNearClip();
+    const float halfNearHeight = nearClip * std::tan(glm::radians((float)cam.getFov()) * 0.5f);
+    const float halfNearWidth = halfNearHeight * (float)cam.getAspect();
+    const float depthPerCluster = cam.getFarClip() / (float)numZ;
+    const glm::vec2 tileUv = glm::vec2((float)SceneLighting::CLUSTER_SCREEN_SIZE)
+                             / glm::vec2(vkCanvasExtent.width, vkCanvasExtent.height);
+    lighting.columnPlanes.resize(numX * 2);
+    for (int x = 0; x != numX; ++x) {
+      float u0 = (x * tileUv.x) * 2.f - 1.f, u1 = ((x + 1) * tileUv.x) * 2.f - 1.f;
+      lighting.columnPlanes[x * 2] = glm::normalize(glm::vec3(-nearClip, 0, -halfNearWidth * u0));
+      lighting.columnPlanes[x * 2 + 1]
+          = glm::normalize(glm::vec3(nearClip, 0, halfNearWidth * u1));
+    }
+    lighting.rowPlanes.resize(numY * 2);
+    for (int y = 0; y != numY; ++y) {
+      // y = 0 is at the top of screen
+      const int yUp = numY - 1 - y;
+      float v0 = (yUp * tileUv.y) * 2.f - 1.f, v1 = ((yUp + 1) * tileUv.y) * 2.f - 1.f;
+      lighting.rowPlanes[y * 2] = glm::normalize(glm::vec3(0, nearClip, halfNearHeight * v1));
+      lighting.rowPlanes[y * 2 + 1]
+          = glm::normalize(glm::vec3(0, -nearClip, -halfNearHeight * v0));
     }
 
-    // Start running cluster lighting
-    auto& ctx = this->ctx();
-    fence.get().wait();
-    auto& cmd = this->cmd.get();
-
-    cmd.begin();
-
-    (*cmd).bindDescriptorSets(vk::PipelineBindPoint::eCompute,
-                              /*pipeline layout*/ sceneLighting.clusterLightPipeline.get(),
-                              /*firstSet*/ 0,
-                              /*descriptor sets*/ {sceneLighting.clusterLightingSet},
-                              /*dynamic offset*/ {}, ctx.dispatcher);
-    (*cmd).bindPipeline(vk::PipelineBindPoint::eCompute, sceneLighting.clusterLightPipeline.get());
-
-    const auto& cam = sceneRenderData.camera.get();
-    // view
-    (*cmd).pushConstants(sceneLighting.clusterLightPipeline.get(),
-                         vk::ShaderStageFlagBits::eCompute, 0, sizeof(glm::mat4),
-                         &cam.matrices.view);
-    // camera info
-    const glm::vec4 cameraInfo
-        = glm::vec4(cam.getFov(), cam.getAspect(), cam.getNearClip(), cam.getFarClip());
-    (*cmd).pushConstants(sceneLighting.clusterLightPipeline.get(),
-                         vk::ShaderStageFlagBits::eCompute, sizeof(glm::mat4), sizeof(glm::vec4),
-                         &cameraInfo);
-    // screen size and lightCount
-    const glm::ivec3 clusterInfo{vkCanvasExtent.width, vkCanvasExtent.height, renderingLights};
-    (*cmd).pushConstants(
-        sceneLighting.clusterLightPipeline.get(), vk::ShaderStageFlagBits::eCompute,
-        sizeof(glm::mat4) + sizeof(glm::vec4), sizeof(glm::ivec3), &clusterInfo);
+    /// tile and slice ranges per light, which are then intersected per cluster
+    lighting.lightTileRanges.resize(renderingLights);
+    for (auto& sliceLights : lighting.sliceLights) sliceLights.clear();
+    for (int i = 0; i != renderingLights; ++i) {
+      const auto& light = lights[i];
+      if (light.lightSourceType.x == 0) {  // distant light, all clusters
+        lighting.lightTileRanges[i] = glm::ivec4{0, numX - 1, 0, numY - 1};
+        for (auto& sliceLights : lighting.sliceLights) sliceLights.push_back(i);
+        continue;
+      }
+      const glm::vec3 center = cam.matrices.view * glm::vec4(glm::vec3(light.lightVec), 1.f);
+      const float radius = light.lightVec.w;
+      const float depth = -center.z;  // positive view space depth
+      auto xs = _getTileRange(lighting.columnPlanes, center, radius);
+      auto ys = _getTileRange(lighting.rowPlanes, center, radius);
+      if (xs[1] < xs[0] || ys[1] < ys[0]) continue;
+      lighting.lightTileRanges[i] = glm::ivec4{xs[0], xs[1], ys[0], ys[1]};
+      for (int z = 0; z != numZ; ++z) {
+        const glm::vec2 depthRange = glm::vec2(z, z + 1.f) * depthPerCluster;
+        // sphere depth should be in depth range
+        if (depth + radius >= depthRange[0] && depth - radius <= depthRange[1])
+          lighting.sliceLights[z].push_back(i);
+      }
+    }
 
-    (*cmd).dispatch(32, 16, 1);
+    /// @note each worker handles whole rows of clusters, whose lists take a consecutive range of
+    /// the pool. the lights of a row are counted first, then the reserved range is filled.
+    /// the pools are grown and the lists rebuilt right away upon overflow, thus no light is dropped
+    const int numWorkers = renderScheduler->numWorkers();
+    std::atomic<u32> numRequested{0}, numOverflown{0};
+    for (;;) {
+      auto clusterLightIndices = (int*)frame.clusterLightInfoBuffer.get().mappedAddress();
+      const size_t poolBase = lighting.clusterCount * 2;
+      const size_t capacity = frame.lightIndexCapacity;
+      for (int j = 0; j != numWorkers; ++j)
+        renderScheduler->enqueue(
+            [&, j]() {
+              std::vector<u32> counts(numX), offsets(numX), sizes(numX);
+              u32 overflown = 0;
+              auto forEachCluster = [&](int y, int z, auto&& f) {
+                for (int i : lighting.sliceLights[z]) {
+                  const auto& range = lighting.lightTileRanges[i];
+                  if (y < range[2] || y > range[3]) continue;
+                  for (int x = range[0]; x <= range[1]; ++x) f(x, i);
+                }
+              };
+              for (int row = j; row < numY * numZ; row += numWorkers) {
+                const int z = row / numY, y = row - z * numY;
+                std::fill(counts.begin(), counts.end(), 0);
+                forEachCluster(y, z, [&](int x, int) { counts[x]++; });
+                u32 total = 0;
+                for (auto cnt : counts) total += cnt;
+                u32 offset = total ? numRequested.fetch_add(total) : 0;
+                int* grid = clusterLightIndices + (size_t)row * numX * 2;
+                for (int x = 0; x != numX; ++x) {
+                  offsets[x] = offset;
+                  sizes[x] = offset < capacity ? std::min(counts[x], (u32)(capacity - offset)) : 0;
+                  overflown += counts[x] - sizes[x];
+                  grid[x * 2] = (int)(poolBase + offset);
+                  grid[x * 2 + 1] = (int)sizes[x];
+                  offset += counts[x];
+                }
+                std::fill(counts.begin(), counts.end(), 0);
+                forEachCluster(y, z, [&](int x, int i) {
+                  if (counts[x] < sizes[x])
+                    clusterLightIndices[poolBase + offsets[x] + counts[x]++] = i;
+                });
+              }
+              numOverflown += overflown;
+            },
+            j);
+      renderScheduler->wait();
+      if (!numOverflown) break;
+      growClusterLightBuffers(
+          std::max((size_t)numRequested, frame.lightIndexCapacity + frame.lightIndexCapacity / 2));
+      numRequested = 0;
+      numOverflown = 0;
+    }
 
-    (*cmd).end();
-    cmd.submit(fence.get(), /*reset fence*/ true, /*reset config*/ true);
-    fence.get().wait();
+    auto counters = (u32*)frame.counterBuffer.get().mappedAddress();
+    counters[0] = numRequested;
+    counters[1] = numOverflown;
+#endif
   }
 }  // namespace zs
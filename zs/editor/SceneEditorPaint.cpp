@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "SceneEditor.hpp"
+#include "world/scene/PrimitiveOperation.hpp"
+#include "world/system/ZsExecSystem.hpp"
+
+namespace zs {
+
+  /// @note vertices without a color attribute are shaded white
+  static constexpr glm::vec3 g_default_vertex_color{1.f, 1.f, 1.f};
+
+  /// @note the vertex colors as held by the zsmesh, i.e. before the pending write-backs
+  static void gather_zsmesh_colors(ZsPrimitive &prim, const std::vector<PrimIndex> &ids,
+                                   std::vector<glm::vec3> &colors) {
+    const auto &points = prim.points();
+    colors.assign(ids.size(), g_default_vertex_color);
+    if (!points.hasAttrib(ATTRIB_COLOR_TAG)) return;
+    const auto clr = points.getAttrib(ATTRIB_COLOR_TAG, wrapt<glm::vec3>{});
+    const size_t numPoints = points.size();
+    for (size_t i = 0; i != ids.size(); ++i)
+      if (ids[i] >= 0 && (size_t)ids[i] < numPoints) colors[i] = clr[ids[i]];
+  }
+
+  /// @note the colors of all the model vertices, provided that the zsmesh points map onto them
+  static bool load_zsmesh_colors(ZsPrimitive &prim, u32 numVerts, glm::vec3 *colors) {
+    const auto &points = prim.points();
+    if (points.size() != numVerts) return false;
+    if (!points.hasAttrib(ATTRIB_COLOR_TAG)) {
+      std::fill_n(colors, numVerts, g_default_vertex_color);
+      return true;
+    }
+    const auto clr = points.getAttrib(ATTRIB_COLOR_TAG, wrapt<glm::vec3>{});
+    for (u32 i = 0; i != numVerts; ++i) colors[i] = clr[i];
+    return true;
+  }
+
+  ///
+  /// gpu brush
+  ///
+  bool SceneEditor::applyPaintBrush(ZsPrimitive &prim, const glm::ivec2 &center) {
+    auto &ctx = this->ctx();
+    auto &b = scenePaintBrush;
+    if (!b.brush.initialized()) b.brush.setup(ctx);
+    auto pModel = prim.queryVkTriMesh(ctx, sceneRenderData.currentTimeCode);
+    if (!pModel || !prim.details().isAttribTimeInvariant(KEYFRAME_ATTRIB_COLOR_LABEL)) return false;
+    const u32 numVerts = (u32)pModel->verts.vertexCount;
+    if (numVerts == 0) return false;
+
+    /// @note the previous dab is retired first, as the resources are reused
+    retrievePaintRecords(/*wait*/ true);
+
+    /// @note the canvas holds the first prim painted within the stroke, loaded as the stroke
+    /// begins (the zsmesh is up to date by then). the other prims are left to the cpu path
+    if (b.canvasPrim && b.canvasPrim != &prim) return false;
+    if (!b.canvasPrim || b.canvasModel != pModel || b.brush.numCanvasVerts() != numVerts) {
+      b.canvasPrim = nullptr;
+      if (!load_zsmesh_colors(prim, numVerts, b.brush.prepareCanvas(numVerts))) return false;
+      b.canvasPrim = &prim;
+      b.canvasModel = pModel;
+    }
+
+    PaintBrush::Param param;
+    param.color = paintColor;
+    param.center = center;
+    param.radius = paintRadius;
+    param.hardness = paintHardness;
+    param.opacity = paintOpacity;
+    param.primId = prim.id();
+    b.brush.apply(scenePickPass.pickBuffer.get(), param);
+    b.pendingPrim = &prim;
+    return true;
+  }
+
+  bool SceneEditor::retrievePaintRecords(bool wait) {
+    auto &b = scenePaintBrush;
+    if (!b.pendingPrim) return false;
+    std::vector<PaintBrush::Record> records;
+    if (!b.brush.retrieve(wait, records)) return false;
+    auto prim = std::exchange(b.pendingPrim, nullptr);
+
+    /// @note every vertex is recorded once per dab, the first previous color and the latest color
+    /// of each vertex are kept within the stroke
+    std::sort(std::begin(records), std::end(records),
+              [](const auto &lhs, const auto &rhs) { return lhs.vid < rhs.vid; });
+    auto &stroke = scenePaintUploader.strokeRecords[prim];
+    std::vector<PrimIndex> ids(records.size());
+    std::vector<glm::vec3> colors(records.size());
+    for (size_t i = 0; i != records.size(); ++i) {
+      stroke.add((PrimIndex)records[i].vid, records[i].prev, records[i].next);
+      ids[i] = (PrimIndex)records[i].vid;
+      colors[i] = records[i].next;
+    }
+    uploadVertexColors(*prim, ids, colors, /*record*/ false);
+    return true;
+  }
+
+  ///
+  /// color uploads (cpu path, undo and redo)
+  ///
+  /// @note vertices are written back in groups of the same color, a single group for a hard
+  /// brush at full opacity
+  static void write_back_colors(ZsPrimitive *prim, const std::vector<PrimIndex> &ids,
+                                const std::vector<glm::vec3> &colors) {
+    std::map<std::array<float, 3>, std::vector<PrimIndex>> groups;
+    for (size_t i = 0; i != ids.size(); ++i) {
+      const auto &c = colors[i];
+      groups[std::array<float, 3>{c[0], c[1], c[2]}].push_back(ids[i]);
+    }
+    ZS_EVENT_SCHEDULER().emplace([prim, groups = zs::move(groups)]() {
+      // changes happened at zsmesh,
+      if (!prim->details().isAttribTimeInvariant(KEYFRAME_ATTRIB_COLOR_LABEL)) return;
+      for (const auto &[c, jobs] : groups)
+        assign_zsmesh_colors(*prim, jobs, zs::vec<float, 3>{c[0], c[1], c[2]});
+    });
+  }
+
+  /// @note dabs of the stroke are written back right away on the cpu path, yet only the first
+  /// record of a vertex keeps its previous color, which is thus the one before the stroke
+  static void record_zsmesh_colors(ZsPrimitive &prim, const std::vector<PrimIndex> &ids,
+                                   const glm::vec3 &color, PaintStrokeRecord &stroke) {
+    std::vector<glm::vec3> prevColors;
+    gather_zsmesh_colors(prim, ids, prevColors);
+    for (size_t i = 0; i != ids.size(); ++i) stroke.add(ids[i], prevColors[i], color);
+  }
+
+  void SceneEditor::uploadPaintedColors(std::map<ZsPrimitive *, std::vector<PrimIndex>> &jobs) {
+    auto &ctx = this->ctx();
+    const std::vector<glm::vec3> colors{paintColor};
+    /// @note without transfer access to the color buffer, every dab updates the zsmesh instead
+    const bool upload = modelBufferSupports(vk::BufferUsageFlagBits::eTransferDst);
+    for (auto &[prim, ids] : jobs) {
+      auto pModel = prim->queryVkTriMesh(ctx, sceneRenderData.currentTimeCode);
+      if (!pModel) continue;
+      std::sort(std::begin(ids), std::end(ids));
+      ids.erase(std::unique(std::begin(ids), std::end(ids)), std::end(ids));
+      ids.erase(std::lower_bound(std::begin(ids), std::end(ids),
+                                 (PrimIndex)pModel->verts.vertexCount),
+                std::end(ids));
+      if (upload)
+        uploadVertexColors(*prim, ids, colors, /*record*/ true);
+      else {
+        record_zsmesh_colors(*prim, ids, paintColor, scenePaintUploader.strokeRecords[prim]);
+        write_back_colors(prim, ids, std::vector<glm::vec3>(ids.size(), paintColor));
+      }
+    }
+  }
+
+  void SceneEditor::uploadVertexColors(ZsPrimitive &prim, const std::vector<PrimIndex> &ids,
+                                       const std::vector<glm::vec3> &colors, bool record) {
+    auto &ctx = this->ctx();
+    auto &u = scenePaintUploader;
+    if (ids.empty() || colors.empty()) return;
+    auto pModel = prim.queryVkTriMesh(ctx, sceneRenderData.currentTimeCode);
+    if (!pModel) return;
+    if (!u.initialized) {
+      const size_t ringSize
+          = ScenePaintUploader::s_segment_size * ScenePaintUploader::s_num_segments;
+      u.staging = ctx.createStagingBuffer(ringSize, vk::BufferUsageFlagBits::eTransferSrc);
+      u.readback = ctx.createBuffer(
+          ringSize, vk::BufferUsageFlagBits::eTransferDst,
+          vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+      for (u32 i = 0; i != ScenePaintUploader::s_num_segments; ++i) {
+        u.cmds[i] = ctx.createCommandBuffer(vk_cmd_usage_e::reset, vk_queue_e::graphics, false);
+        u.fences[i] = Fence(ctx, true);
+        u.runs[i].clear();
+      }
+      u.segment = 0;
+      u.initialized = true;
+    }
+    /// @note the previous colors are copied back from the color buffer if possible. otherwise the
+    /// zsmesh still holds them, as the write-back is deferred to the stroke end
+    record = record && colors.size() == 1;
+    if (record && !modelBufferSupports(vk::BufferUsageFlagBits::eTransferSrc)) {
+      record_zsmesh_colors(prim, ids, colors[0], u.strokeRecords[&prim]);
+      record = false;
+    }
+
+    /// @note vertex colors of VkModel are tightly packed vec3
+    constexpr size_t stride = sizeof(glm::vec3);
+    constexpr size_t segmentCapacity = ScenePaintUploader::s_segment_size / stride;
+    const auto &dst = pModel->getColorBuffer();
+    auto &staging = u.staging.get();
+    staging.map();
+    auto ring = (glm::vec3 *)staging.mappedAddress();
+    std::vector<vk::BufferCopy> uploads, backups;
+    size_t used = 0;
+    auto submit = [&]() {
+      if (uploads.empty()) return;
+      staging.flush();
+      auto &cmd = u.cmds[u.segment].get();
+      cmd.begin();
+      if (!backups.empty()) {
+        (*cmd).copyBuffer((vk::Buffer)dst, u.readback.get(), backups, ctx.dispatcher);
+        (*cmd).pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                               vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {},
+                               {}, {}, ctx.dispatcher);
+      }
+      (*cmd).copyBuffer(staging, (vk::Buffer)dst, uploads, ctx.dispatcher);
+      (*cmd).pipelineBarrier(
+          vk::PipelineStageFlagBits::eTransfer,
+          vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eHost,
+          vk::DependencyFlags(),
+          {vk::MemoryBarrier{vk::AccessFlagBits::eTransferWrite,
+                             vk::AccessFlagBits::eVertexAttributeRead
+                                 | vk::AccessFlagBits::eHostRead}},
+          {}, {}, ctx.dispatcher);
+      cmd.end();
+      cmd.submit(u.fences[u.segment].get(), /*reset fence*/ true, /*reset config*/ true);
+      uploads.clear();
+      backups.clear();
+      /// @note the next segment is reused once its previous upload completes
+      u.segment = (u.segment + 1) % ScenePaintUploader::s_num_segments;
+      retireColorUploadSegment(u.segment);
+      used = 0;
+    };
+
+    retireColorUploadSegment(u.segment);
+    /// @note each run of consecutive vertices is uploaded as one copy region
+    for (size_t i = 0; i != ids.size();) {
+      if (used == segmentCapacity) submit();
+      const size_t maxLength = segmentCapacity - used;
+      size_t j = i + 1;
+      while (j != ids.size() && j - i < maxLength && ids[j] == ids[j - 1] + 1) ++j;
+      const size_t offset = u.segment * segmentCapacity + used;
+      if (colors.size() == 1)
+        std::fill_n(ring + offset, j - i, colors[0]);
+      else
+        std::copy(std::begin(colors) + i, std::begin(colors) + j, ring + offset);
+      const vk::BufferCopy region{offset * stride, (size_t)ids[i] * stride, (j - i) * stride};
+      uploads.push_back(region);
+      if (record) {
+        backups.push_back(vk::BufferCopy{region.dstOffset, region.srcOffset, region.size});
+        u.runs[u.segment].push_back(
+            ScenePaintUploader::Run{&prim, ids[i], (u32)(j - i), offset, colors[0]});
+      }
+      used += j - i;
+      i = j;
+    }
+    submit();
+    staging.unmap();
+  }
+
+  void SceneEditor::retireColorUploadSegment(u32 segment) {
+    auto &u = scenePaintUploader;
+    u.fences[segment].get().wait();
+    auto &runs = u.runs[segment];
+    if (runs.empty()) return;
+    auto &readback = u.readback.get();
+    readback.map();
+    auto prevColors = (const glm::vec3 *)readback.mappedAddress();
+    for (const auto &run : runs) {
+      auto &stroke = u.strokeRecords[run.prim];
+      for (u32 i = 0; i != run.count; ++i)
+        stroke.add(run.first + (PrimIndex)i, prevColors[run.offset + i], run.color);
+    }
+    readback.unmap();
+    runs.clear();
+  }
+
+  void SceneEditor::flushPaintStroke() {
+    auto &u = scenePaintUploader;
+    retrievePaintRecords(/*wait*/ true);
+    if (u.initialized)
+      for (u32 i = 1; i <= ScenePaintUploader::s_num_segments; ++i)
+        retireColorUploadSegment((u.segment + i) % ScenePaintUploader::s_num_segments);
+    if (u.strokeRecords.empty()) return;
+    scenePaintBrush.canvasPrim = nullptr;
+
+    PaintHistory::Stroke stroke;
+    std::vector<PrimIndex> ids;
+    std::vector<glm::vec3> prevColors, colors;
+    for (auto &[prim, record] : u.strokeRecords) {
+      record.sorted(ids, prevColors, colors);
+      /// @note the prim is totally updated by the write-back, yet only once per stroke since the
+      /// gpu colors are kept up to date during the stroke
+      write_back_colors(prim, ids, colors);
+      stroke.deltas.push_back(PaintDelta::compress(prim->id(), ids, prevColors, colors));
+    }
+    u.strokeRecords.clear();
+    scenePaintHistory.history.push(zs::move(stroke));
+  }
+
+  void SceneEditor::stepPaintHistory(int step) {
+    /// @note the ongoing stroke becomes the latest one to undo
+    flushPaintStroke();
+    auto &history = scenePaintHistory.history;
+    const auto stroke = step < 0 ? history.undo() : history.redo();
+    if (!stroke) return;
+    scenePaintBrush.canvasPrim = nullptr;
+    std::vector<PrimIndex> ids;
+    std::vector<glm::vec3> colors;
+    for (const auto &delta : stroke->deltas) {
+      auto prim = getScenePrimById(delta._primId).lock();
+      if (!prim) continue;
+      delta.decompressIds(ids);
+      delta.decompressColors(colors, /*prev*/ step < 0);
+      if (modelBufferSupports(vk::BufferUsageFlagBits::eTransferDst))
+        uploadVertexColors(*prim, ids, colors, /*record*/ false);
+      write_back_colors(prim.get(), ids, colors);
+    }
+  }
+
+}  // namespace zs
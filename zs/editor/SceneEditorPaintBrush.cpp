@@ -0,0 +1,242 @@
+#include "SceneEditorPaintBrush.hpp"
+
+#include <algorithm>
+
+namespace zs {
+
+  /// @note two stages over the brush footprint: 0. the max brush weight of each vertex is
+  /// gathered from the pick image 1. the first invocation to take a weight (resetting it) blends
+  /// the vertex color, thus every vertex is blended once per dab regardless of its coverage
+  static const char g_paint_brush_code[] = R"(
+#version 450
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = 0, rgba32i) uniform readonly iimage2D pickImage;
+layout(std430, binding = 1) buffer Weights { uint weights[]; };
+layout(std430, binding = 2) buffer Canvas { float colors[]; };
+struct PaintRecord {
+  uint vid;
+  float prev[3];
+  float next[3];
+};
+layout(std430, binding = 3) buffer Records { PaintRecord records[]; };
+layout(std430, binding = 4) buffer Counter { uint numRecords; };
+
+layout(push_constant) uniform Params {
+  vec4 color;
+  ivec2 offset;
+  ivec2 center;
+  float radius;
+  float hardness;
+  float opacity;
+  int primId;
+  uint numVerts;
+  uint recordLimit;
+  uint stage;
+  uint record;
+} params;
+
+void main() {
+  ivec2 p = params.offset + ivec2(gl_GlobalInvocationID.xy);
+  if (any(greaterThanEqual(p, imageSize(pickImage)))) return;
+  // the footprint of the cpu path, tested in integers as its gather
+  ivec2 d = p - params.center;
+  int r = int(params.radius);
+  if (d.x * d.x + d.y * d.y > r * r) return;
+  float dist = r > 0 ? min(length(vec2(d)) / float(r), 1) : 0;
+  ivec2 ids = imageLoad(pickImage, p).rg;
+  if (ids.r != params.primId || ids.g < 0 || uint(ids.g) >= params.numVerts) return;
+  uint v = uint(ids.g);
+
+  if (params.stage == 0) {
+    float f = dist <= params.hardness
+                  ? 1 : clamp((1 - dist) / max(1 - params.hardness, 1e-5), 0, 1);
+    float w = params.opacity * f * f * (3 - 2 * f);
+    if (w > 0) atomicMax(weights[v], floatBitsToUint(w));
+  } else {
+    uint wb = atomicExchange(weights[v], 0);
+    if (wb == 0) return;
+    vec3 prev = vec3(colors[3 * v], colors[3 * v + 1], colors[3 * v + 2]);
+    float w = uintBitsToFloat(wb);
+    // exactly the brush color at full weight, as the cpu path
+    vec3 next = prev * (1 - w) + params.color.rgb * w;
+    colors[3 * v] = next.r;
+    colors[3 * v + 1] = next.g;
+    colors[3 * v + 2] = next.b;
+    if (params.record != 0) {
+      uint i = atomicAdd(numRecords, 1);
+      if (i < params.recordLimit)
+        records[i] = PaintRecord(v, float[3](prev.r, prev.g, prev.b),
+                                 float[3](next.r, next.g, next.b));
+    }
+  }
+}
+)";
+
+  struct PaintBrushParam {
+    glm::vec4 color;
+    glm::ivec2 offset;
+    glm::ivec2 center;
+    float radius;
+    float hardness;
+    float opacity;
+    int primId;
+    u32 numVerts;
+    u32 recordLimit;
+    u32 stage;
+    u32 record;
+  };
+  static_assert(sizeof(PaintBrush::Record) == sizeof(u32) * 7,
+                "PaintBrush::Record should match the std430 layout of PaintRecord.");
+
+  ///
+  /// PaintBrush
+  ///
+  void PaintBrush::setup(VulkanContext &ctx) {
+    _ctx = &ctx;
+    ResourceSystem::load_shader(ctx, "default_paint_brush.comp", vk::ShaderStageFlagBits::eCompute,
+                                g_paint_brush_code);
+    auto &brushShader = ResourceSystem::get_shader("default_paint_brush.comp");
+    ctx.acquireSet(brushShader.layout(0), _set);
+    _pipeline = Pipeline{brushShader, sizeof(PaintBrushParam)};
+    _recordCounter = ctx.createBuffer(
+        sizeof(u32), vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    _recordCounter.get().map();
+    _cmd = ctx.createCommandBuffer(vk_cmd_usage_e::reset, vk_queue_e::graphics, false);
+    _fence = Fence(ctx, true);
+    _numCanvasVerts = _canvasCapacity = _weightCapacity = _recordCapacity = 0;
+    _weightsCleared = _pending = false;
+  }
+
+  glm::vec3 *PaintBrush::prepareCanvas(u32 numVerts) {
+    auto &ctx = *_ctx;
+    /// @note the canvas may still be read or written by the dab in flight
+    _fence.get().wait();
+    if (numVerts > _canvasCapacity) {
+      _canvasCapacity = std::max(numVerts, _canvasCapacity + _canvasCapacity / 2);
+      _canvas = ctx.createBuffer(
+          sizeof(glm::vec3) * _canvasCapacity, vk::BufferUsageFlagBits::eStorageBuffer,
+          vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+      _canvas.get().map();
+    }
+    if (numVerts > _weightCapacity) {
+      _weightCapacity = std::max(numVerts, _weightCapacity + _weightCapacity / 2);
+      _weights = ctx.createBuffer(
+          sizeof(u32) * _weightCapacity,
+          vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+          vk::MemoryPropertyFlagBits::eDeviceLocal);
+      _weightsCleared = false;
+    }
+    _numCanvasVerts = numVerts;
+    return canvas();
+  }
+
+  void PaintBrush::apply(vk::ImageView pickImage, const Param &param) {
+    auto &ctx = *_ctx;
+    if (_numCanvasVerts == 0) return;
+    _fence.get().wait();
+
+    const int radius = (int)param.radius;
+    const glm::ivec2 offset = glm::max(param.center - radius, glm::ivec2(0));
+    const glm::uvec2 extent = glm::uvec2(param.center + radius - offset + 1);
+    /// @note each pixel contributes one vertex at most, thus records never exceed the footprint
+    const u32 recordLimit = extent.x * extent.y;
+    if (recordLimit > _recordCapacity) {
+      _recordCapacity = std::max(recordLimit, _recordCapacity * 2);
+      _records = ctx.createBuffer(
+          sizeof(Record) * _recordCapacity, vk::BufferUsageFlagBits::eStorageBuffer,
+          vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+      _records.get().map();
+    }
+    auto &counter = _recordCounter.get();
+    *(u32 *)counter.mappedAddress() = 0;
+    counter.flush();
+
+    vk::DescriptorImageInfo imageInfo{};
+    imageInfo.sampler = VK_NULL_HANDLE;
+    imageInfo.imageView = pickImage;
+    imageInfo.imageLayout = vk::ImageLayout::eGeneral;
+    ctx.writeDescriptorSet(imageInfo, _set, vk::DescriptorType::eStorageImage, /*binding*/ 0);
+    ctx.writeDescriptorSet(_weights.get().descriptorInfo(), _set,
+                           vk::DescriptorType::eStorageBuffer, /*binding*/ 1);
+    ctx.writeDescriptorSet(_canvas.get().descriptorInfo(), _set,
+                           vk::DescriptorType::eStorageBuffer, /*binding*/ 2);
+    ctx.writeDescriptorSet(_records.get().descriptorInfo(), _set,
+                           vk::DescriptorType::eStorageBuffer, /*binding*/ 3);
+    ctx.writeDescriptorSet(counter.descriptorInfo(), _set, vk::DescriptorType::eStorageBuffer,
+                           /*binding*/ 4);
+
+    PaintBrushParam params;
+    params.color = glm::vec4(param.color, 1.f);
+    params.offset = offset;
+    params.center = param.center;
+    params.radius = (float)radius;
+    params.hardness = glm::clamp(param.hardness, 0.f, 1.f);
+    params.opacity = glm::clamp(param.opacity, 0.f, 1.f);
+    params.primId = param.primId;
+    params.numVerts = _numCanvasVerts;
+    params.recordLimit = recordLimit;
+    params.record = 1;
+
+    auto &cmd = _cmd.get();
+    cmd.begin();
+    /// @note the weights are reset by the apply stage, thus only cleared once upon allocation
+    if (!_weightsCleared) {
+      (*cmd).fillBuffer(_weights.get(), 0, VK_WHOLE_SIZE, 0, ctx.dispatcher);
+      _weightsCleared = true;
+    }
+    /// @note the pick image is written by the scene pass, the canvas by the host
+    (*cmd).pipelineBarrier(
+        vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eComputeShader,
+        vk::DependencyFlags(),
+        {vk::MemoryBarrier{vk::AccessFlagBits::eMemoryWrite,
+                           vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite}},
+        {}, {}, ctx.dispatcher);
+    (*cmd).bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                              /*pipeline layout*/ _pipeline.get(),
+                              /*firstSet*/ 0,
+                              /*descriptor sets*/ {_set},
+                              /*dynamic offset*/ {}, ctx.dispatcher);
+    (*cmd).bindPipeline(vk::PipelineBindPoint::eCompute, _pipeline.get());
+    for (u32 stage = 0; stage != 2; ++stage) {
+      if (stage)
+        (*cmd).pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+            vk::DependencyFlags(),
+            {vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite,
+                               vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite}},
+            {}, {}, ctx.dispatcher);
+      params.stage = stage;
+      (*cmd).pushConstants(_pipeline.get(), vk::ShaderStageFlagBits::eCompute, 0, sizeof(params),
+                           &params);
+      (*cmd).dispatch((extent.x + 15) / 16, (extent.y + 15) / 16, 1);
+    }
+    (*cmd).pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                           vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(),
+                           {vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite,
+                                              vk::AccessFlagBits::eHostRead}},
+                           {}, {}, ctx.dispatcher);
+    cmd.end();
+    cmd.submit(_fence.get(), /*reset fence*/ true, /*reset config*/ true);
+    _pending = true;
+  }
+
+  bool PaintBrush::retrieve(bool wait, std::vector<Record> &records) {
+    auto &ctx = *_ctx;
+    if (!_pending) return false;
+    if (wait)
+      _fence.get().wait();
+    else if (ctx.device.getFenceStatus((vk::Fence)_fence.get(), ctx.dispatcher)
+             != vk::Result::eSuccess)
+      return false;
+    const u32 numRecords
+        = std::min(*(const u32 *)_recordCounter.get().mappedAddress(), _recordCapacity);
+    auto src = (const Record *)_records.get().mappedAddress();
+    records.insert(std::end(records), src, src + numRecords);
+    _pending = false;
+    return true;
+  }
+
+}  // namespace zs
@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "world/system/ResourceSystem.hpp"
+#include "zensim/vulkan/Vulkan.hpp"
+
+namespace zs {
+
+  ///
+  /// @brief vertex color brush evaluated on the gpu over the vertices visible in a pick image
+  /// @note the brush blends into a canvas of its own, which holds the (tightly packed vec3)
+  /// colors of a single prim, and records the previous and the new color of every vertex it
+  /// touches. the model color buffers are never bound as storage, the records are uploaded to
+  /// them instead. a hard brush at full opacity paints exactly the brush color, as the cpu path.
+  ///
+  struct PaintBrush {
+    struct Param {
+      glm::vec3 color;
+      glm::ivec2 center;  // in pixels of the pick image
+      float radius;       // in pixels, truncated as the footprint gathered by the cpu path
+      float hardness;     // fraction of the radius painted at full opacity
+      float opacity;
+      int primId;
+    };
+    struct Record {
+      u32 vid;
+      glm::vec3 prev;
+      glm::vec3 next;
+    };
+
+    void setup(VulkanContext &ctx);
+    bool initialized() const noexcept { return _ctx != nullptr; }
+
+    /// @note the mapped canvas of [numVerts] colors, the content is kept unless it grows
+    glm::vec3 *prepareCanvas(u32 numVerts);
+    glm::vec3 *canvas() noexcept { return (glm::vec3 *)_canvas.get().mappedAddress(); }
+    u32 numCanvasVerts() const noexcept { return _numCanvasVerts; }
+
+    /// @note submits a dab over [pickImage] (in the general layout), the records of the
+    /// previous dab are to be retrieved beforehand since the resources are reused
+    void apply(vk::ImageView pickImage, const Param &param);
+    /// @note appends the records of the dab in flight, returns false if there is none or it is
+    /// not done yet (without [wait])
+    bool retrieve(bool wait, std::vector<Record> &records);
+    bool pending() const noexcept { return _pending; }
+
+  protected:
+    VulkanContext *_ctx{nullptr};
+    Owner<Pipeline> _pipeline;
+    vk::DescriptorSet _set;
+    Owner<Buffer> _canvas;   // host visible, persistently mapped
+    Owner<Buffer> _weights;  // per vertex brush weight, reset by the brush itself
+    Owner<Buffer> _records, _recordCounter;
+    u32 _numCanvasVerts{0}, _canvasCapacity{0}, _weightCapacity{0}, _recordCapacity{0};
+    Owner<VkCommand> _cmd;
+    Owner<Fence> _fence;
+    bool _weightsCleared{false}, _pending{false};
+  };
+
+}  // namespace zs
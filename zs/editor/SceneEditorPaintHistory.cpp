@@ -0,0 +1,113 @@
+#include "SceneEditorPaintHistory.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace zs {
+
+  /// @note colors are compared bitwise, thus -0.f and 0.f (or nan payloads) are kept apart
+  static void encode_color_runs(const std::vector<glm::vec3> &colors,
+                                std::vector<PaintDelta::ColorRun> &runs) {
+    runs.clear();
+    for (const auto &color : colors)
+      if (!runs.empty() && std::memcmp(&runs.back().color, &color, sizeof(glm::vec3)) == 0)
+        runs.back().count++;
+      else
+        runs.push_back(PaintDelta::ColorRun{1, color});
+  }
+
+  ///
+  /// PaintDelta
+  ///
+  PaintDelta PaintDelta::compress(i32 primId, const std::vector<i32> &ids,
+                                  const std::vector<glm::vec3> &prevColors,
+                                  const std::vector<glm::vec3> &colors) {
+    PaintDelta ret;
+    ret._primId = primId;
+    ret._numVertices = ids.size();
+    for (size_t i = 0; i != ids.size(); ++i)
+      if (!ret._idRuns.empty() && (i32)(ret._idRuns.back()[0] + ret._idRuns.back()[1]) == ids[i])
+        ret._idRuns.back()[1]++;
+      else
+        ret._idRuns.push_back(glm::uvec2{(u32)ids[i], 1});
+    encode_color_runs(prevColors, ret._prevColors);
+    encode_color_runs(colors, ret._colors);
+    ret._idRuns.shrink_to_fit();
+    ret._prevColors.shrink_to_fit();
+    ret._colors.shrink_to_fit();
+    return ret;
+  }
+
+  void PaintDelta::decompressIds(std::vector<i32> &ids) const {
+    ids.clear();
+    ids.reserve(_numVertices);
+    for (const auto &run : _idRuns)
+      for (u32 i = 0; i != run[1]; ++i) ids.push_back((i32)(run[0] + i));
+  }
+
+  void PaintDelta::decompressColors(std::vector<glm::vec3> &colors, bool prev) const {
+    colors.clear();
+    colors.reserve(_numVertices);
+    for (const auto &run : prev ? _prevColors : _colors)
+      colors.insert(std::end(colors), run.count, run.color);
+  }
+
+  ///
+  /// PaintStrokeRecord
+  ///
+  void PaintStrokeRecord::sorted(std::vector<i32> &sortedIds,
+                                 std::vector<glm::vec3> &sortedPrevColors,
+                                 std::vector<glm::vec3> &sortedColors) const {
+    const size_t n = ids.size();
+    std::vector<u32> order(n);
+    for (u32 i = 0; i != n; ++i) order[i] = i;
+    std::sort(std::begin(order), std::end(order), [this](u32 a, u32 b) { return ids[a] < ids[b]; });
+    sortedIds.resize(n);
+    sortedPrevColors.resize(n);
+    sortedColors.resize(n);
+    for (size_t i = 0; i != n; ++i) {
+      sortedIds[i] = ids[order[i]];
+      sortedPrevColors[i] = prevColors[order[i]];
+      sortedColors[i] = colors[order[i]];
+    }
+  }
+
+  ///
+  /// PaintHistory
+  ///
+  void PaintHistory::push(Stroke stroke) {
+    for (const auto &s : _redoStack) _numBytes -= s.numBytes();
+    _redoStack.clear();
+    _numBytes += stroke.numBytes();
+    _undoStack.push_back(std::move(stroke));
+    trim();
+  }
+
+  const PaintHistory::Stroke *PaintHistory::undo() {
+    if (_undoStack.empty()) return nullptr;
+    _redoStack.push_back(std::move(_undoStack.back()));
+    _undoStack.pop_back();
+    return &_redoStack.back();
+  }
+
+  const PaintHistory::Stroke *PaintHistory::redo() {
+    if (_redoStack.empty()) return nullptr;
+    _undoStack.push_back(std::move(_redoStack.back()));
+    _redoStack.pop_back();
+    return &_undoStack.back();
+  }
+
+  void PaintHistory::setBudget(size_t numBytes) {
+    _budget = numBytes;
+    trim();
+  }
+
+  void PaintHistory::trim() {
+    /// @note the latest stroke is always kept, even if it alone exceeds the budget
+    while (_numBytes > _budget && _undoStack.size() > 1) {
+      _numBytes -= _undoStack.front().numBytes();
+      _undoStack.pop_front();
+    }
+  }
+
+}  // namespace zs
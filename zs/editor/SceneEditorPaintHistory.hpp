@@ -0,0 +1,105 @@
+#pragma once
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "zensim/TypeAlias.hpp"
+
+namespace zs {
+
+  ///
+  /// @brief vertex colors of a prim before and after a paint stroke
+  /// @note the touched vertices are stored as runs of consecutive indices, and both color
+  /// sequences are run-length encoded, thus a hard brush stroke over a uniformly colored region
+  /// takes a few runs regardless of the number of vertices. colors are kept exact.
+  ///
+  struct PaintDelta {
+    /// @note [ids] are sorted and unique, [prevColors] and [colors] are of the same length
+    static PaintDelta compress(i32 primId, const std::vector<i32> &ids,
+                               const std::vector<glm::vec3> &prevColors,
+                               const std::vector<glm::vec3> &colors);
+    void decompressIds(std::vector<i32> &ids) const;
+    /// @note [prev] selects the colors before the stroke, otherwise the ones after
+    void decompressColors(std::vector<glm::vec3> &colors, bool prev) const;
+    size_t numVertices() const noexcept { return _numVertices; }
+    size_t numBytes() const noexcept {
+      return sizeof(PaintDelta) + _idRuns.size() * sizeof(glm::uvec2)
+             + (_prevColors.size() + _colors.size()) * sizeof(ColorRun);
+    }
+
+    struct ColorRun {
+      u32 count;
+      glm::vec3 color;
+    };
+    i32 _primId{-1};
+    size_t _numVertices{0};
+    std::vector<glm::uvec2> _idRuns;  // (first vertex, count)
+    std::vector<ColorRun> _prevColors, _colors;
+  };
+
+  ///
+  /// @brief vertices of a prim painted within the ongoing stroke
+  /// @note the color before the stroke is the one of the first record of a vertex, the color
+  /// after is the one of its latest record
+  ///
+  struct PaintStrokeRecord {
+    void add(i32 id, const glm::vec3 &prev, const glm::vec3 &next) {
+      auto [it, inserted] = index.emplace(id, (u32)ids.size());
+      if (inserted) {
+        ids.push_back(id);
+        prevColors.push_back(prev);
+        colors.push_back(next);
+      } else
+        colors[it->second] = next;
+    }
+    /// @note the records ordered by vertex, as PaintDelta::compress expects
+    void sorted(std::vector<i32> &sortedIds, std::vector<glm::vec3> &sortedPrevColors,
+                std::vector<glm::vec3> &sortedColors) const;
+
+    std::vector<i32> ids;
+    std::vector<glm::vec3> prevColors, colors;
+    std::unordered_map<i32, u32> index;
+  };
+
+  ///
+  /// @brief memory-bounded undo/redo history of paint strokes
+  ///
+  struct PaintHistory {
+    struct Stroke {
+      std::vector<PaintDelta> deltas;
+      size_t numBytes() const noexcept {
+        size_t ret = sizeof(Stroke);
+        for (const auto &delta : deltas) ret += delta.numBytes();
+        return ret;
+      }
+    };
+
+    /// @note discards the redo history, then the oldest strokes beyond the budget
+    void push(Stroke stroke);
+    /// @note the returned stroke stays valid until the next modification of the history
+    const Stroke *undo();
+    const Stroke *redo();
+    void clear() noexcept {
+      _undoStack.clear();
+      _redoStack.clear();
+      _numBytes = 0;
+    }
+    void setBudget(size_t numBytes);
+
+    bool canUndo() const noexcept { return !_undoStack.empty(); }
+    bool canRedo() const noexcept { return !_redoStack.empty(); }
+    size_t numBytes() const noexcept { return _numBytes; }
+    size_t budget() const noexcept { return _budget; }
+
+  protected:
+    void trim();
+
+    std::deque<Stroke> _undoStack;
+    std::vector<Stroke> _redoStack;
+    size_t _numBytes{0};
+    size_t _budget{(size_t)64 << 20};
+  };
+
+}  // namespace zs
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "SceneEditor.hpp"
 #include "zensim/execution/Atomics.hpp"
 
@@ -101,6 +105,37 @@ void main()
 }
 )";
 
+  /// @note local space triangles of the prim, whose triangulation (localTriPrims) refers to
+  /// consecutive corners (verts), each of which is associated with a point through POINT_ID_TAG.
+  /// Other layouts are reported as unavailable, leaving the query to the brute-force path.
+  static bool gather_prim_triangles(ZsPrimitive &prim, TimeCode, std::vector<glm::vec3> &positions,
+                                    std::vector<glm::uvec3> &tris) {
+    auto triPrims = prim.localTriPrims();
+    if (!triPrims) return false;
+    const auto &points = prim.points();
+    const auto &verts = prim.verts();
+    const size_t numPoints = points.size(), numVerts = verts.size();
+    const size_t numTris = triPrims->prims().size();
+    if (!numPoints || !numTris || numVerts != numTris * 3) return false;
+    if (!points.hasAttrib(ATTRIB_POS_TAG) || !verts.hasAttrib(POINT_ID_TAG)) return false;
+
+    const auto pos = points.getAttrib(ATTRIB_POS_TAG, wrapt<glm::vec3>{});
+    const auto pointIds = verts.getAttrib(POINT_ID_TAG, prim_id_c);
+    positions.resize(numPoints);
+    for (size_t i = 0; i != numPoints; ++i) positions[i] = pos[i];
+    tris.resize(numTris);
+    for (size_t i = 0; i != numTris; ++i) {
+      glm::uvec3 tri;
+      for (int d = 0; d != 3; ++d) {
+        const auto pointId = pointIds[i * 3 + d];
+        if (pointId < 0 || (size_t)pointId >= numPoints) return false;
+        tri[d] = (u32)pointId;
+      }
+      tris[i] = tri;
+    }
+    return true;
+  }
+
   void SceneEditor::setupPickResources() {
     auto &ctx = this->ctx();
     ResourceSystem::load_shader(ctx, "pick.vert", vk::ShaderStageFlagBits::eVertex,
@@ -194,6 +229,8 @@ void main()
                                        .build();
 
     rebuildPickFbos();
+
+    sceneRayQuery.triangleProvider = gather_prim_triangles;
   }
 
   void SceneEditor::rebuildPickFbos() {
@@ -387,6 +424,91 @@ void main()
 #endif
   }
 
+  ///
+  /// cpu ray queries
+  ///
+  static bool same_time_code(TimeCode a, TimeCode b) noexcept {
+    return a == b || (std::isnan(a) && std::isnan(b));
+  }
+
+  bool SceneEditor::getRayIntersectionWithPrim(const glm::vec3 &origin, const glm::vec3 &dir,
+                                               ZsPrimitive &prim, glm::vec3 *hitPt) {
+    auto &rq = sceneRayQuery;
+    if (!rq.triangleProvider) return get_ray_intersection_with_prim(origin, dir, prim, hitPt);
+
+    const auto timeCode = sceneRenderData.currentTimeCode;
+    const void *model = prim.queryVkTriMesh(ctx(), timeCode);
+    auto &entry = rq.meshes[&prim];
+    /// @note the geometry is identified by the time sample and its uploaded model
+    if (!entry.valid || entry.model != model || !same_time_code(entry.timeCode, timeCode)) {
+      std::vector<glm::vec3> positions;
+      std::vector<glm::uvec3> tris;
+      entry.valid = rq.triangleProvider(prim, timeCode, positions, tris);
+      if (entry.valid)
+        entry.bvh.assign(zs::move(positions), zs::move(tris));
+      else
+        entry.bvh.clear();
+      entry.timeCode = timeCode;
+      entry.model = model;
+    }
+    if (!entry.valid) return get_ray_intersection_with_prim(origin, dir, prim, hitPt);
+
+    /// @note the ray parameter is preserved by the (affine) transform into local space
+    const glm::mat4 invTransform = glm::inverse(prim.currentTimeVisualTransform());
+    const glm::vec3 localOrigin = glm::vec3(invTransform * glm::vec4(origin, 1.f));
+    const glm::vec3 localDir = glm::vec3(invTransform * glm::vec4(dir, 0.f));
+    float t = std::numeric_limits<float>::max();
+    if (!entry.bvh.raycast(localOrigin, localDir, t)) return false;
+    if (hitPt) *hitPt = origin + dir * t;
+    return true;
+  }
+
+  ZsPrimitive *SceneEditor::pickPrimByRay(const glm::vec3 &origin, const glm::vec3 &dir,
+                                          glm::vec3 *hitPt) {
+    auto &rq = sceneRayQuery;
+    const auto &prims = getCurrentVisiblePrims();
+    const bool primsChanged = rq.bvhPrims != prims;
+    if (primsChanged || rq.primBvhDirty) {
+      std::vector<RayQueryBvh::Box> boxes(prims.size());
+      for (size_t i = 0; i != prims.size(); ++i) {
+        auto prim = prims[i];
+        if (!prim || prim->empty()) continue;
+        const auto &aabb = prim->details().worldBoundingBox();
+        boxes[i].extend(aabb.minPos);
+        boxes[i].extend(aabb.maxPos);
+      }
+      if (primsChanged) {
+        rq.bvhPrims = prims;
+        rq.primBvh.build(boxes);
+        /// @note drop the meshes of prims no longer visible
+        for (auto it = rq.meshes.begin(); it != rq.meshes.end();)
+          if (std::find(std::begin(prims), std::end(prims), it->first) == std::end(prims))
+            it = rq.meshes.erase(it);
+          else
+            ++it;
+      } else
+        rq.primBvh.refit(boxes);
+      rq.primBvhDirty = false;
+    }
+
+    ZsPrimitive *ret = nullptr;
+    float tMax = std::numeric_limits<float>::max();
+    const float dirLength = glm::length(dir);
+    rq.primBvh.traverse(origin, dir, tMax, [&](u32 i, float &t) {
+      auto prim = rq.bvhPrims[i];
+      if (!prim || prim->empty()) return;
+      glm::vec3 pt;
+      if (!getRayIntersectionWithPrim(origin, dir, *prim, &pt)) return;
+      const float tHit = glm::length(pt - origin) / dirLength;
+      if (tHit < t) {
+        t = tHit;
+        ret = prim;
+        if (hitPt) *hitPt = pt;
+      }
+    });
+    return ret;
+  }
+
 }  // namespace zs
 
 #undef ENABLE_PROFILE
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include "SceneEditorRayQuery.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace zs {
+
+  ///
+  /// RayQueryBvh
+  ///
+  void RayQueryBvh::build(const std::vector<Box> &boxes) {
+    clear();
+    const u32 n = (u32)boxes.size();
+    if (n == 0) return;
+    _order.resize(n);
+    std::iota(std::begin(_order), std::end(_order), (u32)0);
+    std::vector<glm::vec3> centers(n);
+    for (u32 i = 0; i != n; ++i) centers[i] = boxes[i].center();
+    _nodes.reserve(2 * ((n + s_leaf_size - 1) / s_leaf_size));
+
+    struct Task {
+      u32 _first, _count;
+      u32 _parent;  // -1 for the root or a left child
+    };
+    std::vector<Task> tasks{Task{0, n, ~(u32)0}};
+    struct Bin {
+      Box _box;
+      u32 _count{0};
+    };
+    Bin bins[s_num_bins];
+    float rightCosts[s_num_bins];
+    while (!tasks.empty()) {
+      const Task task = tasks.back();
+      tasks.pop_back();
+      /// @note tasks are processed in preorder, thus a left child directly follows its parent
+      const u32 nodeIdx = (u32)_nodes.size();
+      if (task._parent != ~(u32)0) _nodes[task._parent]._offset = nodeIdx;
+      auto &node = _nodes.emplace_back();
+      Box centerBox;
+      for (u32 i = task._first; i != task._first + task._count; ++i) {
+        node._box.extend(boxes[_order[i]]);
+        centerBox.extend(centers[_order[i]]);
+      }
+      if (task._count <= s_leaf_size) {
+        node._offset = task._first;
+        node._count = task._count;
+        continue;
+      }
+      node._count = 0;
+
+      const auto extent = centerBox._max - centerBox._min;
+      const int axis = extent.x >= extent.y ? (extent.x >= extent.z ? 0 : 2)
+                                             : (extent.y >= extent.z ? 1 : 2);
+      auto first = std::begin(_order) + task._first, last = first + task._count;
+      auto mid = first + task._count / 2;
+      if (extent[axis] > 0.f) {
+        const float scale = (float)s_num_bins / extent[axis];
+        auto binIndex = [&](u32 prim) {
+          return std::min((u32)((centers[prim][axis] - centerBox._min[axis]) * scale),
+                          s_num_bins - 1);
+        };
+        for (auto &bin : bins) bin = Bin{};
+        for (auto it = first; it != last; ++it) {
+          auto &bin = bins[binIndex(*it)];
+          bin._box.extend(boxes[*it]);
+          bin._count++;
+        }
+        /// @note sweep from the right, then from the left to find the cheapest split
+        Box acc;
+        u32 cnt = 0;
+        for (u32 b = s_num_bins - 1; b != 0; --b) {
+          acc.extend(bins[b]._box);
+          cnt += bins[b]._count;
+          rightCosts[b] = cnt ? acc.halfArea() * cnt : 0.f;
+        }
+        acc = Box{};
+        cnt = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        u32 bestSplit = 0;
+        for (u32 b = 1; b != s_num_bins; ++b) {
+          acc.extend(bins[b - 1]._box);
+          cnt += bins[b - 1]._count;
+          if (cnt == 0 || cnt == task._count) continue;
+          const float cost = acc.halfArea() * cnt + rightCosts[b];
+          if (cost < bestCost) {
+            bestCost = cost;
+            bestSplit = b;
+          }
+        }
+        if (bestSplit)
+          mid = std::partition(first, last, [&](u32 p) { return binIndex(p) < bestSplit; });
+      }
+      /// @note fall back to a median split, e.g. for coincident centers
+      if (mid == first || mid == last) {
+        mid = first + task._count / 2;
+        std::nth_element(first, mid, last,
+                         [&](u32 a, u32 b) { return centers[a][axis] < centers[b][axis]; });
+      }
+      const u32 numLeft = (u32)(mid - first);
+      tasks.push_back(Task{task._first + numLeft, task._count - numLeft, nodeIdx});
+      tasks.push_back(Task{task._first, numLeft, ~(u32)0});
+    }
+  }
+
+  void RayQueryBvh::refit(const std::vector<Box> &boxes) {
+    if (boxes.size() != _order.size() || _nodes.empty()) {
+      build(boxes);
+      return;
+    }
+    /// @note children always succeed their parent
+    for (u32 i = (u32)_nodes.size(); i-- != 0;) {
+      auto &node = _nodes[i];
+      node._box = Box{};
+      if (node._count) {
+        for (u32 j = 0; j != node._count; ++j) node._box.extend(boxes[_order[node._offset + j]]);
+      } else {
+        node._box.extend(_nodes[i + 1]._box);
+        node._box.extend(_nodes[node._offset]._box);
+      }
+    }
+  }
+
+  bool RayQueryBvh::ray_box(const Box &box, const glm::vec3 &origin, const glm::vec3 &invDir,
+                            float tMax, float &tEntry) noexcept {
+    float t0 = 0.f, t1 = tMax;
+    for (int d = 0; d != 3; ++d) {
+      float tNear = (box._min[d] - origin[d]) * invDir[d];
+      float tFar = (box._max[d] - origin[d]) * invDir[d];
+      if (tNear > tFar) std::swap(tNear, tFar);
+      /// @note written such that NaNs (0 * inf) leave the interval untouched
+      t0 = tNear > t0 ? tNear : t0;
+      t1 = tFar < t1 ? tFar : t1;
+      if (t0 > t1) return false;
+    }
+    tEntry = t0;
+    return true;
+  }
+
+  bool ray_triangle_intersection(const glm::vec3 &origin, const glm::vec3 &dir, const glm::vec3 &a,
+                                 const glm::vec3 &b, const glm::vec3 &c, float &t) noexcept {
+    const glm::vec3 e1 = b - a, e2 = c - a;
+    const glm::vec3 p = glm::cross(dir, e2);
+    const float det = glm::dot(e1, p);
+    if (det == 0.f) return false;
+    const float invDet = 1.f / det;
+    const glm::vec3 s = origin - a;
+    const float u = glm::dot(s, p) * invDet;
+    if (u < 0.f || u > 1.f) return false;
+    const glm::vec3 q = glm::cross(s, e1);
+    const float v = glm::dot(dir, q) * invDet;
+    if (v < 0.f || u + v > 1.f) return false;
+    const float tHit = glm::dot(e2, q) * invDet;
+    if (!(tHit > 0.f && tHit < t)) return false;
+    t = tHit;
+    return true;
+  }
+
+  ///
+  /// TriangleMeshBvh
+  ///
+  void TriangleMeshBvh::assign(std::vector<glm::vec3> positions, std::vector<glm::uvec3> tris) {
+    const bool sameTopology = !_bvh.empty() && tris == _tris;
+    _positions = std::move(positions);
+    _tris = std::move(tris);
+    const u32 numPositions = (u32)_positions.size();
+    _boxes.resize(_tris.size());
+    for (size_t i = 0; i != _tris.size(); ++i) {
+      auto &box = _boxes[i];
+      box = RayQueryBvh::Box{};
+      const auto &tri = _tris[i];
+      /// @note triangles referring to missing points are left with empty boxes
+      if (tri[0] >= numPositions || tri[1] >= numPositions || tri[2] >= numPositions) continue;
+      for (int d = 0; d != 3; ++d) box.extend(_positions[tri[d]]);
+    }
+    if (sameTopology)
+      _bvh.refit(_boxes);
+    else
+      _bvh.build(_boxes);
+  }
+
+  void TriangleMeshBvh::clear() noexcept {
+    _positions.clear();
+    _tris.clear();
+    _boxes.clear();
+    _bvh.clear();
+  }
+
+  bool TriangleMeshBvh::intersectTriangle(u32 triIdx, const glm::vec3 &origin,
+                                          const glm::vec3 &dir, float &t) const noexcept {
+    const auto &tri = _tris[triIdx];
+    const u32 numPositions = (u32)_positions.size();
+    if (tri[0] >= numPositions || tri[1] >= numPositions || tri[2] >= numPositions) return false;
+    return ray_triangle_intersection(origin, dir, _positions[tri[0]], _positions[tri[1]],
+                                     _positions[tri[2]], t);
+  }
+
+  bool TriangleMeshBvh::raycast(const glm::vec3 &origin, const glm::vec3 &dir, float &t,
+                                u32 *triIdx) const {
+    bool hit = false;
+    _bvh.traverse(origin, dir, t, [&](u32 i, float &tMax) {
+      if (intersectTriangle(i, origin, dir, tMax)) {
+        hit = true;
+        if (triIdx) *triIdx = i;
+      }
+    });
+    return hit;
+  }
+
+  bool TriangleMeshBvh::raycastBruteForce(const glm::vec3 &origin, const glm::vec3 &dir, float &t,
+                                          u32 *triIdx) const {
+    bool hit = false;
+    for (u32 i = 0; i != (u32)_tris.size(); ++i)
+      if (intersectTriangle(i, origin, dir, t)) {
+        hit = true;
+        if (triIdx) *triIdx = i;
+      }
+    return hit;
+  }
+
+}  // namespace zs
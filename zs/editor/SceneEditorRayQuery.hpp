@@ -0,0 +1,136 @@
+#pragma once
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "zensim/TypeAlias.hpp"
+
+namespace zs {
+
+  ///
+  /// @brief bounding volume hierarchy for ray queries on the cpu
+  /// @note built top-down by splitting at the binned SAH-optimal plane. Nodes are stored in
+  /// preorder, thus the left child of an inner node directly follows it. refit() updates the
+  /// bounds bottom-up for the same number of (moved) primitives, keeping the topology.
+  ///
+  struct RayQueryBvh {
+    struct Box {
+      glm::vec3 _min{std::numeric_limits<float>::max()}, _max{-std::numeric_limits<float>::max()};
+
+      void extend(const glm::vec3 &p) noexcept {
+        _min = glm::min(_min, p);
+        _max = glm::max(_max, p);
+      }
+      void extend(const Box &o) noexcept {
+        _min = glm::min(_min, o._min);
+        _max = glm::max(_max, o._max);
+      }
+      bool valid() const noexcept {
+        return _min.x <= _max.x && _min.y <= _max.y && _min.z <= _max.z;
+      }
+      glm::vec3 center() const noexcept { return (_min + _max) * 0.5f; }
+      float halfArea() const noexcept {
+        if (!valid()) return 0.f;
+        const auto d = _max - _min;
+        return d.x * d.y + d.y * d.z + d.z * d.x;
+      }
+    };
+    struct Node {
+      Box _box;
+      u32 _offset;  // leaf: first index into _order, inner: index of the right child
+      u32 _count;   // number of primitives of a leaf, 0 for inner nodes
+    };
+    static constexpr u32 s_leaf_size = 4;
+    static constexpr u32 s_num_bins = 16;
+
+    void build(const std::vector<Box> &boxes);
+    /// @note rebuilds instead if the number of primitives differs
+    void refit(const std::vector<Box> &boxes);
+    void clear() noexcept {
+      _nodes.clear();
+      _order.clear();
+    }
+    bool empty() const noexcept { return _nodes.empty(); }
+    size_t numPrimitives() const noexcept { return _order.size(); }
+
+    /// @note slab test, [tEntry] is the parametric distance the ray enters [box] (0 if inside)
+    static bool ray_box(const Box &box, const glm::vec3 &origin, const glm::vec3 &invDir,
+                        float tMax, float &tEntry) noexcept;
+
+    /// @note visits the primitives within the boxes hit over [0, tMax] from near to far,
+    /// f(primIdx, tMax) narrows down tMax upon a closer hit, which prunes the remaining nodes
+    template <typename F>
+    void traverse(const glm::vec3 &origin, const glm::vec3 &dir, float &tMax, F &&f) const {
+      if (_nodes.empty()) return;
+      const glm::vec3 invDir = 1.f / dir;
+      float tEntry;
+      if (!ray_box(_nodes[0]._box, origin, invDir, tMax, tEntry)) return;
+      std::vector<std::pair<u32, float>> stack;
+      stack.reserve(64);
+      stack.emplace_back(0, tEntry);
+      while (!stack.empty()) {
+        const auto [nodeIdx, tNode] = stack.back();
+        stack.pop_back();
+        if (tNode > tMax) continue;
+        const auto &node = _nodes[nodeIdx];
+        if (node._count) {
+          for (u32 i = 0; i != node._count; ++i) f(_order[node._offset + i], tMax);
+          continue;
+        }
+        float tl, tr;
+        const bool hitL = ray_box(_nodes[nodeIdx + 1]._box, origin, invDir, tMax, tl);
+        const bool hitR = ray_box(_nodes[node._offset]._box, origin, invDir, tMax, tr);
+        /// @note the nearer child is visited first
+        if (hitL && hitR) {
+          if (tl <= tr) {
+            stack.emplace_back(node._offset, tr);
+            stack.emplace_back(nodeIdx + 1, tl);
+          } else {
+            stack.emplace_back(nodeIdx + 1, tl);
+            stack.emplace_back(node._offset, tr);
+          }
+        } else if (hitL)
+          stack.emplace_back(nodeIdx + 1, tl);
+        else if (hitR)
+          stack.emplace_back(node._offset, tr);
+      }
+    }
+
+    std::vector<Node> _nodes;
+    std::vector<u32> _order;  // primitive indices, leaves refer to ranges of it
+  };
+
+  /// @note Moller-Trumbore, [t] is updated if the hit is within (0, t)
+  bool ray_triangle_intersection(const glm::vec3 &origin, const glm::vec3 &dir, const glm::vec3 &a,
+                                 const glm::vec3 &b, const glm::vec3 &c, float &t) noexcept;
+
+  ///
+  /// @brief triangle mesh along with its bvh for closest-hit ray queries
+  ///
+  struct TriangleMeshBvh {
+    /// @note the bvh is refitted if the triangles are unchanged, and rebuilt otherwise
+    void assign(std::vector<glm::vec3> positions, std::vector<glm::uvec3> tris);
+    void clear() noexcept;
+
+    /// @note [t] (initialized to the max distance) is set to the closest hit
+    bool raycast(const glm::vec3 &origin, const glm::vec3 &dir, float &t,
+                 u32 *triIdx = nullptr) const;
+    /// @note tests every triangle, as a reference to raycast()
+    bool raycastBruteForce(const glm::vec3 &origin, const glm::vec3 &dir, float &t,
+                           u32 *triIdx = nullptr) const;
+
+    const std::vector<glm::vec3> &positions() const noexcept { return _positions; }
+    const std::vector<glm::uvec3> &triangles() const noexcept { return _tris; }
+
+  protected:
+    bool intersectTriangle(u32 triIdx, const glm::vec3 &origin, const glm::vec3 &dir,
+                           float &t) const noexcept;
+
+    std::vector<glm::vec3> _positions;
+    std::vector<glm::uvec3> _tris;
+    std::vector<RayQueryBvh::Box> _boxes;
+    RayQueryBvh _bvh;
+  };
+
+}  // namespace zs
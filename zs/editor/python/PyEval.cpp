@@ -10,53 +10,118 @@
 
 namespace zs {
 
-std::string python_evaluate(const std::string &script,
-                            const std::vector<std::string> &args) {
+namespace {
 
-  Py_Initialize();
+/// @note the interpreter is initialized once (unless the host already did so) and kept alive
+/// for the rest of the process, since startup dominates short evaluations. The stdout capture
+/// object is reused across evaluations.
+struct PyEvalContext {
+  PyEvalContext() {
+    if (!Py_IsInitialized()) {
+      Py_Initialize();
+      // release the GIL taken by Py_Initialize, evaluations acquire it through PyGILState
+      PyEval_SaveThread();
+    }
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    sys = PyImport_ImportModule("sys");
+    builtins = PyImport_ImportModule("builtins");
+    if (PyObject *io = PyImport_ImportModule("io")) {
+      capture = PyObject_CallMethod(io, "StringIO", NULL);
+      Py_DECREF(io);
+    }
+    if (!valid())
+      PyErr_Print();
+    PyGILState_Release(gstate);
+  }
 
-  // pass arguments
-  std::vector<wchar_t *> as;
-  for (auto &&arg : args)
-    as.push_back(Py_DecodeLocale(arg.c_str(), NULL));
+  bool valid() const noexcept { return sys && builtins && capture; }
 
-  // throw std::runtime_error(
-  //     "there exists an argument not of StringObject type!");
-  PyObject *pyargs = PyList_New(as.size());
-  for (int i = 0; i < as.size(); ++i)
-    PyList_SetItem(pyargs, i, PyUnicode_FromWideChar(as[i], wcslen(as[i])));
+  // strong references, intentionally kept until the interpreter goes down
+  PyObject *sys{nullptr}, *builtins{nullptr}, *capture{nullptr};
+};
 
-  PyObject *sys = PyImport_ImportModule("sys");
-  PyObject_SetAttrString(sys, "argv", pyargs);
+PyEvalContext &py_eval_context() {
+  static PyEvalContext ctx;
+  return ctx;
+}
 
-  Py_DECREF(pyargs);
-  for (auto a : as)
-    PyMem_Free(a);
+void py_discard_result(PyObject *obj) {
+  if (obj)
+    Py_DECREF(obj);
+  else
+    PyErr_Clear();
+}
 
-  PyRun_SimpleString(
-      "import sys\n"
-      "from io import StringIO\n"
-      "old_stdout = sys.stdout\n" // Backup the original stdout
-      "sys.stdout = StringIO()\n" // Replace stdout with a StringIO object
-                                  // to capture outputs
-  );
+} // namespace
 
-  PyRun_SimpleString(script.data());
+std::string python_evaluate(const std::string &script,
+                            const std::vector<std::string> &args) {
+  auto &ctx = py_eval_context();
+  std::string ret;
 
-  PyObject *stdOut = PyObject_GetAttrString(sys, "stdout");
-  PyObject *output = PyObject_GetAttrString(stdOut, "getvalue");
-  PyObject *result = PyObject_CallObject(output, NULL);
+  PyGILState_STATE gstate = PyGILState_Ensure();
+  if (!ctx.valid()) {
+    PyGILState_Release(gstate);
+    return ret;
+  }
+
+  // pass arguments
+  PyObject *pyargs = PyList_New(args.size());
+  for (int i = 0; i < args.size(); ++i) {
+    PyObject *arg = PyUnicode_DecodeLocale(args[i].c_str(), "surrogateescape");
+    if (!arg) {
+      PyErr_Clear();
+      arg = PyUnicode_FromString("");
+    }
+    PyList_SetItem(pyargs, i, arg);
+  }
+  PyObject_SetAttrString(ctx.sys, "argv", pyargs);
+  Py_DECREF(pyargs);
+
+  // reset the capture buffer and redirect stdout into it
+  py_discard_result(PyObject_CallMethod(ctx.capture, "seek", "i", 0));
+  py_discard_result(PyObject_CallMethod(ctx.capture, "truncate", NULL));
+  PyObject *oldStdout = PyObject_GetAttrString(ctx.sys, "stdout");
+  if (!oldStdout)
+    PyErr_Clear();
+  PyObject_SetAttrString(ctx.sys, "stdout", ctx.capture);
+
+  // every evaluation runs in a fresh namespace, imported modules are shared
+  PyObject *globals = PyDict_New();
+  PyDict_SetItemString(globals, "__builtins__", ctx.builtins);
+  if (PyObject *name = PyUnicode_FromString("__main__")) {
+    PyDict_SetItemString(globals, "__name__", name);
+    Py_DECREF(name);
+  }
+  if (PyObject *res =
+          PyRun_String(script.c_str(), Py_file_input, globals, globals))
+    Py_DECREF(res);
+  else if (PyErr_ExceptionMatches(PyExc_SystemExit))
+    // do not let the script terminate the host process
+    PyErr_Clear();
+  else
+    PyErr_Print();
+  Py_DECREF(globals);
 
   // Convert the captured output to a C++ string
-  const char *result_cstr = PyUnicode_AsUTF8(result);
+  if (PyObject *result = PyObject_CallMethod(ctx.capture, "getvalue", NULL)) {
+    Py_ssize_t len = 0;
+    if (const char *result_cstr = PyUnicode_AsUTF8AndSize(result, &len))
+      ret.assign(result_cstr, len);
+    else
+      PyErr_Clear();
+    Py_DECREF(result);
+  } else
+    PyErr_Clear();
 
   // Restore the original stdout
-  PyRun_SimpleString("sys.stdout = old_stdout");
-
-  // Finalize the Python interpreter
-  Py_Finalize();
+  if (oldStdout) {
+    PyObject_SetAttrString(ctx.sys, "stdout", oldStdout);
+    Py_DECREF(oldStdout);
+  }
 
-  return std::string(result_cstr);
+  PyGILState_Release(gstate);
+  return ret;
 }
 
-}
\ No newline at end of file
+}
@@ -4,7 +4,9 @@
 
 namespace zs {
 
+    /// @note evaluates [script] in a fresh namespace of a persistent interpreter, and returns
+    /// what it printed to stdout
     std::string python_evaluate(const std::string& script,
         const std::vector<std::string>& args);
 
-}
\ No newline at end of file
+}
@@ -1,5 +1,7 @@
 #include "AssetBrowserComponent.hpp"
 
+#include <algorithm>
+
 #include "editor/widgets/WidgetDrawUtilities.hpp"
 //
 
@@ -11,36 +13,50 @@
 
 namespace zs {
 
-  AssetBrowserComponent::AssetBrowserComponent() {
+  AssetBrowserComponent::AssetBrowserComponent() : _thumbnails{new AssetThumbnailCache()} {
     /// usd assets
     ResourceSystem::onUsdFilesOpened().connect([this](const std::vector<std::string>& fileLabels) {
-      for (auto& label : fileLabels) {
-        // fmt::print("\tadded usd file with label: {}!\n", file);
-        // _useSceneNames
-        this->appendItem(label, AssetEntry::type_e::usd_);
-      }
+      // _useSceneNames
+      this->appendItems(fileLabels, AssetEntry::type_e::usd_);
     });
     this->appendItem(g_defaultUsdLabel, AssetEntry::type_e::usd_);
 
     /// script assets
     ResourceSystem::onScriptFilesOpened().connect([this](const std::vector<std::string>& labels) {
-      for (auto& label : labels) {
-        this->appendItem(label, AssetEntry::type_e::text_);
-      }
+      this->appendItems(labels, AssetEntry::type_e::text_);
     });
     this->appendItem(g_textEditorLabel, AssetEntry::type_e::text_);
 
     /// texture assets
     ResourceSystem::onTexturesAdded().connect([this](const std::vector<std::string>& labels) {
-      for (auto& label : labels) {
-        this->appendItem(label, AssetEntry::type_e::texture_);
-      }
+      this->appendItems(labels, AssetEntry::type_e::texture_);
     });
   }
   AssetBrowserComponent::~AssetBrowserComponent() {}
 
+  void AssetBrowserComponent::compactItems() {
+    if (_numRemovedItems == 0) return;
+    _items.erase(std::remove(std::begin(_items), std::end(_items), nullptr), std::end(_items));
+    _numRemovedItems = 0;
+    /// @note the surviving entries only shift, thus update their indices in place
+    for (u32 i = 0; i != (u32)_items.size(); ++i) {
+      _itemMap.at(_items[i]->getLabel()) = i;
+      _itemIdMap.at(_items[i]->getId()) = i;
+    }
+  }
+
+  void AssetBrowserComponent::rebuildItemIndex() {
+    _itemMap.clear();
+    _itemIdMap.clear();
+    for (u32 i = 0; i != (u32)_items.size(); ++i) {
+      _itemMap.emplace(_items[i]->getLabel(), i);
+      _itemIdMap.emplace(_items[i]->getId(), i);
+    }
+  }
+
   void AssetBrowserComponent::paint() {
     // std::lock_guard lk{_mutex};
+    compactItems();
     ImGui::SetNextWindowSize(ImVec2(IconSize * 25, IconSize * 15), ImGuiCond_FirstUseEver);
 
     ImGuiIO& io = ImGui::GetIO();
@@ -157,6 +173,7 @@ namespace zs {
                   tip = item_data->getLabel();
                   break;
                 case AssetEntry::texture_:
+                case AssetEntry::mesh_:
                   tip = item_data->getLabel();
                   break;
               }
@@ -214,14 +231,27 @@ namespace zs {
                     ImVec2(box_max.x - 2 - icon_type_overlay_size.x, box_min.y + 2),
                     ImVec2(box_max.x - 2, box_min.y + 2 + icon_type_overlay_size.y), type_col);
               }
-              const char* label = item_data->getDisplayLabel();
-              auto sz = ImGui::CalcTextSize(label);
               auto box_center = (box_min + box_max) / 2;
-              // if (display_label)
-              ImU32 label_col
-                  = ImGui::GetColorU32(item_is_selected ? ImGuiCol_Text : ImGuiCol_TextDisabled);
-              draw_list->AddText(ImVec2(box_center.x - sz.x / 2, box_center.y - sz.y / 2),
-                                 label_col, label);
+              AssetThumbnailCache::View thumbnail;
+              if (_thumbnails->request(item_data->getId(), item_data->getType(),
+                                       item_data->getLabel(), thumbnail)) {
+                // fit the thumbnail into the item box
+                const float scale = std::min(LayoutItemSize.x / thumbnail._size.x,
+                                             LayoutItemSize.y / thumbnail._size.y);
+                const ImVec2 half_extent = thumbnail._size * (scale * 0.5f);
+                draw_list->AddImage(
+                    thumbnail._texId, box_center - half_extent, box_center + half_extent,
+                    thumbnail._uv0, thumbnail._uv1,
+                    item_is_selected ? IM_COL32_WHITE : IM_COL32(200, 200, 200, 255));
+              } else {
+                const char* label = item_data->getDisplayLabel();
+                auto sz = ImGui::CalcTextSize(label);
+                // if (display_label)
+                ImU32 label_col = ImGui::GetColorU32(item_is_selected ? ImGuiCol_Text
+                                                                      : ImGuiCol_TextDisabled);
+                draw_list->AddText(ImVec2(box_center.x - sz.x / 2, box_center.y - sz.y / 2),
+                                   label_col, label);
+              }
             }
 
             ImGui::PopID();
@@ -229,6 +259,8 @@ namespace zs {
         }
       }
       clipper.End();
+      // thumbnails not requested within the clipper range are cancelled
+      _thumbnails->update();
       ImGui::SetWindowFontScale(1.f);
       ImGui::PopStyleColor(3);
       ImGui::PopStyleVar(2);  // ImGuiStyleVar_ItemSpacing
@@ -243,7 +275,10 @@ namespace zs {
 
       ms_io = ImGui::EndMultiSelect();
       _selection.ApplyRequests(ms_io);
-      if (want_delete) _selection.ApplyDeletionPostLoop(ms_io, _items, item_curr_idx_to_focus);
+      if (want_delete) {
+        _selection.ApplyDeletionPostLoop(ms_io, _items, item_curr_idx_to_focus);
+        rebuildItemIndex();
+      }
 
       // Zooming with CTRL+Wheel
       if (ImGui::IsWindowAppearing()) ZoomWheelAccum = 0.0f;
@@ -1,16 +1,25 @@
 #pragma once
 
+#include <array>
+#include <condition_variable>
 #include <deque>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "WidgetComponent.hpp"
 #include "imgui.h"
 #include "imgui_internal.h"
+#include "zensim/ZpcFunction.hpp"
 #include "zensim/ZpcResource.hpp"
 #include "zensim/execution/Concurrency.h"
 #include "zensim/execution/ConcurrencyPrimitive.hpp"
 #include "zensim/types/ImplPattern.hpp"
 #include "zensim/ui/Widget.hpp"
+#include "zensim/vulkan/VkTexture.hpp"
+#include "zensim/vulkan/Vulkan.hpp"
 #include "zensim/zpc_tpls/fmt/core.h"
 
 namespace zs {
@@ -18,12 +27,105 @@ namespace zs {
   struct DefaultImGuiSelection : ImGuiSelectionBasicStorage {
     inline int ApplyDeletionPreLoop(ImGuiMultiSelectIO *ms_io, int items_count);
     template <typename ITEM_TYPE> void ApplyDeletionPostLoop(ImGuiMultiSelectIO *ms_io,
-                                                             std::deque<ITEM_TYPE> &items,
+                                                             std::vector<ITEM_TYPE> &items,
                                                              int item_curr_idx_to_select);
   };
 
+  ///
+  /// @brief previews of the assets displayed in the browser
+  /// @note thumbnails are decoded and downscaled on worker threads, then uploaded through the
+  /// transfer queue into the slots of a fixed-size atlas, where the least recently displayed ones
+  /// are recycled. Only the thumbnails requested during the current frame stay scheduled, the
+  /// others (e.g. scrolled out of view) are cancelled in update().
+  ///
+  struct AssetThumbnailCache {
+    static constexpr u32 s_thumbnail_size = 128;  // in pixels
+    static constexpr u32 s_atlas_dim = 16;        // slots per atlas row/ column
+    static constexpr u32 s_max_uploads_per_frame = 16;
+    /// a slot is only recycled if not displayed within this many frames
+    static constexpr u32 s_frames_in_flight = 3;
+
+    struct Image {
+      std::vector<u8> _pixels;  // rgba8
+      u32 _width{0}, _height{0};
+    };
+    /// @note invoked on worker threads, [image] should fit within [size] x [size]
+    using Decoder = zs::function<bool(std::string_view source, u32 size, Image &image)>;
+    struct View {
+      ImTextureID _texId;
+      ImVec2 _uv0, _uv1;
+      ImVec2 _size;  // in pixels
+    };
+
+    AssetThumbnailCache(u32 numWorkers = 2);
+    ~AssetThumbnailCache();
+    AssetThumbnailCache(const AssetThumbnailCache &) = delete;
+    AssetThumbnailCache &operator=(const AssetThumbnailCache &) = delete;
+
+    /// @note textures and meshes are decoded from their files by default. The usd stages are
+    /// owned by the world side, which is expected to install the decoder of usd_ assets (e.g.
+    /// gathering the triangles of a stage for render_mesh)
+    void setDecoder(AssetEntry::type_e type, Decoder decoder);
+    /// @note shades [tris] as seen from an oblique view, fitted into [size] x [size] over a
+    /// transparent background, for the decoders of mesh-like assets
+    static bool render_mesh(const std::vector<std::array<float, 3>> &points,
+                            const std::vector<std::array<u32, 3>> &tris, u32 size, Image &image);
+    /// @note returns true if the thumbnail is resident, otherwise schedules its decoding
+    bool request(ImGuiID key, AssetEntry::type_e type, std::string_view source, View &view);
+    /// @note call once per frame after all the requests
+    void update();
+    void invalidate(ImGuiID key);
+    void clear();
+
+  protected:
+    struct Entry {
+      enum state_e : u8 { queued = 0, decoding, decoded, uploading, resident, failed };
+      AssetEntry::type_e _type;
+      std::string _source;
+      state_e _state{queued};
+      bool _cancelled{false};
+      u64 _lastRequested{0};
+      i32 _slot{-1};
+      Image _image;
+    };
+    struct Slot {
+      ImGuiID _key{0};
+      bool _occupied{false};
+      u64 _lastUsed{0};
+    };
+
+    void workerLoop();
+    /// @note returns -1 if every slot is still in use
+    i32 acquireSlot();
+    void releaseSlot(i32 slot);
+    bool prepareAtlas();
+    void finishUploads();
+    void issueUploads();
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _terminate{false};
+    std::map<AssetEntry::type_e, Decoder> _decoders;
+    std::unordered_map<ImGuiID, Entry> _entries;
+    std::deque<ImGuiID> _queue;     // keys to decode, the latest requested ones first
+    std::vector<ImGuiID> _decoded;  // keys awaiting upload
+    u64 _frame{1};
+
+    /// atlas (accessed on the ui thread only)
+    std::vector<Slot> _slots;
+    std::vector<std::pair<ImGuiID, i32>> _uploading;  // (key, slot) of the submitted uploads
+    VulkanContext *_ctx{nullptr};
+    VkTexture _atlas;
+    vk::DescriptorSet _atlasSet;
+    Owner<Buffer> _staging;
+    Owner<Fence> _fence;
+    Owner<VkCommand> _cmd;
+    bool _atlasInitialized{false}, _atlasFailed{false};
+  };
+
   struct AssetBrowserComponent : WidgetConcept {
-    using AssetEntries = std::deque<UniquePtr<AssetEntry>>;
+    using AssetEntries = std::vector<UniquePtr<AssetEntry>>;
     using AssetPtr = AssetEntry *;
 
     AssetBrowserComponent();
@@ -34,45 +136,60 @@ namespace zs {
     void paint() override;
 
     /// asset entry maintenance
+    /// @note a removed entry only leaves a hole in _items, and the holes are compacted at once
+    /// before the next paint, thus bulk additions/ removals stay linear overall
     AssetPtr appendItem(const std::string &tag, AssetEntry::type_e type) {
+      // std::lock_guard lk{_mutex};
+      if (_itemMap.find(tag) != _itemMap.end()) return nullptr;
       UniquePtr<AssetEntry> entry{new AssetEntry(tag, nextItemId(), type)};
-      {
-        // std::lock_guard lk{_mutex};
-        auto [iter, success] = _itemMap.emplace(tag, entry.get());
-        if (success) {
-          _itemIdMap[entry->getId()] = entry.get();
-          _items.emplace_back(zs::move(entry));
-          return iter->second;
-        }
-      }
-      return nullptr;
+      const u32 idx = (u32)_items.size();
+      /// @note the key views the tag of the (heap allocated) entry itself
+      _itemMap.emplace(entry->getLabel(), idx);
+      _itemIdMap.emplace(entry->getId(), idx);
+      return _items.emplace_back(zs::move(entry)).get();
     }
-    bool delItem(const std::string &tag) {
-      if (auto mit = _itemMap.find(tag); mit != _itemMap.end()) {
-        for (auto it = _items.begin(); it != _items.end(); ++it) {
-          if ((*it).get() == mit->second) {
-            _items.erase(it);
-            _itemMap.erase(mit);
-            _itemIdMap.erase(mit->second->getId());
-            return true;
-          }
-        }
-      }
-      return false;
+    void appendItems(const std::vector<std::string> &tags, AssetEntry::type_e type) {
+      _items.reserve(_items.size() + tags.size());
+      _itemMap.reserve(_itemMap.size() + tags.size());
+      _itemIdMap.reserve(_itemIdMap.size() + tags.size());
+      for (const auto &tag : tags) appendItem(tag, type);
+    }
+    bool delItem(std::string_view tag) {
+      auto mit = _itemMap.find(tag);
+      if (mit == _itemMap.end()) return false;
+      auto &entry = _items[mit->second];
+      const ImGuiID id = entry->getId();
+      _thumbnails->invalidate(id);
+      _selection.SetItemSelected(id, false);
+      _itemIdMap.erase(id);
+      _itemMap.erase(mit);
+      entry.reset();
+      _numRemovedItems++;
+      return true;
+    }
+    /// @note returns the number of removed entries
+    size_t delItems(const std::vector<std::string> &tags) {
+      size_t n = 0;
+      for (const auto &tag : tags) n += delItem(tag);
+      return n;
     }
     void clearItems() {
+      _thumbnails->clear();
+      _selection.Clear();
       _items.clear();
       _itemMap.clear();
       _itemIdMap.clear();
+      _numRemovedItems = 0;
     }
-    AssetPtr getItem(const std::string &tag) {
-      if (auto it = _itemMap.find(tag); it != _itemMap.end()) return it->second;
+    AssetPtr getItem(std::string_view tag) {
+      if (auto it = _itemMap.find(tag); it != _itemMap.end()) return _items[it->second].get();
       return nullptr;
     }
     AssetPtr getItem(ImGuiID id) {
-      if (auto it = _itemIdMap.find(id); it != _itemIdMap.end()) return it->second;
+      if (auto it = _itemIdMap.find(id); it != _itemIdMap.end()) return _items[it->second].get();
       return nullptr;
     }
+    size_t numItems() const noexcept { return _items.size() - _numRemovedItems; }
 
     /// gui draw helper
     void updateLayoutSizes(float avail_width);
@@ -80,11 +197,18 @@ namespace zs {
     ImGuiID nextItemId() { return NextItemId++; }
 
   protected:
+    /// @note drop the holes left by the removed entries
+    void compactItems();
+    /// @note _items (without holes) -> _itemMap/ _itemIdMap
+    void rebuildItemIndex();
+
     // Mutex _mutex;
     AssetEntries _items;
     DefaultImGuiSelection _selection;
-    std::map<std::string, AssetPtr> _itemMap;
-    std::map<ImGuiID, AssetPtr> _itemIdMap;
+    std::unordered_map<std::string_view, u32> _itemMap;  // label -> index into _items
+    std::unordered_map<ImGuiID, u32> _itemIdMap;
+    size_t _numRemovedItems = 0;
+    UniquePtr<AssetThumbnailCache> _thumbnails;
 
     // ImGuiTextFilter _filter;
     // std::vector<std::string_view> _filteredItems;
@@ -162,16 +286,17 @@ namespace zs {
   // nor to selection data.
   template <typename ITEM_TYPE>
   void DefaultImGuiSelection::ApplyDeletionPostLoop(ImGuiMultiSelectIO *ms_io,
-                                                    std::deque<ITEM_TYPE> &items,
+                                                    std::vector<ITEM_TYPE> &items,
                                                     int item_curr_idx_to_select) {
     // Rewrite item list (delete items) + convert old selection index (before deletion) to new
     // selection index (after selection). If NavId was not part of selection, we will stay on same
     // item.
-    std::deque<ITEM_TYPE> new_items;
-    // new_items.reserve(items.size() - Size);
+    std::vector<ITEM_TYPE> new_items;
+    new_items.reserve(items.size());
     int item_next_idx_to_select = -1;
     for (int idx = 0; idx < items.size(); idx++) {
       auto &item = items[idx];
+      if (!item) continue;  // removed meanwhile
       if (!Contains(GetStorageIdFromIndex(idx)))
         new_items.push_back(zs::move(items[idx]));
       else {
@@ -181,6 +306,10 @@ namespace zs {
             break;
           case AssetEntry::type_e::text_:
             close_script_asset(std::string(item->getLabel()));
+            break;
+          case AssetEntry::type_e::mesh_:
+            /// @note nothing is loaded besides the thumbnail
+            break;
           default:
             throw std::runtime_error("unknown type of the closed assets.");
         }
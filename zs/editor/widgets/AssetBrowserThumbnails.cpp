@@ -0,0 +1,441 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "AssetBrowserComponent.hpp"
+#include "world/system/ResourceSystem.hpp"
+#include "zensim/io/MeshIO.hpp"
+#include "zensim/zpc_tpls/stb/stb_image.h"
+
+namespace zs {
+
+  /// @note box filtering, the result keeps the aspect ratio and fits within [size] x [size]
+  static void downscale_rgba8(const u8 *src, u32 w, u32 h, u32 size,
+                              AssetThumbnailCache::Image &image) {
+    const float scale = std::min(1.f, (float)size / (float)std::max(w, h));
+    image._width = std::max((u32)(w * scale), (u32)1);
+    image._height = std::max((u32)(h * scale), (u32)1);
+    image._pixels.resize((size_t)image._width * image._height * 4);
+    for (u32 y = 0; y != image._height; ++y) {
+      const u32 y0 = (u32)((u64)y * h / image._height);
+      const u32 y1 = std::max((u32)((u64)(y + 1) * h / image._height), y0 + 1);
+      for (u32 x = 0; x != image._width; ++x) {
+        const u32 x0 = (u32)((u64)x * w / image._width);
+        const u32 x1 = std::max((u32)((u64)(x + 1) * w / image._width), x0 + 1);
+        u32 sum[4] = {0, 0, 0, 0};
+        for (u32 sy = y0; sy != y1; ++sy)
+          for (u32 sx = x0; sx != x1; ++sx)
+            for (int c = 0; c != 4; ++c) sum[c] += src[((size_t)sy * w + sx) * 4 + c];
+        const u32 n = (y1 - y0) * (x1 - x0);
+        u8 *dst = &image._pixels[((size_t)y * image._width + x) * 4];
+        for (int c = 0; c != 4; ++c) dst[c] = (u8)(sum[c] / n);
+      }
+    }
+  }
+
+  static bool decode_texture_thumbnail(std::string_view source, u32 size,
+                                       AssetThumbnailCache::Image &image) {
+    int w, h, numChannels;
+    u8 *pixels = stbi_load(std::string{source}.c_str(), &w, &h, &numChannels, 4);
+    if (!pixels) return false;
+    downscale_rgba8(pixels, (u32)w, (u32)h, size, image);
+    stbi_image_free(pixels);
+    return true;
+  }
+
+  static bool decode_mesh_thumbnail(std::string_view source, u32 size,
+                                    AssetThumbnailCache::Image &image) {
+    Mesh<float, 3, u32, 3> mesh;
+    if (!read_tri_mesh_obj(std::string{source}, mesh)) return false;
+    std::vector<std::array<float, 3>> points(mesh.nodes.size());
+    for (size_t i = 0; i != points.size(); ++i)
+      points[i] = {mesh.nodes[i][0], mesh.nodes[i][1], mesh.nodes[i][2]};
+    std::vector<std::array<u32, 3>> tris(mesh.elems.size());
+    for (size_t i = 0; i != tris.size(); ++i)
+      tris[i] = {mesh.elems[i][0], mesh.elems[i][1], mesh.elems[i][2]};
+    return AssetThumbnailCache::render_mesh(points, tris, size, image);
+  }
+
+  bool AssetThumbnailCache::render_mesh(const std::vector<std::array<float, 3>> &points,
+                                        const std::vector<std::array<u32, 3>> &tris, u32 size,
+                                        Image &image) {
+    if (points.empty() || tris.empty() || size == 0) return false;
+    /// @note rotated by 30 degrees around y, then tilted by 20 degrees around x, looking down -z
+    constexpr float cosY = 0.8660254f, sinY = 0.5f, cosX = 0.9396926f, sinX = 0.3420201f;
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    std::vector<std::array<float, 3>> viewed(points.size());
+    float lo[2] = {inf, inf}, hi[2] = {-inf, -inf};
+    for (size_t i = 0; i != points.size(); ++i) {
+      const auto &p = points[i];
+      const float x = cosY * p[0] + sinY * p[2], z = -sinY * p[0] + cosY * p[2];
+      viewed[i] = {x, cosX * p[1] - sinX * z, sinX * p[1] + cosX * z};
+      for (int d = 0; d != 2; ++d) {
+        lo[d] = std::min(lo[d], viewed[i][d]);
+        hi[d] = std::max(hi[d], viewed[i][d]);
+      }
+    }
+    const float extent = std::max(hi[0] - lo[0], hi[1] - lo[1]);
+    /// @note also rejects non-finite coordinates
+    if (!(extent > 0.f) || !std::isfinite(extent)) return false;
+    const float scale = (float)size / extent;
+    image._width = std::clamp((u32)std::ceil((hi[0] - lo[0]) * scale), (u32)1, size);
+    image._height = std::clamp((u32)std::ceil((hi[1] - lo[1]) * scale), (u32)1, size);
+    const u32 w = image._width, h = image._height;
+    image._pixels.assign((size_t)w * h * 4, 0);
+    std::vector<float> depth((size_t)w * h, -inf);
+
+    for (const auto &tri : tris) {
+      if (tri[0] >= points.size() || tri[1] >= points.size() || tri[2] >= points.size()) continue;
+      float px[3], py[3], pz[3];
+      for (int k = 0; k != 3; ++k) {
+        const auto &v = viewed[tri[k]];
+        px[k] = (v[0] - lo[0]) * scale;
+        py[k] = (hi[1] - v[1]) * scale;
+        pz[k] = v[2];
+      }
+      const float area = (px[1] - px[0]) * (py[2] - py[0]) - (px[2] - px[0]) * (py[1] - py[0]);
+      if (area == 0.f) continue;
+      /// @note two-sided lambertian shading, lit from the viewer
+      const float e0[3] = {viewed[tri[1]][0] - viewed[tri[0]][0],
+                           viewed[tri[1]][1] - viewed[tri[0]][1],
+                           viewed[tri[1]][2] - viewed[tri[0]][2]};
+      const float e1[3] = {viewed[tri[2]][0] - viewed[tri[0]][0],
+                           viewed[tri[2]][1] - viewed[tri[0]][1],
+                           viewed[tri[2]][2] - viewed[tri[0]][2]};
+      const float n[3] = {e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2],
+                          e0[0] * e1[1] - e0[1] * e1[0]};
+      const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      const float shade = 0.25f + 0.75f * (len > 0.f ? std::abs(n[2]) / len : 0.f);
+      const u8 rgb[3] = {(u8)(200 * shade), (u8)(205 * shade), (u8)(215 * shade)};
+
+      const u32 x0 = (u32)std::clamp(std::floor(std::min({px[0], px[1], px[2]})), 0.f, (float)w);
+      const u32 x1 = (u32)std::clamp(std::ceil(std::max({px[0], px[1], px[2]})), 0.f, (float)w);
+      const u32 y0 = (u32)std::clamp(std::floor(std::min({py[0], py[1], py[2]})), 0.f, (float)h);
+      const u32 y1 = (u32)std::clamp(std::ceil(std::max({py[0], py[1], py[2]})), 0.f, (float)h);
+      for (u32 y = y0; y < y1; ++y)
+        for (u32 x = x0; x < x1; ++x) {
+          /// @note barycentric coordinates of the pixel center
+          const float qx = x + 0.5f, qy = y + 0.5f;
+          const float b0 = ((px[1] - qx) * (py[2] - qy) - (px[2] - qx) * (py[1] - qy)) / area;
+          const float b1 = ((px[2] - qx) * (py[0] - qy) - (px[0] - qx) * (py[2] - qy)) / area;
+          const float b2 = 1.f - b0 - b1;
+          if (b0 < 0.f || b1 < 0.f || b2 < 0.f) continue;
+          const float z = b0 * pz[0] + b1 * pz[1] + b2 * pz[2];
+          const size_t idx = (size_t)y * w + x;
+          if (z <= depth[idx]) continue;
+          depth[idx] = z;
+          u8 *dst = &image._pixels[idx * 4];
+          dst[0] = rgb[0];
+          dst[1] = rgb[1];
+          dst[2] = rgb[2];
+          dst[3] = 255;
+        }
+    }
+    return true;
+  }
+
+  AssetThumbnailCache::AssetThumbnailCache(u32 numWorkers) : _slots(s_atlas_dim * s_atlas_dim) {
+    _decoders[AssetEntry::texture_] = decode_texture_thumbnail;
+    _decoders[AssetEntry::mesh_] = decode_mesh_thumbnail;
+    for (u32 i = 0; i != std::max(numWorkers, (u32)1); ++i)
+      _workers.emplace_back([this]() { workerLoop(); });
+  }
+  AssetThumbnailCache::~AssetThumbnailCache() {
+    {
+      std::lock_guard lk{_mutex};
+      _terminate = true;
+    }
+    _cv.notify_all();
+    for (auto &worker : _workers) worker.join();
+    if (!_uploading.empty()) _fence.get().wait();
+  }
+
+  void AssetThumbnailCache::setDecoder(AssetEntry::type_e type, Decoder decoder) {
+    std::lock_guard lk{_mutex};
+    _decoders[type] = zs::move(decoder);
+    /// @note retry the assets of this type that had failed or been skipped
+    for (auto it = _entries.begin(); it != _entries.end();)
+      if (it->second._type == type && it->second._state == Entry::failed)
+        it = _entries.erase(it);
+      else
+        ++it;
+  }
+
+  bool AssetThumbnailCache::request(ImGuiID key, AssetEntry::type_e type, std::string_view source,
+                                    View &view) {
+    std::unique_lock lk{_mutex};
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+      if (_atlasFailed || _decoders.find(type) == _decoders.end()) return false;
+      auto &entry = _entries[key];
+      entry._type = type;
+      entry._source = source;
+      entry._lastRequested = _frame;
+      _queue.push_front(key);
+      lk.unlock();
+      _cv.notify_one();
+      return false;
+    }
+    auto &entry = it->second;
+    entry._lastRequested = _frame;
+    /// @note requested again before being cancelled
+    entry._cancelled = false;
+    if (entry._state != Entry::resident) return false;
+
+    auto &slot = _slots[entry._slot];
+    slot._lastUsed = _frame;
+    constexpr float atlasSize = (float)(s_thumbnail_size * s_atlas_dim);
+    const ImVec2 uv0{(float)(entry._slot % s_atlas_dim * s_thumbnail_size) / atlasSize,
+                     (float)(entry._slot / s_atlas_dim * s_thumbnail_size) / atlasSize};
+    view._texId = (ImTextureID)(&_atlasSet);
+    view._uv0 = uv0;
+    view._uv1 = ImVec2{uv0.x + entry._image._width / atlasSize,
+                       uv0.y + entry._image._height / atlasSize};
+    view._size = ImVec2{(float)entry._image._width, (float)entry._image._height};
+    return true;
+  }
+
+  void AssetThumbnailCache::workerLoop() {
+    for (;;) {
+      ImGuiID key;
+      AssetEntry::type_e type;
+      std::string source;
+      Decoder decoder;
+      {
+        std::unique_lock lk{_mutex};
+        _cv.wait(lk, [this]() { return _terminate || !_queue.empty(); });
+        if (_terminate) return;
+        key = _queue.front();
+        _queue.pop_front();
+        auto it = _entries.find(key);
+        /// @note cancelled (or invalidated) meanwhile
+        if (it == _entries.end() || it->second._state != Entry::queued) continue;
+        it->second._state = Entry::decoding;
+        type = it->second._type;
+        source = it->second._source;
+        decoder = _decoders.at(type);
+      }
+
+      Image image;
+      bool succeeded = false;
+      try {
+        succeeded = decoder && decoder(source, s_thumbnail_size, image);
+      } catch (...) {
+        succeeded = false;
+      }
+      succeeded = succeeded && image._width && image._height && image._width <= s_thumbnail_size
+                  && image._height <= s_thumbnail_size
+                  && image._pixels.size() == (size_t)image._width * image._height * 4;
+
+      std::lock_guard lk{_mutex};
+      auto it = _entries.find(key);
+      if (it == _entries.end() || it->second._state != Entry::decoding) continue;
+      auto &entry = it->second;
+      if (entry._cancelled) {
+        _entries.erase(it);
+        continue;
+      }
+      if (succeeded) {
+        entry._image = zs::move(image);
+        entry._state = Entry::decoded;
+        _decoded.push_back(key);
+      } else
+        entry._state = Entry::failed;
+    }
+  }
+
+  void AssetThumbnailCache::update() {
+    finishUploads();
+    {
+      std::lock_guard lk{_mutex};
+      /// @note cancel whatever is not requested this frame, except for the resident thumbnails
+      /// (kept until their slots are recycled) and the ones being uploaded
+      for (auto it = _entries.begin(); it != _entries.end();) {
+        auto &entry = it->second;
+        if (entry._lastRequested == _frame) {
+          ++it;
+          continue;
+        }
+        if (entry._state == Entry::queued || entry._state == Entry::decoded) {
+          it = _entries.erase(it);
+          continue;
+        }
+        if (entry._state == Entry::decoding) entry._cancelled = true;
+        ++it;
+      }
+      _queue.erase(std::remove_if(std::begin(_queue), std::end(_queue),
+                                  [this](ImGuiID key) { return !_entries.count(key); }),
+                   std::end(_queue));
+      _decoded.erase(std::remove_if(std::begin(_decoded), std::end(_decoded),
+                                    [this](ImGuiID key) {
+                                      auto it = _entries.find(key);
+                                      return it == _entries.end()
+                                             || it->second._state != Entry::decoded;
+                                    }),
+                     std::end(_decoded));
+    }
+    issueUploads();
+    _frame++;
+  }
+
+  void AssetThumbnailCache::invalidate(ImGuiID key) {
+    std::lock_guard lk{_mutex};
+    auto it = _entries.find(key);
+    if (it == _entries.end()) return;
+    /// @note an upload in flight releases its slot upon completion
+    if (it->second._state == Entry::resident) releaseSlot(it->second._slot);
+    _entries.erase(it);
+  }
+
+  void AssetThumbnailCache::clear() {
+    std::lock_guard lk{_mutex};
+    for (auto &[key, entry] : _entries)
+      if (entry._state == Entry::resident) releaseSlot(entry._slot);
+    _entries.clear();
+    _queue.clear();
+    _decoded.clear();
+  }
+
+  i32 AssetThumbnailCache::acquireSlot() {
+    i32 lru = -1;
+    for (i32 i = 0; i != (i32)_slots.size(); ++i) {
+      const auto &slot = _slots[i];
+      if (!slot._occupied) return i;
+      if (slot._lastUsed + s_frames_in_flight < _frame
+          && (lru == -1 || slot._lastUsed < _slots[lru]._lastUsed))
+        lru = i;
+    }
+    if (lru != -1) {
+      /// @note the evicted thumbnail is decoded again once requested
+      _entries.erase(_slots[lru]._key);
+      releaseSlot(lru);
+    }
+    return lru;
+  }
+
+  void AssetThumbnailCache::releaseSlot(i32 slot) {
+    _slots[slot]._occupied = false;
+    _slots[slot]._key = 0;
+  }
+
+  bool AssetThumbnailCache::prepareAtlas() {
+    if (_atlasInitialized) return true;
+    if (_atlasFailed) return false;
+    try {
+      _ctx = &Vulkan::context(0);
+      auto &ctx = *_ctx;
+      const u32 atlasSize = s_thumbnail_size * s_atlas_dim;
+      std::vector<u8> zeros((size_t)atlasSize * atlasSize * 4, 0);
+      _atlas = load_texture(ctx, zeros.data(), zeros.size(), vk::Extent2D{atlasSize, atlasSize},
+                            vk::Format::eR8G8B8A8Unorm);
+
+      /// @note the atlas stays in the general layout, thus slots are updated while others are
+      /// being sampled
+      ctx.acquireSet(ResourceSystem::get_shader("imgui.frag").layout(0), _atlasSet);
+      vk::DescriptorImageInfo imageInfo{};
+      imageInfo.sampler = _atlas.sampler;
+      imageInfo.imageView = _atlas.image.get();
+      imageInfo.imageLayout = vk::ImageLayout::eGeneral;
+      ctx.writeDescriptorSet(imageInfo, _atlasSet, vk::DescriptorType::eCombinedImageSampler, 0);
+
+      _staging = ctx.createStagingBuffer(
+          (size_t)s_max_uploads_per_frame * s_thumbnail_size * s_thumbnail_size * 4,
+          vk::BufferUsageFlagBits::eTransferSrc);
+      const auto queueType = ctx.isQueueValid(zs::vk_queue_e::dedicated_transfer)
+                                 ? zs::vk_queue_e::dedicated_transfer
+                                 : zs::vk_queue_e::transfer;
+      _cmd = ctx.createCommandBuffer(vk_cmd_usage_e::reset, queueType, false);
+      _fence = Fence(ctx, true);
+    } catch (const std::exception &e) {
+      fmt::print("failed to set up the asset thumbnail atlas: {}\n", e.what());
+      _atlasFailed = true;
+      return false;
+    }
+    return true;
+  }
+
+  void AssetThumbnailCache::finishUploads() {
+    if (_uploading.empty()) return;
+    if (_ctx->device.getFenceStatus((vk::Fence)_fence.get(), _ctx->dispatcher)
+        != vk::Result::eSuccess)
+      return;
+    _atlasInitialized = true;
+    std::lock_guard lk{_mutex};
+    for (auto [key, slot] : _uploading) {
+      auto it = _entries.find(key);
+      /// @note invalidated during the upload
+      if (it == _entries.end() || it->second._state != Entry::uploading) {
+        releaseSlot(slot);
+        continue;
+      }
+      it->second._state = Entry::resident;
+      it->second._image._pixels = {};
+    }
+    _uploading.clear();
+  }
+
+  void AssetThumbnailCache::issueUploads() {
+    /// @note the staging buffer is reused, thus wait for the previous batch
+    if (!_uploading.empty()) return;
+    {
+      std::lock_guard lk{_mutex};
+      if (_decoded.empty()) return;
+    }
+    if (!prepareAtlas()) return;
+
+    auto &ctx = *_ctx;
+    std::vector<vk::BufferImageCopy> regions;
+    const size_t slotBytes = (size_t)s_thumbnail_size * s_thumbnail_size * 4;
+    auto &staging = _staging.get();
+    staging.map();
+    {
+      std::lock_guard lk{_mutex};
+      /// @note the latest decoded first, as they are the most likely to be on screen
+      while (!_decoded.empty() && regions.size() < s_max_uploads_per_frame) {
+        const ImGuiID key = _decoded.back();
+        auto &entry = _entries.at(key);
+        const i32 slot = acquireSlot();
+        if (slot == -1) break;
+        _decoded.pop_back();
+        _slots[slot] = Slot{key, true, _frame};
+        entry._slot = slot;
+        entry._state = Entry::uploading;
+        _uploading.emplace_back(key, slot);
+
+        const size_t offset = regions.size() * slotBytes;
+        std::memcpy((u8 *)staging.mappedAddress() + offset, entry._image._pixels.data(),
+                    entry._image._pixels.size());
+        vk::BufferImageCopy region{};
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = vk::Offset3D{(i32)(slot % s_atlas_dim * s_thumbnail_size),
+                                          (i32)(slot / s_atlas_dim * s_thumbnail_size), 0};
+        region.imageExtent = vk::Extent3D{entry._image._width, entry._image._height, 1};
+        regions.push_back(region);
+      }
+    }
+    staging.unmap();
+    staging.flush();
+    if (regions.empty()) return;
+
+    auto &cmd = _cmd.get();
+    cmd.begin();
+    if (!_atlasInitialized) {
+      auto barrier = image_layout_transition_barrier(
+          _atlas.image.get(), vk::ImageAspectFlagBits::eColor,
+          vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eGeneral,
+          vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer);
+      (*cmd).pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                             vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {}, {},
+                             {barrier}, ctx.dispatcher);
+    }
+    (*cmd).copyBufferToImage(staging, _atlas.image.get(), vk::ImageLayout::eGeneral, regions,
+                             ctx.dispatcher);
+    cmd.end();
+    cmd.submit(_fence.get(), /*reset fence*/ true, /*reset config*/ true);
+  }
+
+}  // namespace zs
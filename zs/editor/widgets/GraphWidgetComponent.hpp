@@ -1,4 +1,5 @@
 #pragma once
+#include <deque>
 #include <filesystem>
 #include <json.hpp>
 #include <list>
@@ -8,6 +9,7 @@
 #include <string>
 
 #include "editor/ImguiSystem.hpp"
+#include "editor/widgets/GraphWidgetHistory.hpp"
 #include "editor/widgets/ResourceWidgetComponent.hpp"
 #include "imgui.h"
 #include "imgui_node_editor.h"
@@ -98,7 +100,10 @@ namespace zs {
       Pin *_parent;
 
       ZsVar _contents;
+      ZsVar _contentAux;  // candidates (if any) the content widget is built with
       zs::ui::GenericResourceWidget _contentWidget;
+      /// @note expression of the last committed contents, for edit history
+      std::string _committedContent;
 
       int getPinIndex() const;
 
@@ -117,7 +122,9 @@ namespace zs {
             _kind{_kind},
             _parent{parent},
             _contents{},
+            _contentAux{},
             _contentWidget{},
+            _committedContent{},
             _visible{true} {}
       ~Pin();  // unregister pin and delete related links
 
@@ -132,7 +139,9 @@ namespace zs {
             _chs{zs::move(o._chs)},
             _parent{zs::exchange(o._parent, nullptr)},
             _contents{zs::move(o._contents)},
+            _contentAux{zs::move(o._contentAux)},
             _contentWidget{zs::move(o._contentWidget)},
+            _committedContent{zs::move(o._committedContent)},
             _visible{zs::exchange(o._visible, false)} {}
 
       friend void swap(Pin &a, Pin &b) noexcept;
@@ -173,8 +182,15 @@ namespace zs {
       ZsVar &contents() { return _contents; }
       const ZsVar &contents() const { return _contents; }
       zs::ui::GenericResourceWidget &setupContentWidget(ZsValue aux = {});
-      void drawContentItem() { _contentWidget.draw(); }
+      void drawContentItem() {
+        _contentWidget.draw();
+        trackContentEdit();
+      }
       void setupContentAndWidget(ZsDict desc);
+      /// @note python expression (evaluable by zs_eval_expr) of the current contents
+      std::string contentExpr() const;
+      /// @note records a pin value edit once the content widget is deactivated
+      void trackContentEdit();
 
       float evaluatePinWidth(float offset = 0.f) const;
       float evaluateIconTextVerticalOffset() const {
@@ -360,6 +376,99 @@ namespace zs {
       void paint();
     };
 
+    ///
+    /// @brief edit history of a graph
+    /// @note every record only holds the delta of an edit (ids, names, contents of the touched
+    /// items), never a snapshot of the whole graph. Undo/redo replays the delta in O(delta).
+    ///
+    struct GraphHistory {
+      using IdInt = decltype(declval<ed::PinId>().Get());
+
+      struct PinRecord {
+        IdInt _id;
+        std::string _name;
+        pin_type_e _type;
+        pin_kind_e _kind;
+        std::optional<bool> _expanded;
+        std::optional<std::string> _content;  // python expression
+        ZsVar _contentAux;
+        std::vector<PinRecord> _chs;
+      };
+      struct LinkRecord {
+        IdInt _id, _srcPin, _dstPin;
+      };
+      struct NodeRecord {
+        IdInt _id;
+        std::string _name;
+        node_type_e _type;
+        ImVec2 _pos;
+        std::vector<PinRecord> _inputs, _outputs;
+      };
+      /// @note where a pin lives: node, input/output list, parent pin (0 if top-level), index
+      struct PinLocation {
+        IdInt _node, _parent;
+        pin_kind_e _kind;
+        int _index;
+      };
+
+      enum command_e : u8 {
+        node_spawn = 0,
+        node_delete,
+        link_create,
+        link_remove,
+        pin_insert,
+        pin_remove,
+        pin_value,
+        node_move,
+      };
+      struct Command {
+        command_e _type;
+        NodeRecord _node;             // node_spawn, node_delete
+        PinRecord _pin;               // pin_insert, pin_remove
+        PinLocation _pinLoc;          // pin_insert, pin_remove
+        std::vector<LinkRecord> _links;  // links created/removed along with the command
+        IdInt _target;                // pin_value (pin id), node_move (node id)
+        std::string _from, _to;       // pin_value
+        ImVec2 _fromPos, _toPos;      // node_move
+
+        size_t footprint() const noexcept;
+      };
+      GraphHistory(size_t maxEntries = 128, size_t maxBytes = (size_t)16 << 20) noexcept
+          : _transactions{maxEntries, maxBytes} {}
+
+      /// @note a transaction stays open until the outermost end() call
+      void begin() { _transactions.begin(); }
+      void end() { _transactions.end(); }
+      bool recording() const noexcept { return _transactions.recording(); }
+
+      void recordNodeSpawn(const Node &node);
+      void recordNodeDelete(const Node &node);
+      void recordLinkCreate(const Link &link);
+      void recordLinkRemove(const Link &link);
+      void recordPinInsert(const Pin &pin);
+      void recordPinRemove(const Pin &pin);
+      void recordPinValue(const Pin &pin, std::string from, std::string to);
+      void recordNodeMove(ed::NodeId id, ImVec2 from, ImVec2 to);
+
+      bool canUndo() const noexcept { return _transactions.canUndo(); }
+      bool canRedo() const noexcept { return _transactions.canRedo(); }
+      bool undo(Graph &graph);
+      bool redo(Graph &graph);
+      void clear() { _transactions.clear(); }
+
+      size_t numUndoEntries() const noexcept { return _transactions.numUndoEntries(); }
+      size_t numRedoEntries() const noexcept { return _transactions.numRedoEntries(); }
+      size_t footprint() const noexcept { return _transactions.footprint(); }
+      void setCapacity(size_t maxEntries, size_t maxBytes) {
+        _transactions.setCapacity(maxEntries, maxBytes);
+      }
+
+    protected:
+      void apply(Graph &graph, const Command &cmd, bool forward);
+
+      TransactionHistory<Command> _transactions;
+    };
+
     struct Graph {
       struct EditorContextGuard {
         EditorContextGuard(ed::EditorContext *ctx) {
@@ -423,6 +532,11 @@ namespace zs {
       std::queue<zs::function<void()>> _itemMaintenanceActions;
       std::set<std::pair<PinIdInt, PinIdInt>> _drawnLinks;
 
+      /// edit history
+      GraphHistory _history;
+      /// @note node positions at the start of a (potential) drag
+      std::map<ed::NodeId, ImVec2, NodeComp> _dragStartPositions;
+
       /// for interactions with other gui widgets
       ImGuiID _prevAltOwner = 0;
       ed::NodeId hoveredNode;
@@ -442,7 +556,8 @@ namespace zs {
             _nodes{zs::move(o._nodes)},
             _viewJson{zs::move(o._viewJson)},
             _viewRect{zs::move(o._viewRect)},
-            _initRequired{zs::exchange(o._initRequired, false)} {
+            _initRequired{zs::exchange(o._initRequired, false)},
+            _history{zs::move(o._history)} {
         updateGraphLinks();
       }
 
@@ -517,6 +632,15 @@ namespace zs {
       zs::tuple<NodeMap::iterator, bool> spawnNode(std::string_view name, ed::NodeId nid);
       zs::tuple<NodeMap::iterator, bool> spawnNode(std::string_view name);
       zs::tuple<LinkMap::iterator, bool> spawnLink(Pin *srcPin, Pin *dstPin);
+      zs::tuple<LinkMap::iterator, bool> spawnLink(ed::LinkId lid, Pin *srcPin, Pin *dstPin);
+
+      GraphHistory &history() noexcept { return _history; }
+      const GraphHistory &history() const noexcept { return _history; }
+      bool undo() { return _history.undo(*this); }
+      bool redo() { return _history.redo(*this); }
+      /// @note the displayed pin contents and node attributes have been modified elsewhere, e.g.
+      /// in place by python code
+      void markDirty();
 
       void paint();
       void save();
@@ -552,6 +676,7 @@ namespace zs {
       const std::vector<Node *> &querySelectionNodes();
 
       void updateGraphLinks();
+      void trackNodeMoves();
       void acquireEditorContext(std::string_view name);
 
       bool isLinked(ed::PinId id0, ed::PinId id1) const;
@@ -1,5 +1,6 @@
 #include "GraphWidgetComponent.hpp"
 #include "WidgetDrawUtilities.hpp"
+#include "interface/details/PyHelper.hpp"
 
 namespace zs {
 
@@ -21,6 +22,14 @@ namespace zs {
 
       ImGui::SetKeyOwner(ImGuiMod_Alt, id);
 
+      /// @note history replay is deferred to the maintenance stage (within ed::Begin/End)
+      if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiKey_Z, ImGuiInputFlags_Repeat))
+        enqueueMaintenanceAction([this]() { undo(); });
+      else if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiKey_Y, ImGuiInputFlags_Repeat)
+               || ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiMod_Shift | ImGuiKey_Z,
+                                  ImGuiInputFlags_Repeat))
+        enqueueMaintenanceAction([this]() { redo(); });
+
       ed::Begin(_name.c_str());
 
       ///
@@ -54,13 +63,20 @@ namespace zs {
                   if (srcPin->_kind == pin_kind_e::Input) {
                     zs_swap(srcPin, dstPin);
                   }
+                  _history.begin();
                   /// remove existing links related to the dstPin (if any)
-                  if (dstPin->_links.size()) _links.erase((*dstPin->_links.begin())->_id);
+                  if (dstPin->_links.size()) {
+                    auto link = *dstPin->_links.begin();
+                    _history.recordLinkRemove(*link);
+                    _links.erase(link->_id);
+                  }
                   ///
                   auto lid = nextLinkId();
                   auto [iter, success]
                       = _links.emplace(std::piecewise_construct, std::forward_as_tuple(lid),
                                        std::forward_as_tuple(lid, srcPin, dstPin));
+                  _history.recordLinkCreate(iter->second);
+                  _history.end();
                   iter->second.paint();
                 }
               }
@@ -80,11 +96,16 @@ namespace zs {
       ed::EndCreate();
       ///
       if (ed::BeginDelete()) {
+        /// @note all deletions within one frame are undone as a whole
+        _history.begin();
         /// link deletion
         ed::LinkId deletedLinkId;
         while (ed::QueryDeletedLink(&deletedLinkId)) {
           if (ed::AcceptDeletedItem()) {
-            _links.erase(deletedLinkId);
+            if (auto it = _links.find(deletedLinkId); it != _links.end()) {
+              _history.recordLinkRemove(it->second);
+              _links.erase(it);
+            }
           }
         }
         /// pin deletion
@@ -92,6 +113,7 @@ namespace zs {
         while (ed::QueryDeletedPin(&deletedPinId)) {
           if (ed::AcceptDeletedItem()) {
             auto pin = _pins.at(deletedPinId);
+            _history.recordPinRemove(*pin);
             pin->_node->removePin(pin);
           }
         }
@@ -99,9 +121,11 @@ namespace zs {
         ed::NodeId nodeId = 0;
         while (ed::QueryDeletedNode(&nodeId)) {
           if (ed::AcceptDeletedItem()) {
+            if (auto node = findNode(nodeId)) _history.recordNodeDelete(*node);
             _nodes.erase(nodeId);
           }
         }
+        _history.end();
       }
       ed::EndDelete();
 
@@ -122,6 +146,7 @@ namespace zs {
         if (node) {
           ed::SetNodePosition(node->_id, popupPosition);
           // node->inited = true;
+          _history.recordNodeSpawn(*node);
         }
         ImGui::EndPopup();
       }
@@ -139,6 +164,8 @@ namespace zs {
         auxWidgetAction();
       }
 
+      trackNodeMoves();
+
       ed::End();
 
       if (_initRequired) {
@@ -188,13 +215,50 @@ namespace zs {
       return spawnNode(name, nextNodeId());
     }
     zs::tuple<Graph::LinkMap::iterator, bool> Graph::spawnLink(Pin *srcPin, Pin *dstPin) {
-      auto lid = nextLinkId();
+      return spawnLink(nextLinkId(), srcPin, dstPin);
+    }
+    zs::tuple<Graph::LinkMap::iterator, bool> Graph::spawnLink(ed::LinkId lid, Pin *srcPin,
+                                                               Pin *dstPin) {
+      updateObjectId(lid.Get());
       auto [iter, success] = _links.emplace(std::piecewise_construct, std::forward_as_tuple(lid),
                                             std::forward_as_tuple(lid, srcPin, dstPin));
       if (!success)
         throw std::runtime_error("unable to create a new link (maybe due to duplication).");
       return zs::make_tuple(iter, success);
     }
+    static void mark_pin_dirty(Pin &pin) {
+      pin._contentWidget.markDirty();
+      for (auto &ch : pin._chs) mark_pin_dirty(ch);
+    }
+    void Graph::markDirty() {
+      /// @note list widgets reload their elements right away
+      GILGuard guard;
+      for (auto &[id, node] : _nodes) {
+        node._attribWidget.markDirty();
+        for (auto &pin : node._inputs) mark_pin_dirty(pin);
+        for (auto &pin : node._outputs) mark_pin_dirty(pin);
+      }
+    }
+    void Graph::trackNodeMoves() {
+      if (ImGui::IsMouseClicked(ImGuiMouseButton_Left) && hoveredNode) {
+        /// @note dragging a selected node moves the whole selection
+        _dragStartPositions.clear();
+        _dragStartPositions.emplace(hoveredNode, ed::GetNodePosition(hoveredNode));
+        std::vector<ed::NodeId> ids(ed::GetSelectedObjectCount());
+        auto n = ed::GetSelectedNodes(ids.data(), (int)ids.size());
+        for (int i = 0; i != n; ++i)
+          _dragStartPositions.emplace(ids[i], ed::GetNodePosition(ids[i]));
+      } else if (ImGui::IsMouseReleased(ImGuiMouseButton_Left) && !_dragStartPositions.empty()) {
+        _history.begin();
+        for (const auto &[nid, from] : _dragStartPositions) {
+          if (!findNode(nid)) continue;
+          auto to = ed::GetNodePosition(nid);
+          if (to.x != from.x || to.y != from.y) _history.recordNodeMove(nid, from, to);
+        }
+        _history.end();
+        _dragStartPositions.clear();
+      }
+    }
     void Graph::removePinLinks(Pin &pin) {
       /// @note link deletion will modify pin's _links on-the-fly
       auto links = pin._links;
@@ -222,6 +286,7 @@ namespace zs {
       zs_swap(a._viewJson, b._viewJson);
       zs_swap(a._viewRect, b._viewRect);
       zs_swap(a._initRequired, b._initRequired);
+      zs_swap(a._history, b._history);
 
       /// @note _graph ptr in _nodes are still referring to graph [o] ftm,
       /// update links to graph object
@@ -0,0 +1,284 @@
+#include "GraphWidgetComponent.hpp"
+#include "interface/details/PyHelper.hpp"
+
+namespace zs {
+
+  namespace ge {
+
+    using IdInt = GraphHistory::IdInt;
+
+    ///
+    /// capture
+    ///
+    static GraphHistory::PinRecord capture_pin(const Pin &pin) {
+      GraphHistory::PinRecord rec;
+      rec._id = pin._id.Get();
+      rec._name = pin._name;
+      rec._type = pin._type;
+      rec._kind = pin._kind;
+      rec._expanded = pin._expanded;
+      if (pin.hasContents()) {
+        rec._content = pin.contentExpr();
+        rec._contentAux = pin._contentAux;
+      }
+      rec._chs.reserve(pin._chs.size());
+      for (const auto &ch : pin._chs) rec._chs.push_back(capture_pin(ch));
+      return rec;
+    }
+    static GraphHistory::PinLocation locate_pin(const Pin &pin) {
+      const PinList &siblings = pin._parent ? pin._parent->_chs
+                                : pin._kind == pin_kind_e::Input ? pin._node->_inputs
+                                                                 : pin._node->_outputs;
+      int index = 0;
+      for (const auto &p : siblings) {
+        if (zs::addressof(p) == zs::addressof(pin)) break;
+        index++;
+      }
+      return GraphHistory::PinLocation{pin._node->_id.Get(),
+                                       pin._parent ? pin._parent->_id.Get() : (IdInt)0, pin._kind,
+                                       index};
+    }
+    static GraphHistory::LinkRecord capture_link(const Link &link) {
+      return GraphHistory::LinkRecord{link._id.Get(), link._srcPin->_id.Get(),
+                                      link._dstPin->_id.Get()};
+    }
+    /// @note links attached to [pin] and its descendants
+    static void capture_pin_links(const Pin &pin, std::vector<GraphHistory::LinkRecord> &links) {
+      for (auto link : pin._links) {
+        auto id = link->_id.Get();
+        bool dup = false;
+        for (const auto &rec : links)
+          if (rec._id == id) {
+            dup = true;
+            break;
+          }
+        if (!dup) links.push_back(capture_link(*link));
+      }
+      for (const auto &ch : pin._chs) capture_pin_links(ch, links);
+    }
+    static GraphHistory::NodeRecord capture_node(const Node &node) {
+      GraphHistory::NodeRecord rec;
+      rec._id = node._id.Get();
+      rec._name = node._name;
+      rec._type = node._type;
+      rec._pos = ed::GetNodePosition(node._id);
+      rec._inputs.reserve(node._inputs.size());
+      for (const auto &pin : node._inputs) rec._inputs.push_back(capture_pin(pin));
+      rec._outputs.reserve(node._outputs.size());
+      for (const auto &pin : node._outputs) rec._outputs.push_back(capture_pin(pin));
+      return rec;
+    }
+
+    ///
+    /// restore
+    ///
+    /// @note [aux] is taken by value, it might refer to the pin's own candidates
+    static void restore_pin_contents(Pin &pin, const std::string &expr, ZsVar aux) {
+      {
+        GILGuard guard;
+        pin.contents() = zs_eval_expr(expr.c_str());
+      }
+      /// @note rebuild the widget, as it caches the displayed value
+      if (pin.contents()) pin.setupContentWidget(aux.getValue());
+    }
+    static void restore_pin_attribs(Graph &graph, Pin &pin, const GraphHistory::PinRecord &rec) {
+      pin._type = rec._type;
+      pin._expanded = rec._expanded;
+      if (rec._content) restore_pin_contents(pin, *rec._content, rec._contentAux);
+      for (const auto &ch : rec._chs) {
+        graph.updateObjectId(ch._id);
+        auto chPin = pin.append(ed::PinId(ch._id), ch._name);
+        restore_pin_attribs(graph, *chPin, ch);
+      }
+    }
+    static Pin *restore_pin(Graph &graph, const GraphHistory::PinRecord &rec,
+                            const GraphHistory::PinLocation &loc) {
+      auto node = graph.findNode(ed::NodeId(loc._node));
+      if (!node || graph.findPin(ed::PinId(rec._id))) return nullptr;
+      Pin *parent = nullptr;
+      if (loc._parent) {
+        parent = graph.findPin(ed::PinId(loc._parent));
+        if (!parent) return nullptr;
+      }
+      PinList &siblings = parent ? parent->_chs
+                          : loc._kind == pin_kind_e::Input ? node->_inputs
+                                                           : node->_outputs;
+      auto it = std::begin(siblings);
+      std::advance(it, std::min((size_t)loc._index, siblings.size()));
+      graph.updateObjectId(rec._id);
+      auto ret = siblings.emplace(it, ed::PinId(rec._id), node, rec._name, rec._type, rec._kind,
+                                  parent);
+      auto pin = graph._pins[ret->_id] = zs::addressof(*ret);
+      restore_pin_attribs(graph, *pin, rec);
+      return pin;
+    }
+    static void restore_link(Graph &graph, const GraphHistory::LinkRecord &rec) {
+      if (graph._links.find(ed::LinkId(rec._id)) != graph._links.end()) return;
+      auto srcPin = graph.findPin(ed::PinId(rec._srcPin));
+      auto dstPin = graph.findPin(ed::PinId(rec._dstPin));
+      if (srcPin && dstPin) graph.spawnLink(ed::LinkId(rec._id), srcPin, dstPin);
+    }
+    static void restore_node(Graph &graph, const GraphHistory::NodeRecord &rec) {
+      if (graph.findNode(ed::NodeId(rec._id))) return;
+      auto [iter, success] = graph.spawnNode(rec._name, ed::NodeId(rec._id));
+      auto &node = iter->second;
+      node._type = rec._type;
+      node._pos = rec._pos;
+      for (const auto &pinRec : rec._inputs) {
+        graph.updateObjectId(pinRec._id);
+        restore_pin_attribs(graph, *node.appendInput(ed::PinId(pinRec._id), pinRec._name),
+                            pinRec);
+      }
+      for (const auto &pinRec : rec._outputs) {
+        graph.updateObjectId(pinRec._id);
+        restore_pin_attribs(graph, *node.appendOutput(ed::PinId(pinRec._id), pinRec._name),
+                            pinRec);
+      }
+      ed::SetNodePosition(node._id, rec._pos);
+    }
+    static void remove_pin(Graph &graph, IdInt id) {
+      if (auto pin = graph.findPin(ed::PinId(id))) pin->_node->removePin(pin);
+    }
+
+    ///
+    /// GraphHistory
+    ///
+    static size_t pin_record_footprint(const GraphHistory::PinRecord &rec) {
+      size_t ret = sizeof(rec) + rec._name.size() + (rec._content ? rec._content->size() : 0);
+      for (const auto &ch : rec._chs) ret += pin_record_footprint(ch);
+      return ret;
+    }
+    size_t GraphHistory::Command::footprint() const noexcept {
+      size_t ret = sizeof(Command) + _node._name.size() + _from.size() + _to.size()
+                   + _links.size() * sizeof(LinkRecord);
+      for (const auto &pin : _node._inputs) ret += pin_record_footprint(pin);
+      for (const auto &pin : _node._outputs) ret += pin_record_footprint(pin);
+      for (const auto &ch : _pin._chs) ret += pin_record_footprint(ch);
+      ret += _pin._name.size() + (_pin._content ? _pin._content->size() : 0);
+      return ret;
+    }
+
+    void GraphHistory::recordNodeSpawn(const Node &node) {
+      if (!recording()) return;
+      Command cmd{};
+      cmd._type = node_spawn;
+      cmd._node = capture_node(node);
+      _transactions.push(zs::move(cmd));
+    }
+    void GraphHistory::recordNodeDelete(const Node &node) {
+      if (!recording()) return;
+      Command cmd{};
+      cmd._type = node_delete;
+      cmd._node = capture_node(node);
+      for (const auto &pin : node._inputs) capture_pin_links(pin, cmd._links);
+      for (const auto &pin : node._outputs) capture_pin_links(pin, cmd._links);
+      _transactions.push(zs::move(cmd));
+    }
+    void GraphHistory::recordLinkCreate(const Link &link) {
+      if (!recording()) return;
+      Command cmd{};
+      cmd._type = link_create;
+      cmd._links.push_back(capture_link(link));
+      _transactions.push(zs::move(cmd));
+    }
+    void GraphHistory::recordLinkRemove(const Link &link) {
+      if (!recording()) return;
+      Command cmd{};
+      cmd._type = link_remove;
+      cmd._links.push_back(capture_link(link));
+      _transactions.push(zs::move(cmd));
+    }
+    void GraphHistory::recordPinInsert(const Pin &pin) {
+      if (!recording()) return;
+      Command cmd{};
+      cmd._type = pin_insert;
+      cmd._pin = capture_pin(pin);
+      cmd._pinLoc = locate_pin(pin);
+      _transactions.push(zs::move(cmd));
+    }
+    void GraphHistory::recordPinRemove(const Pin &pin) {
+      if (!recording()) return;
+      Command cmd{};
+      cmd._type = pin_remove;
+      cmd._pin = capture_pin(pin);
+      cmd._pinLoc = locate_pin(pin);
+      capture_pin_links(pin, cmd._links);
+      _transactions.push(zs::move(cmd));
+    }
+    void GraphHistory::recordPinValue(const Pin &pin, std::string from, std::string to) {
+      if (!recording()) return;
+      Command cmd{};
+      cmd._type = pin_value;
+      cmd._target = pin._id.Get();
+      cmd._from = zs::move(from);
+      cmd._to = zs::move(to);
+      _transactions.push(zs::move(cmd));
+    }
+    void GraphHistory::recordNodeMove(ed::NodeId id, ImVec2 from, ImVec2 to) {
+      if (!recording()) return;
+      Command cmd{};
+      cmd._type = node_move;
+      cmd._target = id.Get();
+      cmd._fromPos = from;
+      cmd._toPos = to;
+      _transactions.push(zs::move(cmd));
+    }
+
+    bool GraphHistory::undo(Graph &graph) {
+      return _transactions.undo([this, &graph](const Command &cmd) { apply(graph, cmd, false); });
+    }
+    bool GraphHistory::redo(Graph &graph) {
+      return _transactions.redo([this, &graph](const Command &cmd) { apply(graph, cmd, true); });
+    }
+
+    /// @note [forward] replays the edit, otherwise reverts it
+    void GraphHistory::apply(Graph &graph, const Command &cmd, bool forward) {
+      auto guard = graph.contextGuard();
+      switch (cmd._type) {
+        case node_spawn:
+        case node_delete: {
+          if (forward == (cmd._type == node_spawn)) {
+            restore_node(graph, cmd._node);
+            for (const auto &link : cmd._links) restore_link(graph, link);
+          } else
+            graph._nodes.erase(ed::NodeId(cmd._node._id));
+          break;
+        }
+        case link_create:
+        case link_remove: {
+          if (forward == (cmd._type == link_create)) {
+            for (const auto &link : cmd._links) restore_link(graph, link);
+          } else {
+            for (const auto &link : cmd._links) graph._links.erase(ed::LinkId(link._id));
+          }
+          break;
+        }
+        case pin_insert:
+        case pin_remove: {
+          if (forward == (cmd._type == pin_insert)) {
+            restore_pin(graph, cmd._pin, cmd._pinLoc);
+            for (const auto &link : cmd._links) restore_link(graph, link);
+          } else
+            remove_pin(graph, cmd._pin._id);
+          break;
+        }
+        case pin_value: {
+          if (auto pin = graph.findPin(ed::PinId(cmd._target)))
+            restore_pin_contents(*pin, forward ? cmd._to : cmd._from, pin->_contentAux);
+          break;
+        }
+        case node_move: {
+          ed::NodeId nid(cmd._target);
+          if (auto node = graph.findNode(nid)) {
+            node->_pos = forward ? cmd._toPos : cmd._fromPos;
+            ed::SetNodePosition(nid, node->_pos);
+          }
+          break;
+        }
+        default:;
+      }
+    }
+
+  }  // namespace ge
+
+}  // namespace zs
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace zs {
+
+  namespace ge {
+
+    ///
+    /// @brief bounded undo/redo stacks of command transactions
+    /// @note [Command] provides footprint() (in bytes). Replaying a command is left to the
+    /// owner, which passes the replay to undo()/ redo(), and commands pushed meanwhile are dropped.
+    ///
+    template <typename Command> struct TransactionHistory {
+      /// @note commands issued within one user interaction are undone/redone together
+      struct Transaction {
+        std::vector<Command> _cmds;
+        size_t _bytes{0};
+      };
+
+      TransactionHistory(size_t maxEntries, size_t maxBytes) noexcept
+          : _maxEntries{maxEntries}, _maxBytes{maxBytes} {}
+
+      /// @note a transaction stays open until the outermost end() call
+      void begin() { _depth++; }
+      void end() {
+        if (_depth > 0 && --_depth == 0 && !_pending._cmds.empty())
+          commit(std::exchange(_pending, Transaction{}));
+      }
+      bool recording() const noexcept { return !_replaying; }
+
+      void push(Command &&cmd) {
+        if (_replaying) return;
+        _pending._bytes += cmd.footprint();
+        _pending._cmds.push_back(std::move(cmd));
+        if (_depth == 0) commit(std::exchange(_pending, Transaction{}));
+      }
+
+      /// @note [revert] is invoked on the commands of the latest transaction in reverse order
+      template <typename F> bool undo(F &&revert) {
+        if (_depth != 0 || _undoStack.empty()) return false;
+        auto t = std::move(_undoStack.back());
+        _undoStack.pop_back();
+        _replaying = true;
+        for (auto it = t._cmds.rbegin(); it != t._cmds.rend(); ++it) revert(*it);
+        _replaying = false;
+        _redoStack.push_back(std::move(t));
+        return true;
+      }
+      /// @note [replay] is invoked on the commands of the latest undone transaction in order
+      template <typename F> bool redo(F &&replay) {
+        if (_depth != 0 || _redoStack.empty()) return false;
+        auto t = std::move(_redoStack.back());
+        _redoStack.pop_back();
+        _replaying = true;
+        for (const auto &cmd : t._cmds) replay(cmd);
+        _replaying = false;
+        _undoStack.push_back(std::move(t));
+        return true;
+      }
+
+      bool canUndo() const noexcept { return !_undoStack.empty(); }
+      bool canRedo() const noexcept { return !_redoStack.empty(); }
+      void clear() {
+        _undoStack.clear();
+        _redoStack.clear();
+        _pending = Transaction{};
+        _bytes = 0;
+      }
+
+      size_t numUndoEntries() const noexcept { return _undoStack.size(); }
+      size_t numRedoEntries() const noexcept { return _redoStack.size(); }
+      size_t footprint() const noexcept { return _bytes; }
+      void setCapacity(size_t maxEntries, size_t maxBytes) {
+        _maxEntries = maxEntries;
+        _maxBytes = maxBytes;
+        shrink();
+      }
+
+    protected:
+      void commit(Transaction &&t) {
+        for (const auto &r : _redoStack) _bytes -= r._bytes;
+        _redoStack.clear();
+        _bytes += t._bytes;
+        _undoStack.push_back(std::move(t));
+        shrink();
+      }
+      /// @note the oldest transactions go first
+      void shrink() {
+        while (!_undoStack.empty()
+               && (_undoStack.size() + _redoStack.size() > _maxEntries || _bytes > _maxBytes)) {
+          _bytes -= _undoStack.front()._bytes;
+          _undoStack.pop_front();
+        }
+        while (!_redoStack.empty() && (_redoStack.size() > _maxEntries || _bytes > _maxBytes)) {
+          _bytes -= _redoStack.front()._bytes;
+          _redoStack.pop_front();
+        }
+      }
+
+      std::deque<Transaction> _undoStack, _redoStack;
+      Transaction _pending;
+      size_t _maxEntries, _maxBytes, _bytes{0};
+      int _depth{0};
+      bool _replaying{false};
+    };
+
+    /// @note python string literal of [s], which evaluates back to [s]
+    inline std::string python_string_literal(std::string_view s) {
+      constexpr char hex[] = "0123456789abcdef";
+      std::string ret;
+      ret.reserve(s.size() + 2);
+      ret += '\"';
+      for (char c : s) {
+        switch (c) {
+          case '\"':
+            ret += "\\\"";
+            break;
+          case '\\':
+            ret += "\\\\";
+            break;
+          case '\n':
+            ret += "\\n";
+            break;
+          case '\r':
+            ret += "\\r";
+            break;
+          case '\t':
+            ret += "\\t";
+            break;
+          default:
+            if ((unsigned char)c < 0x20 || c == 0x7f) {
+              ret += "\\x";
+              ret += hex[(unsigned char)c >> 4];
+              ret += hex[(unsigned char)c & 0xf];
+            } else
+              ret += c;  // utf-8 bytes are kept as is
+        }
+      }
+      ret += '\"';
+      return ret;
+    }
+
+  }  // namespace ge
+
+}  // namespace zs
@@ -342,10 +342,12 @@ namespace zs {
           ImGui::SetCursorPosY(p0.y + ImGui::GetStyle().ItemSpacing.y);
           if (ImGui::SmallButton("+")) {
             auto id = _node->_graph->nextPinId();
-            append(id, std::string("item_") + std::to_string(id.Get()));
+            auto chPin = append(id, std::string("item_") + std::to_string(id.Get()));
+            _node->_graph->_history.recordPinInsert(*chPin);
           }
           ImGui::SameLine();
           if (ImGui::SmallButton("-")) {
+            if (!_chs.empty()) _node->_graph->_history.recordPinRemove(_chs.back());
             remove_back();
           }
           ImGui::PopButtonRepeat();
@@ -387,10 +389,12 @@ namespace zs {
                                - ImGui::CalcTextSize("+").x - ImGui::CalcTextSize("-").x);
           if (ImGui::SmallButton("+")) {
             auto id = _node->_graph->nextPinId();
-            append(id, std::string("item_") + std::to_string(id.Get()));
+            auto chPin = append(id, std::string("item_") + std::to_string(id.Get()));
+            _node->_graph->_history.recordPinInsert(*chPin);
           }
           ImGui::SameLine();
           if (ImGui::SmallButton("-")) {
+            if (!_chs.empty()) _node->_graph->_history.recordPinRemove(_chs.back());
             remove_back();
           }
           ImGui::PopButtonRepeat();
@@ -433,6 +437,7 @@ namespace zs {
 
             /// @note item creations in effect in the next frame
             _node->_graph->enqueueMaintenanceAction([this, graph = _node->_graph]() {
+              graph->_history.begin();
               auto &itemCreator = graph->getEditorContext()->GetItemCreator();
               /// @note hide the to-be-deleted pin during the next draw
               if (itemCreator.m_OriginalActivePin
@@ -450,7 +455,9 @@ namespace zs {
                 auto dstPin = chPin;
                 if (srcPin->_kind == pin_kind_e::Input && dstPin->_kind == pin_kind_e::Output)
                   zs_swap(srcPin, dstPin);
-                graph->spawnLink(srcPin, dstPin);
+                auto [iter, success] = graph->spawnLink(srcPin, dstPin);
+                graph->_history.recordPinInsert(*chPin);
+                graph->_history.recordLinkCreate(iter->second);
               } else {  // same-level appendix
                 if (_parent) {
                   auto graph = _node->_graph;
@@ -461,7 +468,9 @@ namespace zs {
                   auto dstPin = chPin;
                   if (srcPin->_kind == pin_kind_e::Input && dstPin->_kind == pin_kind_e::Output)
                     zs_swap(srcPin, dstPin);
-                  graph->spawnLink(srcPin, dstPin);
+                  auto [iter, success] = graph->spawnLink(srcPin, dstPin);
+                  graph->_history.recordPinInsert(*chPin);
+                  graph->_history.recordLinkCreate(iter->second);
                 } else {
                   auto graph = _node->_graph;
                   auto id = graph->nextPinId();
@@ -476,9 +485,12 @@ namespace zs {
                   auto dstPin = chPin;
                   if (srcPin->_kind == pin_kind_e::Input && dstPin->_kind == pin_kind_e::Output)
                     zs_swap(srcPin, dstPin);
-                  graph->spawnLink(srcPin, dstPin);
+                  auto [iter, success] = graph->spawnLink(srcPin, dstPin);
+                  graph->_history.recordPinInsert(*chPin);
+                  graph->_history.recordLinkCreate(iter->second);
                 }
               }
+              graph->_history.end();
             });
 
           } else if (itemCreator.m_DraggedPin != nullptr) {
@@ -708,7 +720,32 @@ namespace zs {
       }
     }
 
+    std::string Pin::contentExpr() const {
+      GILGuard guard;
+      PyVar str = zs_string_obj(_contents);
+      if (PyVar bs = zs_bytes_obj(str.handle())) {
+        auto s = std::string(bs.asBytes().c_str());
+        if (!_contents.getValue().isString()) return s;
+        return python_string_literal(s);
+      }
+      return {};
+    }
+    void Pin::trackContentEdit() {
+      if (!ImGui::IsItemDeactivated()) return;
+      auto expr = contentExpr();
+      if (expr != _committedContent) {
+        if (!_committedContent.empty())
+          _node->_graph->_history.recordPinValue(*this, _committedContent, expr);
+        _committedContent = zs::move(expr);
+      }
+    }
+
     zs::ui::GenericResourceWidget &Pin::setupContentWidget(ZsValue aux) {
+      if (aux)
+        _contentAux.share(aux);
+      else
+        _contentAux = ZsVar{};
+      _committedContent = contentExpr();
       if (!aux) _contentWidget = zs::ui::GenericResourceWidget(_name, contents(), aux);
 #if 0
   if (aux) {
@@ -786,7 +823,9 @@ namespace zs {
       zs_swap(a._parent, b._parent);
       zs_swap(a._visible, b._visible);
       zs_swap(a._contents, b._contents);
+      zs_swap(a._contentAux, b._contentAux);
       zs_swap(a._contentWidget, b._contentWidget);
+      zs_swap(a._committedContent, b._committedContent);
     }
 
   }  // namespace ge
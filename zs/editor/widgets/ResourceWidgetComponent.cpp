@@ -2,6 +2,9 @@
 
 #include <Python.h>
 
+#include <algorithm>
+#include <cfloat>
+
 #include "imgui.h"
 #include "imgui_stdlib.h"
 #include "interface/details/PyHelper.hpp"
@@ -94,23 +97,76 @@ namespace zs::ui {
   ///
   void PyDisplay::updateStr() {
     auto obj = value();
+    _strHandle = obj._v.obj;
+    _dirty = false;
     GILGuard guard;
     PyVar str = zs_string_obj(obj);
     PyVar typeStr = zs_string_obj_type(obj);
     if (str && typeStr) {
-      auto text = fmt::format("type: [{}], str: {}\n\n", str.asString().c_str(),
-                              typeStr.asString().c_str());
+      auto text = fmt::format("type: [{}], str: {}\n\n", typeStr.asString().c_str(),
+                              str.asString().c_str());
       _str = text;
+      _strWidth = -1.f;
     }
   }
-  float PyDisplay::do_preferredWidth() const { return ImGui::CalcTextSize(_str.c_str()).x; }
+  float PyDisplay::do_preferredWidth() const {
+    if (_strWidth < 0.f) _strWidth = ImGui::CalcTextSize(_str.c_str()).x;
+    return _strWidth;
+  }
   void PyDisplay::do_draw() {
     // ImGui::BeginDisabled(true);
     ImGui::InputText(getLabelOpaque().c_str(), _str.data(), _str.size(),
                      ImGuiInputTextFlags_ReadOnly);
     // ImGui::EndDisabled();
 
-    if (_PyThreadState_UncheckedGet() && PyGILState_Check()) updateStr();
+    /// @note not drawn in the last frame, i.e. (re)appearing
+    const int frame = ImGui::GetFrameCount();
+    const bool appearing = _lastDrawFrame < 0 || _lastDrawFrame + 1 < frame;
+    _lastDrawFrame = frame;
+
+    const double now = ImGui::GetTime();
+    const bool expired = now - _lastRefreshTime >= s_refresh_interval;
+    if (!(_dirty || appearing || expired || value()._v.obj != _strHandle)) return;
+    if (_PyThreadState_UncheckedGet() && PyGILState_Check()) {
+      updateStr();
+      _lastRefreshTime = now;
+    }
+  }
+
+  ///
+  /// long lists (IntegerList, FloatingPointList)
+  ///
+  /// @note one element per row, plus the frame of the scrollable child
+  static float long_list_width(float elementWidth) {
+    const auto &style = ImGui::GetStyle();
+    return elementWidth + style.FramePadding.x * 2 + style.ScrollbarSize
+           + style.WindowPadding.x * 2;
+  }
+  template <typename ListWidget>
+  static void draw_long_list(ListWidget &widget, ImGuiDataType type, const char *format) {
+    auto &vs = widget._vs;
+    const auto &style = ImGui::GetStyle();
+    const float rowHeight = ImGui::GetFrameHeightWithSpacing();
+    const auto numRows = std::min(vs.size(), ListWidget::s_max_visible_rows);
+    const ImVec2 size{ImGui::CalcItemWidth(),
+                      rowHeight * numRows - style.ItemSpacing.y + style.WindowPadding.y * 2};
+    if (ImGui::BeginChild(widget.getLabelOpaque().c_str(), size, ImGuiChildFlags_Borders)) {
+      ImGuiListClipper clipper;
+      clipper.Begin((int)vs.size(), rowHeight);
+      while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+          ImGui::PushID(i);
+          ImGui::SetNextItemWidth(-FLT_MIN);
+          if (ImGui::InputScalar("##element", type, &vs[i], NULL, NULL, format, widget._flags)
+              && widget.linked()) {
+            widget.storeValue(i);
+            widget._widths.update(i, [&widget](size_t j) { return widget.elementWidth(j); });
+          }
+          ImGui::PopID();
+        }
+      }
+    }
+    ImGui::EndChild();
   }
 
   ///
@@ -125,40 +181,74 @@ namespace zs::ui {
     }
     return obj.isIntegral();
   }
-  float IntegerList::do_preferredWidth() const {
-    float ma = 0.f;
-    for (auto &i : _vs) {
-      auto str = fmt::format("{} ", i);
-      if (auto l = ImGui::CalcTextSize(str.c_str()).x; l > ma) ma = l;
+  void IntegerList::loadValues() {
+    auto h = value();
+    if (h.isList()) {
+      ZsList &l = h.asList();
+      _vs.resize(l.size());
+      int i = 0;
+      for (auto e : l) _vs[i++] = static_cast<long long>(e);
+    } else {
+      _vs.resize(1);
+      switch (h._idx) {
+        case zs_var_type_object:
+          _vs[0] = static_cast<long long>(h);
+          break;
+        case zs_var_type_i64:
+          _vs[0] = h._v.i64;
+          break;
+        case zs_var_type_i32:
+          _vs[0] = h._v.i32;
+          break;
+        case zs_var_type_i8:
+          _vs[0] = h._v.i8;
+          break;
+        default:;
+      }
+    }
+    _widths.reset();
+  }
+  void IntegerList::storeValue(size_t i) {
+    auto &v = ref().getRef();
+    auto h = value();
+    if (h.isList()) {
+      ZsList &list = h.asList();
+      if (ZsObject v = zs_long_obj_long_long(_vs[i]); list.setItemSteal(i, v) == -1) {
+        Py_DECREF(v.handle());
+      }
+    } else {
+      assert(_vs.size() == 1);
+      switch (h._idx) {
+        case zs_var_type_i64:
+          v._v.i64 = _vs[0];
+        case zs_var_type_i32:
+          v._v.i32 = _vs[0];
+        case zs_var_type_i8:
+          v._v.i8 = _vs[0];
+        case zs_var_type_object:
+          ref() = zs_long_obj_long_long(_vs[0]);
+        default:;
+      }
     }
-    return ma * _vs.size();
+  }
+  float IntegerList::elementWidth(size_t i) const {
+    auto str = fmt::format("{} ", _vs[i]);
+    return ImGui::CalcTextSize(str.c_str()).x;
+  }
+  float IntegerList::do_preferredWidth() const {
+    float ma = _widths.maxWidth(_vs.size(), [this](size_t i) { return elementWidth(i); });
+    if (_vs.size() <= s_inline_limit) return ma * _vs.size();
+    return long_list_width(ma);
   }
   void IntegerList::do_draw() {
+    if (_vs.size() > s_inline_limit) {
+      draw_long_list(*this, ImGuiDataType_S64, "%" PRId64);
+      return;
+    }
     if (ImGui::InputScalarN(getLabelOpaque().data(), ImGuiDataType_S64, _vs.data(), _vs.size(),
                             NULL, NULL, "%" PRId64, _flags)) {
-      auto &v = ref().getRef();
-      auto h = value();
-      if (h.isList()) {
-        ZsList &list = h.asList();
-        for (int i = 0; i < _vs.size(); ++i) {
-          if (ZsObject v = zs_long_obj_long_long(_vs[i]); list.setItemSteal(i, v) == -1) {
-            Py_DECREF(v.handle());
-          }
-        }
-      } else {
-        assert(_vs.size() == 1);
-        switch (h._idx) {
-          case zs_var_type_i64:
-            v._v.i64 = _vs[0];
-          case zs_var_type_i32:
-            v._v.i32 = _vs[0];
-          case zs_var_type_i8:
-            v._v.i8 = _vs[0];
-          case zs_var_type_object:
-            ref() = zs_long_obj_long_long(_vs[0]);
-          default:;
-        }
-      }
+      for (size_t i = 0; i != _vs.size(); ++i) storeValue(i);
+      _widths.reset();
     }
   }
 
@@ -175,39 +265,70 @@ namespace zs::ui {
     return obj.isFloatingPoint();
   }
 
-  float FloatingPointList::do_preferredWidth() const {
-    float ma = 0.f;
-    for (auto &f : _vs) {
-      // auto str = fmt::format("{}", f);
-      auto str = cformat("%.10f ", f);
-      if (auto l = ImGui::CalcTextSize(str.c_str()).x; l > ma) ma = l;
+  void FloatingPointList::loadValues() {
+    auto h = value();
+    if (h.isList()) {
+      ZsList &l = h.asList();
+      _vs.resize(l.size());
+      int i = 0;
+      for (auto e : l) _vs[i++] = static_cast<double>(e);
+    } else {
+      _vs.resize(1);
+      switch (h._idx) {
+        case zs_var_type_object:
+          _vs[0] = static_cast<double>(h);
+          break;
+        case zs_var_type_f64:
+          _vs[0] = h._v.f64;
+          break;
+        case zs_var_type_f32:
+          _vs[0] = h._v.f32;
+          break;
+        default:;
+      }
+    }
+    _widths.reset();
+  }
+  void FloatingPointList::storeValue(size_t i) {
+    auto &v = ref().getRef();
+    auto h = value();
+    if (h.isList()) {
+      ZsList &list = h.asList();
+      if (ZsObject v = zs_float_obj_double(_vs[i]); list.setItemSteal(i, v) == -1)
+        Py_DECREF(v.handle());
+    } else {
+      assert(_vs.size() == 1);
+      switch (h._idx) {
+        case zs_var_type_f64:
+          v._v.f64 = _vs[0];
+        case zs_var_type_f32:
+          v._v.f32 = _vs[0];
+        case zs_var_type_object:
+          ref() = zs_float_obj_double(_vs[0]);
+        default:;
+      }
     }
-    return ma * _vs.size();
+  }
+  float FloatingPointList::elementWidth(size_t i) const {
+    // auto str = fmt::format("{}", f);
+    auto str = cformat("%.10f ", _vs[i]);
+    return ImGui::CalcTextSize(str.c_str()).x;
+  }
+  float FloatingPointList::do_preferredWidth() const {
+    float ma = _widths.maxWidth(_vs.size(), [this](size_t i) { return elementWidth(i); });
+    if (_vs.size() <= s_inline_limit) return ma * _vs.size();
+    return long_list_width(ma);
   }
   void FloatingPointList::do_draw() {
+    if (_vs.size() > s_inline_limit) {
+      draw_long_list(*this, ImGuiDataType_Double, "%.10f");
+      return;
+    }
     if (ImGui::InputScalarN(getLabelOpaque().data(), ImGuiDataType_Double, _vs.data(), _vs.size(),
                             NULL, NULL, "%.10f", _flags)
         && linked()) {
-      auto &v = ref().getRef();
-      auto h = value();
-      if (h.isList()) {
-        ZsList &list = h.asList();
-        for (int i = 0; i < _vs.size(); ++i) {
-          if (ZsObject v = zs_float_obj_double(_vs[i]); list.setItemSteal(i, v) == -1)
-            Py_DECREF(v.handle());
-        }
-      } else {
-        assert(_vs.size() == 1);
-        switch (h._idx) {
-          case zs_var_type_f64:
-            v._v.f64 = _vs[0];
-          case zs_var_type_f32:
-            v._v.f32 = _vs[0];
-          case zs_var_type_object:
-            ref() = zs_float_obj_double(_vs[0]);
-          default:;
-        }
-      }
+      for (size_t i = 0; i != _vs.size(); ++i) storeValue(i);
+      _widths.reset();
     }
   }
 
@@ -490,6 +611,9 @@ namespace zs::ui {
     return match([](std::monostate) { return false; },
                  [&obj](auto &widget) { return widget.link(obj); })(_widget);
   }
+  void GenericResourceWidget::markDirty() {
+    match([](std::monostate) {}, [](auto &widget) { widget.markDirty(); })(_widget);
+  }
   float GenericResourceWidget::preferredWidth() const {
     return match([](std::monostate) { return 0.f; },
                  [](auto &widget) { return widget.preferredWidth(); })(_widget);
@@ -539,6 +663,11 @@ namespace zs::ui {
                         typeStr.asString().c_str()));
       }
   }
+  void GenericAttribWidget::markDirty() {
+    for (auto &section : _sections)
+      for (auto &widget : section._widgets)
+        match([](std::monostate) {}, [](auto &widget) { widget.markDirty(); })(widget);
+  }
   void GenericAttribWidget::draw() {
     bool openTabBar = _hasTabSection && ImGui::BeginTabBar("TabBar");
     for (auto &section : _sections) {
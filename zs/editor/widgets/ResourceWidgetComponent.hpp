@@ -51,6 +51,8 @@ template <typename Derived> struct ResourceWidgetInterface {
   template <typename F> int injectCustomBehavior(ZsValue loc, F &&f) {
     return self().do_injectCustomBehavior(loc, FWD(f));
   }
+  /// @note signals that the bound resource has been modified elsewhere
+  void markDirty() { self().do_markDirty(); }
 
   // it is safer to share the ownership without much extra storage cost,
   // but the widget itself is expected to be removed not so long after the
@@ -64,6 +66,7 @@ template <typename Derived> struct ResourceWidgetInterface {
 protected:
   float do_preferredWidth() const { return 0.f; }
   int do_injectCustomBehavior(...) { return 0; }
+  void do_markDirty() {}
 
 private:
   auto &self() noexcept { return static_cast<Derived &>(*this); }
@@ -93,11 +96,19 @@ struct TrivialValueDisplay : ResourceWidgetInterface<TrivialValueDisplay> {
   TrivialValueDisplay(std::string_view label, ZsVar &obj) { link(obj); }
 };
 
+///
+/// @note the displayed string is cached, since producing it takes the GIL and
+/// calls into python. It is only refreshed upon markDirty(), when the bound
+/// object is replaced, when the widget becomes visible again, or every
+/// s_refresh_interval seconds, which catches the edits nobody signals.
+///
 struct PyDisplay : ResourceWidgetInterface<PyDisplay> {
+  static constexpr double s_refresh_interval = 1.;
   static bool is_compatible(ZsValue obj) { return obj.isObject(); }
 
   float do_preferredWidth() const;
   void do_draw();
+  void do_markDirty() noexcept { _dirty = true; }
 
   PyDisplay(std::string_view label, ZsVar &obj) {
     _label = label;
@@ -109,16 +120,68 @@ struct PyDisplay : ResourceWidgetInterface<PyDisplay> {
   void updateStr();
 
   std::string _str;
+  mutable float _strWidth{-1.f}; // of _str, negative if not yet evaluated
+  const void *_strHandle{nullptr}; // the object _str is produced from
+  double _lastRefreshTime{0.};
+  int _lastDrawFrame{-1};
+  bool _dirty{false};
+};
+
+///
+/// @note text widths of the elements of a list widget, only re-measured when
+/// the elements change
+///
+struct ListTextWidths {
+  /// @note [measure(i)] evaluates the width of the i-th element
+  template <typename F> float maxWidth(size_t n, F &&measure) {
+    if (_widths.size() != n) {
+      _widths.resize(n);
+      for (size_t i = 0; i != n; ++i)
+        _widths[i] = measure(i);
+      _max = -1.f;
+    }
+    if (_max < 0.f) {
+      _max = 0.f;
+      for (auto w : _widths)
+        if (w > _max)
+          _max = w;
+    }
+    return _max;
+  }
+  template <typename F> void update(size_t i, F &&measure) {
+    if (i >= _widths.size())
+      return;
+    const float prev = _widths[i];
+    const float w = _widths[i] = measure(i);
+    if (_max < 0.f)
+      return; // to be re-evaluated anyway
+    if (w >= _max)
+      _max = w;
+    else if (prev >= _max)
+      _max = -1.f; // the widest one shrinks
+  }
+  void reset() noexcept {
+    _widths.clear();
+    _max = -1.f;
+  }
+
+  std::vector<float> _widths;
+  float _max{-1.f};
 };
 
 ///
 /// @note edit
+/// @note lists longer than s_inline_limit are edited row by row within a
+/// scrollable child, where only the visible rows are submitted
 ///
 struct IntegerList : ResourceWidgetInterface<IntegerList> {
+  static constexpr size_t s_inline_limit = 16;
+  static constexpr size_t s_max_visible_rows = 8;
   static bool is_compatible(ZsValue obj);
 
   float do_preferredWidth() const;
   void do_draw();
+  void do_markDirty() { loadValues(); }
 
   IntegerList(std::string_view label, ZsVar &obj) {
     link(obj);
@@ -126,42 +189,28 @@ struct IntegerList : ResourceWidgetInterface<IntegerList> {
     _label = label;
     _flags = // ImGuiInputTextFlags_EnterReturnsTrue |
         ImGuiInputTextFlags_AutoSelectAll;
-    auto h = obj.getValue();
-    if (h.isList()) {
-      ZsList &l = h.asList();
-      _vs.resize(l.size());
-      int i = 0;
-      for (auto e : l)
-        _vs[i++] = static_cast<long long>(e);
-    } else {
-      _vs.resize(1);
-      switch (h._idx) {
-      case zs_var_type_object:
-        _vs[0] = static_cast<long long>(h);
-        break;
-      case zs_var_type_i64:
-        _vs[0] = h._v.i64;
-        break;
-      case zs_var_type_i32:
-        _vs[0] = h._v.i32;
-        break;
-      case zs_var_type_i8:
-        _vs[0] = h._v.i8;
-        break;
-      default:;
-      }
-    }
+    loadValues();
   }
 
+  /// @note pull the elements from the bound resource
+  void loadValues();
+  /// @note push the i-th element to the bound resource
+  void storeValue(size_t i);
+  float elementWidth(size_t i) const;
+
   std::vector<i64> _vs{0};
   ImGuiInputTextFlags _flags;
+  mutable ListTextWidths _widths;
 };
 
 struct FloatingPointList : ResourceWidgetInterface<FloatingPointList> {
+  static constexpr size_t s_inline_limit = 16;
+  static constexpr size_t s_max_visible_rows = 8;
   static bool is_compatible(ZsValue obj);
 
   float do_preferredWidth() const;
   void do_draw();
+  void do_markDirty() { loadValues(); }
 
   FloatingPointList(std::string_view label, ZsVar &obj) {
     link(obj);
@@ -169,32 +218,18 @@ struct FloatingPointList : ResourceWidgetInterface<FloatingPointList> {
     _label = label;
     _flags = // ImGuiInputTextFlags_EnterReturnsTrue |
         ImGuiInputTextFlags_AutoSelectAll;
-    auto h = obj.getValue();
-    if (h.isList()) {
-      ZsList &l = h.asList();
-      _vs.resize(l.size());
-      int i = 0;
-      for (auto e : l)
-        _vs[i++] = static_cast<double>(e);
-    } else {
-      _vs.resize(1);
-      switch (h._idx) {
-      case zs_var_type_object:
-        _vs[0] = static_cast<double>(h);
-        break;
-      case zs_var_type_f64:
-        _vs[0] = h._v.f64;
-        break;
-      case zs_var_type_f32:
-        _vs[0] = h._v.f32;
-        break;
-      default:;
-      }
-    }
+    loadValues();
   }
 
+  /// @note pull the elements from the bound resource
+  void loadValues();
+  /// @note push the i-th element to the bound resource
+  void storeValue(size_t i);
+  float elementWidth(size_t i) const;
+
   std::vector<double> _vs{0.};
   ImGuiInputTextFlags _flags;
+  mutable ListTextWidths _widths;
 };
 
 struct String : ResourceWidgetInterface<String> {
@@ -307,6 +342,7 @@ struct GenericResourceWidget {
   float preferredWidth() const;
 
   bool link(ZsVar &obj);
+  void markDirty();
 
   template <typename F> int injectCustomBehavior(ZsValue loc, F &&f) {
     return std::visit(
@@ -367,6 +403,8 @@ struct GenericAttribWidget {
   }
 
   void draw();
+  /// @note the bound resources have been modified elsewhere
+  void markDirty();
 
   operator bool() const { return _sections.size(); }
 
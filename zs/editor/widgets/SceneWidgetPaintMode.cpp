@@ -86,6 +86,16 @@ namespace zs {
     ImDrawList *drawList = ImGui::GetWindowDrawList();
     drawList->ChannelsSetCurrent(_interaction);
 
+    /// @note stroke history is replayed by the render stage
+    if (!_painting) {
+      if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiKey_Z, ImGuiInputFlags_Repeat))
+        editor.scenePaintHistory.requestedStep = -1;
+      else if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiKey_Y, ImGuiInputFlags_Repeat)
+               || ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiMod_Shift | ImGuiKey_Z,
+                                  ImGuiInputFlags_Repeat))
+        editor.scenePaintHistory.requestedStep = 1;
+    }
+
     /// selection
     if (_painterCenter.has_value()) {
       auto c = *_painterCenter;
@@ -1,5 +1,6 @@
 #include "SequencerComponent.hpp"
 
+#include <cmath>
 #include <cstdio>
 
 #include "world/system/ResourceSystem.hpp"
@@ -95,28 +96,36 @@ namespace zs {
       if (ImGui::Button((const char*)ICON_MD_STOP)) {
         _playStatus = false;
       } else {
-        auto curTime = getCurrentTime();
-        if (!zs_resources().vis_prims_ready())
-          _lastTime = curTime;
-        else {
-          if (auto interval = curTime - _lastTime; interval > getCurrentTimeCodeInterval()) {
-            auto ctx = zs_resources().get_scene_context_ptr(_sceneLabel);
-            if (ctx) {
-              auto curTc = ctx->getCurrentTimeCode();
-              _timecode = curTc + 1;
-              if (_timecode > _end + detail::deduce_numeric_epsilon<float>()) _timecode = _start;
-              onTimeCodeChanged().emit(static_cast<TimeCode>(_timecode));
-            }
-            _lastTime = curTime;
+        if (auto ctx = zs_resources().get_scene_context_ptr(_sceneLabel)) {
+          TimeCode next;
+          if (_governor.advance(getCurrentTime(), zs_resources().vis_prims_ready(),
+                                ctx->getCurrentTimeCode(), _start, _end,
+                                getCurrentTimeCodeInterval(), next)) {
+            _timecode = static_cast<TimeCodeIndex>(next);
+            onTimeCodeChanged().emit(next);
           }
         }
       }
     } else {
       if (ImGui::Button((const char*)ICON_MD_PLAY_CIRCLE_OUTLINE)) {
         _playStatus = true;
-        _lastTime = getCurrentTime();
+        _governor.start(getCurrentTime());
       }
     }
+    // playback pacing
+    ImGui::SameLine();
+    bool everyFrame = _governor.mode() == PlaybackGovernor::every_frame;
+    if (ImGui::Checkbox((const char*)u8"逐帧", &everyFrame))
+      _governor.setMode(everyFrame ? PlaybackGovernor::every_frame
+                                   : PlaybackGovernor::real_time);
+    if (ImGui::IsItemHovered())
+      ImGui::SetTooltip("present every time code instead of keeping up with the wall clock");
+    if (_playStatus) {
+      ImGui::SameLine();
+      ImGui::TextDisabled("%.1f / %.1f, %llu dropped", _governor.effectiveRate(getCurrentTime()),
+                          1000. / getCurrentTimeCodeInterval(),
+                          (unsigned long long)_governor.numDropped());
+    }
     // discrete
     ImGui::Checkbox((const char*)u8"连续", &_continuous);
     ImGui::SameLine();
@@ -3,6 +3,7 @@
 #include "world/core/Signal.hpp"
 // #include "../world/async/Coro.hpp"
 #include "world/scene/Timeline.hpp"
+#include "SequencerPlayback.hpp"
 #include "WidgetComponent.hpp"
 #include "imgui.h"
 #include "zensim/ui/Widget.hpp"
@@ -31,7 +32,7 @@ namespace zs {
     void *_sceneCtx;
 
     bool _playStatus{false};  // play or pause
-    double _lastTime;
+    PlaybackGovernor _governor;
     Signal<void(TimeCode)> _timecodeChanged;
     TimeCodeIndex _timecode{0}, _iStart{0}, _iEnd{0};
     // closed range
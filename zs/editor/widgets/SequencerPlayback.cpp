@@ -0,0 +1,71 @@
+#include "SequencerPlayback.hpp"
+
+#include <cmath>
+
+namespace zs {
+
+  ///
+  /// PlaybackGovernor
+  ///
+  void PlaybackGovernor::setMode(mode_e mode) noexcept {
+    if (_mode == mode) return;
+    _mode = mode;
+    /// @note re-anchor upon the next advance
+    _anchorTc = std::numeric_limits<TimeCode>::quiet_NaN();
+  }
+
+  void PlaybackGovernor::start(double now) noexcept {
+    _anchorTime = _lastTime = _startTime = now;
+    _anchorTc = _lastPresented = std::numeric_limits<TimeCode>::quiet_NaN();
+    _numPresented = _numDropped = 0;
+  }
+
+  bool PlaybackGovernor::advance(double now, bool ready, TimeCode current, TimeCode start,
+                                 TimeCode end, double interval, TimeCode &next) noexcept {
+    if (std::isnan(current) || std::isnan(start) || std::isnan(end) || end < start
+        || !(interval > 0.))
+      return false;
+    /// @note (re)anchor at the current time code, e.g. after the playhead being scrubbed
+    if (std::isnan(_anchorTc) || (!std::isnan(_lastPresented) && current != _lastPresented)) {
+      _anchorTc = _lastDue = _lastPresented = current;
+      _anchorTime = _lastTime = now;
+    }
+    if (!ready) {
+      /// @note the wall clock keeps running in real-time mode, thus the time codes due in the
+      /// meantime are skipped once the evaluation catches up
+      if (_mode == every_frame) _lastTime = now;
+      return false;
+    }
+
+    TimeCode due;
+    if (_mode == every_frame) {
+      if (now - _lastTime <= interval) return false;
+      due = _lastDue + 1;
+    } else {
+      due = _anchorTc + std::floor((now - _anchorTime) / interval);
+      if (due <= _lastDue) return false;
+      _numDropped += (u64)(due - _lastDue - 1);
+    }
+    _lastTime = now;
+    _lastDue = due;
+
+    next = due;
+    if (next > end + std::numeric_limits<float>::epsilon()) {
+      if (_mode == every_frame)
+        /// @note the next loop continues counting from [start]
+        _lastDue = next = start;
+      else
+        next = start + std::fmod(next - start, std::floor(end - start) + 1);
+    }
+    if (next < start) next = start;
+    _lastPresented = next;
+    _numPresented++;
+    return true;
+  }
+
+  double PlaybackGovernor::effectiveRate(double now) const noexcept {
+    const double elapsed = now - _startTime;
+    return elapsed > 0. ? _numPresented * 1000. / elapsed : 0.;
+  }
+
+}  // namespace zs
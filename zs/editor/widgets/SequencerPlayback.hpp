@@ -0,0 +1,43 @@
+#pragma once
+
+#include <limits>
+
+#include "world/scene/Timeline.hpp"
+#include "zensim/TypeAlias.hpp"
+
+namespace zs {
+
+  ///
+  /// @brief decides which time code to present next during playback
+  /// @note in real-time mode the presented time code follows the wall clock (anchored at the
+  /// start of playback), thus the time codes that could not be presented in time are skipped
+  /// (dropped). In every-frame mode each time code is presented, at most at the target rate.
+  ///
+  struct PlaybackGovernor {
+    enum mode_e : u8 { real_time = 0, every_frame };
+
+    void setMode(mode_e mode) noexcept;
+    mode_e mode() const noexcept { return _mode; }
+    /// @note [now] in milliseconds, also resets the statistics
+    void start(double now) noexcept;
+    /// @note [ready]: whether the currently presented time code is done evaluating,
+    /// [interval]: milliseconds per time code. Returns true if [next] should be presented.
+    bool advance(double now, bool ready, TimeCode current, TimeCode start, TimeCode end,
+                 double interval, TimeCode &next) noexcept;
+
+    u64 numPresented() const noexcept { return _numPresented; }
+    u64 numDropped() const noexcept { return _numDropped; }
+    /// @note presented time codes per second since start()
+    double effectiveRate(double now) const noexcept;
+
+  protected:
+    mode_e _mode{real_time};
+    double _anchorTime{0.}, _lastTime{0.}, _startTime{0.};
+    /// @note _lastDue is the last due time code, in real-time mode before wrapping into the
+    /// playback range
+    TimeCode _anchorTc{std::numeric_limits<TimeCode>::quiet_NaN()}, _lastDue{0};
+    TimeCode _lastPresented{std::numeric_limits<TimeCode>::quiet_NaN()};
+    u64 _numPresented{0}, _numDropped{0};
+  };
+
+}  // namespace zs
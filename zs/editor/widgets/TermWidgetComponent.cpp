@@ -4,6 +4,8 @@
 //
 #include <Python.h>
 
+#include <algorithm>
+#include <cassert>
 #include <sstream>
 
 #include "IconsMaterialDesign.h"
@@ -18,16 +20,41 @@
 
 namespace zs {
 
+  ///
+  /// EditorLogLock
+  ///
+  namespace {
+    std::mutex g_editorLogMutex;
+    /// @note number of ResourceSystem log entries when the lock was last released, unknown
+    /// before the first acquisition (entries logged during start-up, prior to any concurrency)
+    size_t g_numLockedLogs = ~(size_t)0;
+  }  // namespace
+
+  EditorLogLock::EditorLogLock() : _lock{g_editorLogMutex} {
+    assert((g_numLockedLogs == ~(size_t)0 || ResourceSystem::ref_logs().size() == g_numLockedLogs)
+           && "log entries pushed to ResourceSystem without lock_editor_logs()");
+  }
+  EditorLogLock::~EditorLogLock() { g_numLockedLogs = ResourceSystem::ref_logs().size(); }
+
   Terminal::Terminal()
       : _inputBuf(),
-        _textSelect{[this](size_t idx) -> std::string_view { return _arrangedItems[idx]; },
-                    [this]() -> size_t { return _arrangedItems.size(); }},
+        _textSelect{[this](size_t idx) -> std::string_view { return arrangedLine(idx); },
+                    [this]() -> size_t { return numArrangedLines(); }},
+        _logStore{ResourceSystem::get_log_entry_limit()},
+        _spilledBegin{0},
+        _arrangedBegin{0},
+        _arrangedSeq{0},
+        _arrangedWrapWidth{0.f},
+        _arrangedCharWidth{0.f},
         _historyLimit{128},
         _historyPos{-1},
+        _numExecuted{0},
+        _regexFilter{false},
+        _regexValid{true},
+        _severityMask{~(u32)0},
         _scrollToBottom{false},
         _focusInput{true},
         _requestExit{false} {
-    _arrangedItems.reserve(ResourceSystem::get_log_entry_limit());
     _inputBuf.reserve(256);
     _commands.emplace_back("help", "display terminal command helper info.");
     _commands.emplace_back("hello", "hello.");
@@ -65,13 +92,18 @@ namespace zs {
       ResourceSystem::start_cstream_capture();
       int result_ = 0;
       ZsValue ret = zs_execute_statement(cmdStr.c_str(), &result_);
+      _numExecuted++;
       ConsoleRecord::type_e result = result_ == 0 ? ConsoleRecord::info : ConsoleRecord::error;
-      ResourceSystem::dump_cstream_capture();
+      {
+        auto lk = lock_editor_logs();
+        ResourceSystem::dump_cstream_capture();
+      }
 
       PyGILState_STATE gstate = PyGILState_Ensure();
       {
         /// involes python capi calling, require GIL
         PyVar resultPyBytes = ret;
+        auto lk = lock_editor_logs();
         if (resultPyBytes) {
           auto cstr = resultPyBytes.asBytes().c_str();
           ResourceSystem::push_assembled_log(cstr, result);
@@ -85,18 +117,267 @@ namespace zs {
     }
   }
 
+  static ImVec4 log_type_color(ConsoleRecord::type_e type) {
+    if (type == 0)
+      return ImVec4(0.675f, 0.84f, 0.9f, 1.0f);
+    else if (type == 2)
+      return ImVec4(1.f, 0.49f, 0.49f, 1.0f);
+    return ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+  }
+
+  void Terminal::arrangeEntry(std::deque<ArrangedLine> &lines, u64 seq, std::string_view item,
+                              ConsoleRecord::type_e type, float wrapWidth, u32 evaledNumChars) {
+    auto pushLine = [&lines, seq, type, base = item.data()](const char *st, const char *ed) {
+      lines.push_back(ArrangedLine{seq, (u32)(st - base), (u32)(ed - st), type});
+    };
+    auto itemWidth = ImGui::CalcTextSize(item.data(), item.data() + item.size()).x;
+    if (itemWidth < wrapWidth || evaledNumChars <= 1) {
+      pushLine(item.data(), item.data() + item.size());
+      return;
+    }
+    const char *st = item.data();
+    const char *fin = item.data() + item.size();
+    do {
+      const char *ed = st;
+      u32 numSteppedChars = std::min((u32)(fin - st), evaledNumChars);
+      utf8::unchecked::advance(ed, numSteppedChars);
+      float curLineWidth = 0.f;
+      while (ed > st && (curLineWidth = ImGui::CalcTextSize(st, ed).x) >= wrapWidth)
+        utf8::unchecked::advance(ed, -1);
+      /// @note always make progress, even if a single glyph is wider than the view
+      if (ed == st) {
+        utf8::unchecked::advance(ed, 1);
+        curLineWidth = ImGui::CalcTextSize(st, ed).x;
+      }
+
+      pushLine(st, ed);
+
+      st = ed;
+      itemWidth -= curLineWidth;
+    } while (itemWidth >= wrapWidth && st < fin);
+    pushLine(st, fin);
+  }
+
+  void Terminal::ingestLogs() {
+    /// @note drained as a whole every frame under the lock, thus no entry is pushed in between,
+    /// nor evicted by ResourceSystem (beyond its entry limit) before being moved into _logStore
+    auto lk = lock_editor_logs();
+    auto &logs = ResourceSystem::ref_logs();
+    if (logs.size() == 0) return;
+    for (const auto &item : logs) {
+      const auto type = static_cast<ConsoleRecord::type_e>(item.type);
+      const std::string_view text{item.c_str(), item.size()};
+      _logIndex.append(_logStore.append(text, type), text, type);
+    }
+    ResourceSystem::clear_logs();
+  }
+
+  void Terminal::clearLogs() {
+    {
+      auto lk = lock_editor_logs();
+      ResourceSystem::clear_logs();
+    }
+    _logStore.clear();
+    _logIndex.clear();
+    invalidateArrangement();
+  }
+
+  void Terminal::updateLogFilter() {
+    _regexValid = true;
+    if (_regexFilter && _filter.IsActive()) {
+      try {
+        _regex = std::regex(_filter.InputBuf, std::regex::ECMAScript | std::regex::icase
+                                                  | std::regex::optimize);
+      } catch (const std::regex_error &) {
+        /// @note keep showing everything while the pattern is being typed
+        _regexValid = false;
+      }
+    }
+    invalidateArrangement();
+  }
+
+  bool Terminal::passLogFilter(std::string_view text, ConsoleRecord::type_e type) const {
+    if (!(_severityMask & TermLogIndex::type_bit(type))) return false;
+    if (_regexFilter) {
+      if (!_regexValid || !_filter.IsActive()) return true;
+      return std::regex_search(text.begin(), text.end(), _regex);
+    }
+    return _filter.PassFilter(text.data(), text.data() + text.size());
+  }
+
+  bool Terminal::logFilterCandidates(u32 fromPage, TermLogIndex::PageList &pages) const {
+    bool restricted = false;
+    if (_regexFilter) {
+      if (_regexValid && _filter.IsActive())
+        restricted = _logIndex.candidatePagesAll(
+            TermLogIndex::regex_required_literals(_filter.InputBuf), pages);
+    } else if (_filter.IsActive()) {
+      /// @note ImGuiTextFilter passes an entry if any inclusive term (one not prefixed by '-')
+      /// matches, exclusive terms can not narrow down the search
+      std::vector<std::string> terms;
+      for (const auto &range : _filter.Filters)
+        if (!range.empty() && range.b[0] != '-') terms.emplace_back(range.b, range.e);
+      restricted = _logIndex.candidatePagesAny(terms, pages);
+    }
+    /// @note the pages no longer indexed may hold anything
+    if (restricted && fromPage < _logIndex.firstPage()) {
+      TermLogIndex::PageList unindexed(_logIndex.firstPage() - fromPage);
+      for (u32 i = 0; i != unindexed.size(); ++i) unindexed[i] = fromPage + i;
+      pages.insert(std::begin(pages), std::begin(unindexed), std::end(unindexed));
+    }
+    if (_severityMask != ~(u32)0) {
+      if (!restricted) {
+        pages.resize(_logIndex.numPages() > fromPage ? _logIndex.numPages() - fromPage : 0);
+        for (u32 i = 0; i != pages.size(); ++i) pages[i] = fromPage + i;
+        restricted = true;
+      }
+      pages.erase(std::remove_if(std::begin(pages), std::end(pages),
+                                 [this](u32 page) {
+                                   return !(_logIndex.pageTypeMask(page) & _severityMask);
+                                 }),
+                  std::end(pages));
+    }
+    return restricted;
+  }
+
+  void Terminal::arrangeLogs(float wrapWidth) {
+    ingestLogs();
+
+    const auto charWidth = ImGui::CalcTextSize(" ").x;
+    /// @note relayout all upon view width/ font changes
+    if (wrapWidth != _arrangedWrapWidth || charWidth != _arrangedCharWidth
+        || _arrangedSeq > _logStore.endSeq())
+      invalidateArrangement();
+    _arrangedWrapWidth = wrapWidth;
+    _arrangedCharWidth = charWidth;
+
+    /// @note entries spilled meanwhile leave the resident window, their lines are kept only if
+    /// the older entries are being browsed
+    const u64 residentBegin = _logStore.memBegin();
+    if (_arrangedBegin < residentBegin) {
+      const bool browsing = _spilledBegin != _arrangedBegin;
+      while (!_arrangedItems.empty() && _arrangedItems.front()._seq < residentBegin) {
+        if (browsing) _spilledItems.push_back(_arrangedItems.front());
+        _arrangedItems.pop_front();
+      }
+      if (!browsing) _spilledBegin = residentBegin;
+      _arrangedBegin = residentBegin;
+      while (_spilledItems.size() > s_max_spilled_lines) {
+        _spilledBegin = _spilledItems.front()._seq + 1;
+        while (!_spilledItems.empty() && _spilledItems.front()._seq < _spilledBegin)
+          _spilledItems.pop_front();
+      }
+    }
+    if (_arrangedSeq < _arrangedBegin) _arrangedSeq = _arrangedBegin;
+    /// @note entries dropped by the store (only if spilling to disk is unavailable)
+    const u64 beginSeq = _logStore.beginSeq();
+    while (!_spilledItems.empty() && _spilledItems.front()._seq < beginSeq)
+      _spilledItems.pop_front();
+    if (_spilledBegin < beginSeq) _spilledBegin = beginSeq;
+    _logIndex.prune((u32)(beginSeq >> TermLogIndex::s_page_bits));
+
+    const u32 evaledNumChars = (u32)std::ceil(wrapWidth / charWidth);
+    auto arrange = [&](u64 seq, std::string_view text, ConsoleRecord::type_e type) {
+      if (passLogFilter(text, type))
+        arrangeEntry(_arrangedItems, seq, text, type, wrapWidth, evaledNumChars);
+    };
+    const u64 endSeq = _logStore.endSeq();
+    TermLogIndex::PageList pages;
+    /// @note a full relayout under an active filter only visits the pages the index deems
+    /// possible to match, rather than scanning the whole resident window
+    if (_arrangedSeq == _arrangedBegin && _arrangedSeq != endSeq
+        && logFilterCandidates((u32)(_arrangedBegin >> TermLogStore::s_page_bits), pages)) {
+      for (u32 page : pages) {
+        const u64 st = std::max((u64)page << TermLogStore::s_page_bits, _arrangedBegin);
+        const u64 ed = std::min((u64)(page + 1) << TermLogStore::s_page_bits, endSeq);
+        for (u64 seq = st; seq < ed; ++seq) {
+          const auto &rec = _logStore.get(seq);
+          arrange(seq, rec._text, rec._type);
+        }
+      }
+    } else
+      _logStore.forEach(_arrangedSeq, arrange);
+    _arrangedSeq = endSeq;
+
+    if (hasOlderLogs())
+      _olderLogsHint = fmt::format("... {} older entries, scroll up to load ...",
+                                   _spilledBegin - beginSeq);
+  }
+
+  size_t Terminal::arrangeOlderLogs(u32 maxPages) {
+    const u64 beginSeq = _logStore.beginSeq();
+    const u32 evaledNumChars = (u32)std::ceil(_arrangedWrapWidth / _arrangedCharWidth);
+    TermLogIndex::PageList pages;
+    /// @note only the indexed pages are listed, the older ones are visited one by one
+    const u32 firstIndexedPage = _logIndex.firstPage();
+    const bool restricted = logFilterCandidates(firstIndexedPage, pages);
+    std::deque<ArrangedLine> lines;
+    size_t numLines = 0;
+    for (u32 n = 0; n != maxPages && hasOlderLogs() && _spilledItems.size() < s_max_spilled_lines;
+         ++n) {
+      u64 ed = _spilledBegin;
+      u64 page = (ed - 1) >> TermLogStore::s_page_bits;
+      /// @note skip to the closest preceding page that may hold matches
+      if (restricted && page >= firstIndexedPage) {
+        auto it = std::upper_bound(std::begin(pages), std::end(pages), (u32)page);
+        if (it != std::begin(pages))
+          page = *--it;
+        else if (firstIndexedPage > (beginSeq >> TermLogStore::s_page_bits))
+          page = firstIndexedPage - 1;
+        else {
+          _spilledBegin = beginSeq;
+          break;
+        }
+        ed = std::min(ed, (page + 1) << TermLogStore::s_page_bits);
+      }
+      const u64 st = std::max(page << TermLogStore::s_page_bits, beginSeq);
+      lines.clear();
+      for (u64 seq = st; seq < ed; ++seq) {
+        const auto &rec = _logStore.get(seq);
+        if (passLogFilter(rec._text, rec._type))
+          arrangeEntry(lines, seq, rec._text, rec._type, _arrangedWrapWidth, evaledNumChars);
+      }
+      _spilledItems.insert(std::begin(_spilledItems), std::begin(lines), std::end(lines));
+      numLines += lines.size();
+      _spilledBegin = st;
+    }
+    return numLines;
+  }
+
   void Terminal::paint() {
     ImGui::Separator();
 
     ///
-    _filter.Draw("regex text filter", 180);
+    bool filterChanged = _filter.Draw("text filter", 180);
+    if (_regexFilter && !_regexValid) {
+      ImGui::SameLine();
+      ImGui::TextColored(ImVec4(1.f, 0.49f, 0.49f, 1.0f), "invalid regex");
+    }
+    ImGui::SameLine();
+    filterChanged |= ImGui::Checkbox("regex", &_regexFilter);
+    ImGui::SameLine();
+    {
+      const u32 infoBit = TermLogIndex::type_bit(ConsoleRecord::info);
+      const u32 errorBit = TermLogIndex::type_bit(ConsoleRecord::error);
+      const char *severities[] = {"all", "info", "error", "others"};
+      const u32 severityMasks[] = {~(u32)0, infoBit, errorBit, ~(infoBit | errorBit)};
+      int current = 0;
+      for (int i = 0; i != IM_ARRAYSIZE(severityMasks); ++i)
+        if (_severityMask == severityMasks[i]) current = i;
+      ImGui::SetNextItemWidth(80);
+      if (ImGui::Combo("##severity", &current, severities, IM_ARRAYSIZE(severities))) {
+        _severityMask = severityMasks[current];
+        filterChanged = true;
+      }
+    }
+    if (filterChanged) updateLogFilter();
     ImGui::SameLine();
     bool copyToClipboard = ImGui::SmallButton((const char *)u8"复制");
     ImGui::SameLine();
     bool clearScreenOutput = ImGui::SmallButton((const char *)u8"清屏");
     /// @note delay this op to avoid conflicts with TextSelect
     if (clearScreenOutput) {
-      ResourceSystem::clear_logs();
+      clearLogs();
       addLog("Python Console\n");
     }
     ImGui::Separator();
@@ -116,108 +397,62 @@ namespace zs {
         ImGui::EndPopup();
       }
 
-      // Display every line as a separate entry so we can change their color or
-      // add custom widgets. If you only want raw text you can use
-      // ImGui::TextUnformatted(log.begin(), log.end()); NB- if you have
-      // thousands of entries this approach may be too inefficient and may
-      // require user-side clipping to only process visible items. The clipper
-      // will automatically measure the height of your first item and then
-      // "seek" to display only items in the visible area.
-      // To use the clipper we can replace your standard loop:
-      //      for (int i = 0; i < Items.Size; i++)
-      //   With:
-      //      ImGuiListClipper clipper;
-      //      clipper.Begin(Items.Size);
-      //      while (clipper.Step())
-      //         for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
-      // - That your items are evenly spaced (same height)
-      // - That you have cheap random access to your elements (you can access
-      // them given their index,
-      //   without processing all the ones before)
-      // You cannot this code as-is if a filter is active because it breaks the
-      // 'cheap random-access' property. We would need random-access on the
-      // post-filtered list. A typical application wanting coarse clipping and
-      // filtering may want to pre-compute an array of indices or offsets of
-      // items that passed the filtering test, recomputing this array when user
-      // changes the filter, and appending newly elements as they are inserted.
-      // This is left as a task to the user until we can manage to improve this
-      // example code! If your items are of variable height:
-      // - Split them into same height items would be simpler and facilitate
-      // random-seeking into your list.
-      // - Consider using manual call to IsRectVisible() and skipping extraneous
-      // decoration from your items.
-
       ///
       /// terminal window
       ///
+      /// @note entries are filtered and wrapped incrementally (see arrangeLogs), and only the
+      /// visible lines are submitted through the clipper. Every arranged line shares the same
+      /// height, thus random-access seeking is cheap.
       ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(4, 1));  // Tighten spacing
 
-      if (copyToClipboard) ImGui::LogToClipboard();
-
-      auto wrapWidth = ImGui::GetContentRegionAvail().x;
-      const auto charWidth = ImGui::CalcTextSize(" ").x;
-      const u32 evaledNumChars = (u32)std::ceil(wrapWidth / charWidth);
-      // ImGui::PushTextWrapPos(ImGui::GetCursorPos().x + wrapWidth);
-
-      _arrangedItems.clear();
-      for (auto &item : ResourceSystem::ref_logs()) {
-        if (!_filter.PassFilter(item.c_str())) continue;
+      arrangeLogs(ImGui::GetContentRegionAvail().x);
 
-        // Normally you would store more information in your item than
-        // just a string. (e.g. make Items[] an array of structure,
-        // store color/type etc.)
-        ImVec4 color = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
-        if (item.type == 0)
-          color = ImVec4(0.675f, 0.84f, 0.9f, 1.0f);
-        else if (item.type == 2)
-          color = ImVec4(1.f, 0.49f, 0.49f, 1.0f);
-
-        ImGui::PushStyleColor(ImGuiCol_Text, color);
+      if (copyToClipboard) {
+        std::string text;
+        _logStore.forEach(_logStore.beginSeq(),
+                          [this, &text](u64, std::string_view item, ConsoleRecord::type_e type) {
+                            if (passLogFilter(item, type)) text += item;
+                          });
+        ImGui::SetClipboardText(text.c_str());
+      }
 
-        auto itemWidth = ImGui::CalcTextSize(item.c_str()).x;
-        if (itemWidth < wrapWidth) {
-          _arrangedItems.emplace_back(item.data());
-          ImGui::Spacing();
-          ImGui::TextUnformatted(_arrangedItems.back().data(),
-                                 _arrangedItems.back().data() + _arrangedItems.back().size());
-        } else {
-          const char *st = item.c_str();
-          const char *fin = item.c_str() + item.size();
-          do {
-            const char *ed = st;
-            u32 numSteppedChars = std::min((u32)(fin - st), evaledNumChars);
-            utf8::unchecked::advance(ed, numSteppedChars);
-            float curLineWidth = 0.f;
-            while ((curLineWidth = ImGui::CalcTextSize(st, ed).x) >= wrapWidth)
-              utf8::unchecked::advance(ed, -1);
-
-            _arrangedItems.emplace_back(std::string_view{st, (u32)(ed - st)});
-            ImGui::Spacing();
-            ImGui::TextUnformatted(_arrangedItems.back().data(),
-                                   _arrangedItems.back().data() + _arrangedItems.back().size());
-
-            st = ed;
-            itemWidth -= curLineWidth;
-          } while (itemWidth >= wrapWidth);
-          _arrangedItems.emplace_back(std::string_view{st, (u32)(fin - st)});
+      bool olderLogsVisible = false;
+      float lineHeight = 0.f;
+      ImGuiListClipper clipper;
+      clipper.Begin((int)numArrangedLines());
+      while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+          const auto line = arrangedLine(i);
+          const auto *item = arrangedItem(i);
+          if (item)
+            ImGui::PushStyleColor(ImGuiCol_Text, log_type_color(item->_type));
+          else {
+            ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled));
+            olderLogsVisible = true;
+          }
           ImGui::Spacing();
-          ImGui::TextUnformatted(_arrangedItems.back().data(),
-                                 _arrangedItems.back().data() + _arrangedItems.back().size());
+          ImGui::TextUnformatted(line.data(), line.data() + line.size());
+          ImGui::PopStyleColor();
         }
-
-        ImGui::PopStyleColor();
+        lineHeight = clipper.ItemsHeight;
       }
-      // ImGui::PopTextWrapPos();
-
-      if (copyToClipboard) ImGui::LogFinish();
+      clipper.End();
 
       // Keep up at the bottom of the scroll region if we were already at the
       // bottom at the beginning of the frame. Using a scrollbar or mouse-wheel
       // will take away from the bottom edge.
-      if (_scrollToBottom || ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+      const bool atBottom = ImGui::GetScrollY() >= ImGui::GetScrollMaxY();
+      if (_scrollToBottom || atBottom) {
         ImGui::SetScrollHereY(1.0f);
       }
       _scrollToBottom = false;
+      /// @note older entries are only paged in while their hint row is in view, with the view
+      /// kept in place, and released once back at the bottom
+      if (olderLogsVisible) {
+        if (auto numLines = arrangeOlderLogs(s_spilled_pages_per_frame); numLines && !atBottom)
+          ImGui::SetScrollY(ImGui::GetScrollY() + numLines * lineHeight);
+      } else if (atBottom && _spilledBegin != _arrangedBegin)
+        releaseOlderLogs();
 
       ImGui::PopStyleVar();
 
@@ -1,9 +1,16 @@
 #pragma once
 #include <deque>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <regex>
+#include <unordered_map>
 
+#include "TermWidgetLogIndex.hpp"
 #include "world/system/ResourceSystem.hpp"
 #include "imgui.h"
 #include "utilities/textselect.hpp"
+#include "zensim/ZpcFunction.hpp"
 #include "zensim/ZpcResource.hpp"
 #include "zensim/execution/Concurrency.h"
 #include "zensim/types/ImplPattern.hpp"
@@ -12,6 +19,26 @@
 
 namespace zs {
 
+  ///
+  /// @brief guards the log entries of ResourceSystem
+  /// @note ResourceSystem exposes no lock of its own, and its push_log() takes none. The terminal
+  /// drains and clears the entries under this lock, which is only sound because every producer
+  /// of log entries is editor-side and pushes under it as well (addLog, and the python tasks
+  /// of the terminal and the script editor dumping the captured output on the PyExecSystem
+  /// thread). Anything pushing to ResourceSystem directly breaks this, which is asserted upon
+  /// acquiring the lock: the entry count has to be the one left by the previous holder.
+  ///
+  struct EditorLogLock {
+    EditorLogLock();
+    ~EditorLogLock();
+    EditorLogLock(const EditorLogLock &) = delete;
+    EditorLogLock &operator=(const EditorLogLock &) = delete;
+
+  protected:
+    std::unique_lock<std::mutex> _lock;
+  };
+  inline EditorLogLock lock_editor_logs() { return EditorLogLock{}; }
+
   struct Command {
     Command(std::string_view name, std::string_view descr = "") : _name{name}, _descr{descr} {}
 
@@ -21,6 +48,86 @@ namespace zs {
     std::string _descr;
   };
 
+  ///
+  /// @brief bounded log storage of the terminal
+  /// @note the latest [capacity] entries live in an in-memory ring buffer, older ones are spilled
+  /// to an append-only file (by default a per-instance file in the temp directory, removed upon
+  /// destruction) and paged back in (a page at a time) when accessed again.
+  /// Entries are addressed by a sequence number, which starts from 0 after each clear().
+  ///
+  struct TermLogStore {
+    struct Record {
+      std::string _text;
+      ConsoleRecord::type_e _type;
+    };
+    static constexpr u32 s_page_bits = TermLogIndex::s_page_bits;
+    static constexpr size_t s_page_size = (size_t)1 << s_page_bits;  // records per spill page
+
+    TermLogStore(size_t capacity = (size_t)1 << 16, std::string spillFileName = {},
+                 size_t numCachedPages = 32);
+    ~TermLogStore();
+    TermLogStore(const TermLogStore &) = delete;
+    TermLogStore &operator=(const TermLogStore &) = delete;
+
+    /// @note O(1), except for spilling the evicted (oldest) entry to disk
+    u64 append(std::string_view text, ConsoleRecord::type_e type);
+    void clear();
+    void setCapacity(size_t capacity);
+    size_t capacity() const noexcept { return _ring.size(); }
+
+    /// @note [beginSeq, endSeq) are retrievable, beginSeq is 0 unless spilling is unavailable
+    u64 beginSeq() const noexcept { return _spillFailed ? _memBegin : 0; }
+    u64 endSeq() const noexcept { return _end; }
+    size_t size() const noexcept { return _end - beginSeq(); }
+    /// @note [memBegin, endSeq) are resident in memory
+    u64 memBegin() const noexcept { return _memBegin; }
+    bool inMemory(u64 seq) const noexcept { return seq >= _memBegin && seq < _end; }
+
+    /// @note a reference to a paged-in record stays valid until its page is evicted from the
+    /// page cache (i.e. after [numCachedPages] other pages are accessed)
+    const Record &get(u64 seq);
+    /// @note streams [st, endSeq) sequentially, f(seq, text, type)
+    template <typename F> void forEach(u64 st, F &&f) {
+      if (st < beginSeq()) st = beginSeq();
+      if (st < _memBegin && !_spillFailed) {
+        readSpilled(st, _memBegin, [&f](u64 seq, const Record &rec) {
+          f(seq, std::string_view{rec._text}, rec._type);
+        });
+        st = _memBegin;
+      }
+      for (; st < _end; ++st) {
+        const auto &rec = _ring[st % _ring.size()];
+        f(st, std::string_view{rec._text}, rec._type);
+      }
+    }
+
+    size_t spilledBytes() const noexcept { return _spillBytes; }
+
+  protected:
+    struct Page {
+      u64 _index;
+      std::vector<Record> _records;
+    };
+
+    void spill(u64 seq, const Record &rec);
+    void openSpillFile();
+    void readSpilled(u64 st, u64 ed, const zs::function<void(u64, const Record &)> &f);
+
+    std::vector<Record> _ring;
+    u64 _memBegin, _end;  // [0, _memBegin) on disk, [_memBegin, _end) in the ring
+    /// spill file
+    std::string _spillFileName;
+    std::fstream _spillFile;
+    u64 _spillBytes;
+    std::vector<u64> _pageOffsets;  // file offset of the first record of every page
+    bool _spillFailed;
+    /// page cache (lru)
+    std::list<Page> _pages;
+    std::unordered_map<u64, std::list<Page>::iterator> _pageMap;
+    size_t _numCachedPages;
+    Record _unavailable;
+  };
+
   struct TerminalBackendConcept {
     virtual ~TerminalBackendConcept() = default;
   };
@@ -30,16 +137,41 @@ namespace zs {
     bool _requestExit;
     bool _reclaimFocus, _focusInput;
 
-    /// @note the actual content to be displayed could be accessed through ResourceSystem
-    std::vector<std::string_view> _arrangedItems;
+    /// @note log entries are drained from ResourceSystem into the bounded _logStore
+    TermLogStore _logStore;
+    TermLogIndex _logIndex;
+
+    /// @note a wrapped line of a log entry, the text is resolved through _logStore on demand
+    struct ArrangedLine {
+      u64 _seq;
+      u32 _offset, _length;
+      ConsoleRecord::type_e _type;
+    };
+    static constexpr u32 s_spilled_pages_per_frame = 2;
+    static constexpr size_t s_max_spilled_lines = (size_t)1 << 16;
+    /// @note lines of the resident entries [_arrangedBegin, _arrangedSeq), only new log entries
+    /// are filtered and wrapped each frame
+    std::deque<ArrangedLine> _arrangedItems;
+    /// @note lines of the spilled entries [_spilledBegin, _arrangedBegin), laid out a few pages
+    /// per frame once scrolled to, and released when back at the bottom
+    std::deque<ArrangedLine> _spilledItems;
+    u64 _spilledBegin, _arrangedBegin, _arrangedSeq;
+    float _arrangedWrapWidth, _arrangedCharWidth;
+    std::string _olderLogsHint;
 
     std::vector<Command> _commands;
 
     std::deque<std::string> _history;
     u32 _historyLimit;
     int _historyPos;
+    /// @note statements executed so far, each might have modified python objects in place
+    u64 _numExecuted;
 
+    /// @note the filter text is taken as an (icase) ECMAScript regex if _regexFilter is set
     ImGuiTextFilter _filter;
+    bool _regexFilter, _regexValid;
+    std::regex _regex;
+    u32 _severityMask;  // TermLogIndex::type_bit of the displayed entry types
     TextSelect _textSelect;
 
     bool _scrollToBottom;
@@ -50,6 +182,7 @@ namespace zs {
     ~Terminal();
 
     void addLog(std::string_view msg, ConsoleRecord::type_e type = ConsoleRecord::unknown) {
+      auto lk = lock_editor_logs();
       ResourceSystem::push_log(msg, type);
     }
 
@@ -57,6 +190,54 @@ namespace zs {
     void executeCommand(std::string_view cmd);
 
   protected:
+    void invalidateArrangement() noexcept {
+      _arrangedItems.clear();
+      _spilledItems.clear();
+      _spilledBegin = _arrangedBegin = _arrangedSeq = 0;
+    }
+    /// @note whether spilled entries precede the arranged lines, shown as a hint row on top
+    bool hasOlderLogs() const noexcept { return _spilledBegin > _logStore.beginSeq(); }
+    size_t numArrangedLines() const noexcept {
+      return (size_t)hasOlderLogs() + _spilledItems.size() + _arrangedItems.size();
+    }
+    /// @note nullptr for the hint row of the older entries
+    const ArrangedLine *arrangedItem(size_t idx) const noexcept {
+      if (hasOlderLogs()) {
+        if (idx == 0) return nullptr;
+        --idx;
+      }
+      if (idx < _spilledItems.size()) return zs::addressof(_spilledItems[idx]);
+      return zs::addressof(_arrangedItems[idx - _spilledItems.size()]);
+    }
+    std::string_view arrangedLine(size_t idx) {
+      const auto *line = arrangedItem(idx);
+      if (!line) return _olderLogsHint;
+      std::string_view text = _logStore.get(line->_seq)._text;
+      if (line->_offset >= text.size()) return {};
+      return text.substr(line->_offset, line->_length);
+    }
+    void clearLogs();
+    /// @note move new entries of ResourceSystem into _logStore
+    void ingestLogs();
+    /// @note filter and wrap the resident log entries that have not been arranged yet
+    void arrangeLogs(float wrapWidth);
+    /// @note filter and wrap (at most [maxPages] pages of) the spilled entries preceding
+    /// _spilledBegin, returns the number of prepended lines
+    size_t arrangeOlderLogs(u32 maxPages);
+    /// @note drop the lines of the spilled entries
+    void releaseOlderLogs() noexcept {
+      _spilledItems.clear();
+      _spilledBegin = _arrangedBegin;
+    }
+    /// @note rebuild the regex (if enabled) and relayout
+    void updateLogFilter();
+    bool passLogFilter(std::string_view text, ConsoleRecord::type_e type) const;
+    /// @note returns false if the current filter can not be narrowed down through _logIndex,
+    /// the pages no longer indexed are listed from [fromPage] on
+    bool logFilterCandidates(u32 fromPage, TermLogIndex::PageList &pages) const;
+    void arrangeEntry(std::deque<ArrangedLine> &lines, u64 seq, std::string_view item,
+                      ConsoleRecord::type_e type, float wrapWidth, u32 evaledNumChars);
+
     static int s_input_text_callback(ImGuiInputTextCallbackData *data) {
       return static_cast<Terminal *>(data->UserData)->inputTextCallback(data);
     }
@@ -0,0 +1,212 @@
+#include "TermWidgetLogIndex.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace zs {
+
+  static char index_fold_case(char c) noexcept {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+  }
+
+  u32 TermLogIndex::trigram_key(const char *p) noexcept {
+    return ((u32)(u8)index_fold_case(p[0]) << 16) | ((u32)(u8)index_fold_case(p[1]) << 8)
+           | (u32)(u8)index_fold_case(p[2]);
+  }
+
+  void TermLogIndex::append(u64 seq, std::string_view text, u32 type) {
+    const u32 page = (u32)(seq >> s_page_bits);
+    if (page < _firstPage) return;
+    if (page >= numPages()) {
+      _pageTypeMasks.resize(page - _firstPage + 1, 0);
+      /// @note keep at most 1.25x [_maxPages] pages, so that dropping is amortized
+      if (numPages() - _firstPage > _maxPages + _maxPages / 4) dropPages(numPages() - _maxPages);
+    }
+    _pageTypeMasks[page - _firstPage] |= type_bit(type);
+    /// @note entries arrive in seq order, thus a page is recorded at most once per trigram
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+      auto &postings = _postings[trigram_key(text.data() + i)];
+      if (postings.empty() || postings.back() != page) {
+        postings.push_back(page);
+        _numPostings++;
+      }
+    }
+  }
+
+  void TermLogIndex::clear() {
+    _postings.clear();
+    _pageTypeMasks.clear();
+    _firstPage = 0;
+    _numPostings = 0;
+  }
+
+  void TermLogIndex::prune(u32 firstPage) {
+    if (firstPage >= _firstPage + std::max(_maxPages / 4, (u32)1)) dropPages(firstPage);
+  }
+
+  void TermLogIndex::dropPages(u32 firstPage) {
+    if (firstPage <= _firstPage) return;
+    for (auto it = std::begin(_postings); it != std::end(_postings);) {
+      auto &postings = it->second;
+      auto ed = std::lower_bound(std::begin(postings), std::end(postings), firstPage);
+      _numPostings -= (size_t)(ed - std::begin(postings));
+      postings.erase(std::begin(postings), ed);
+      if (postings.empty())
+        it = _postings.erase(it);
+      else
+        ++it;
+    }
+    const size_t numDropped = std::min((size_t)(firstPage - _firstPage), _pageTypeMasks.size());
+    _pageTypeMasks.erase(std::begin(_pageTypeMasks), std::begin(_pageTypeMasks) + numDropped);
+    _firstPage = firstPage;
+  }
+
+  bool TermLogIndex::candidatePages(std::string_view literal, PageList &pages) const {
+    pages.clear();
+    if (literal.size() < 3) return false;
+    std::vector<const PageList *> lists;
+    lists.reserve(literal.size() - 2);
+    for (size_t i = 0; i + 3 <= literal.size(); ++i) {
+      auto it = _postings.find(trigram_key(literal.data() + i));
+      /// @note an absent trigram rules out every page
+      if (it == _postings.end()) return true;
+      lists.push_back(std::addressof(it->second));
+    }
+    /// @note intersect from the most selective list onwards
+    std::sort(std::begin(lists), std::end(lists),
+              [](const PageList *a, const PageList *b) { return a->size() < b->size(); });
+    lists.erase(std::unique(std::begin(lists), std::end(lists)), std::end(lists));
+    pages = *lists[0];
+    PageList tmp;
+    for (size_t i = 1; i < lists.size() && !pages.empty(); ++i) {
+      tmp.clear();
+      std::set_intersection(std::begin(pages), std::end(pages), std::begin(*lists[i]),
+                            std::end(*lists[i]), std::back_inserter(tmp));
+      std::swap(pages, tmp);
+    }
+    return true;
+  }
+
+  bool TermLogIndex::candidatePagesAll(const std::vector<std::string> &literals,
+                                       PageList &pages) const {
+    pages.clear();
+    bool restricted = false;
+    PageList cur, tmp;
+    for (const auto &literal : literals) {
+      if (!candidatePages(literal, cur)) continue;
+      if (!restricted) {
+        std::swap(pages, cur);
+        restricted = true;
+      } else {
+        tmp.clear();
+        std::set_intersection(std::begin(pages), std::end(pages), std::begin(cur), std::end(cur),
+                              std::back_inserter(tmp));
+        std::swap(pages, tmp);
+      }
+      if (pages.empty()) break;
+    }
+    return restricted;
+  }
+
+  bool TermLogIndex::candidatePagesAny(const std::vector<std::string> &literals,
+                                       PageList &pages) const {
+    pages.clear();
+    if (literals.empty()) return false;
+    PageList cur, tmp;
+    for (const auto &literal : literals) {
+      /// @note a single unindexable alternative may match anywhere
+      if (!candidatePages(literal, cur)) {
+        pages.clear();
+        return false;
+      }
+      tmp.clear();
+      std::set_union(std::begin(pages), std::end(pages), std::begin(cur), std::end(cur),
+                     std::back_inserter(tmp));
+      std::swap(pages, tmp);
+    }
+    return true;
+  }
+
+  /// @note only plain literal runs outside of groups/ classes are collected, and a character
+  /// followed by an optional quantifier (*, ?, {}) is dropped. Any top-level alternation voids
+  /// the requirement altogether.
+  std::vector<std::string> TermLogIndex::regex_required_literals(std::string_view pattern) {
+    std::vector<std::string> literals;
+    std::string cur;
+    auto flush = [&literals, &cur]() {
+      if (cur.size() >= 3) literals.push_back(cur);
+      cur.clear();
+    };
+    int depth = 0;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+      const char c = pattern[i];
+      switch (c) {
+        case '|':
+          if (depth == 0) return {};
+          break;
+        case '(':
+          ++depth;
+          flush();
+          break;
+        case ')':
+          if (depth > 0) --depth;
+          flush();
+          break;
+        case '[':
+          flush();
+          /// @note skip the whole class
+          for (++i; i < pattern.size() && pattern[i] != ']'; ++i)
+            if (pattern[i] == '\\') ++i;
+          break;
+        case '{':
+          if (!cur.empty()) cur.pop_back();
+          flush();
+          for (; i < pattern.size() && pattern[i] != '}'; ++i);
+          break;
+        case '*':
+        case '?':
+          if (!cur.empty()) cur.pop_back();
+          flush();
+          break;
+        case '+':
+        case '.':
+        case '^':
+        case '$':
+          flush();
+          break;
+        case '\\':
+          if (i + 1 < pattern.size()) {
+            const char n = pattern[++i];
+            /// @note character class escapes, anchors, back-references and escapes with
+            /// arguments (\xhh, \uhhhh, \cX), whose arguments must not end up in a literal
+            if (std::isalnum((unsigned char)n)) {
+              size_t numArgs = 0;
+              if (n == 'x')
+                numArgs = 2;
+              else if (n == 'u')
+                numArgs = 4;
+              else if (n == 'c')
+                numArgs = 1;
+              else if (std::isdigit((unsigned char)n))
+                while (i + numArgs + 1 < pattern.size()
+                       && std::isdigit((unsigned char)pattern[i + numArgs + 1]))
+                  ++numArgs;
+              i = std::min(i + numArgs, pattern.size() - 1);
+              flush();
+            } else if (depth == 0)
+              cur.push_back(index_fold_case(n));
+          }
+          break;
+        default:
+          if (depth == 0) cur.push_back(index_fold_case(c));
+          break;
+      }
+    }
+    flush();
+    return literals;
+  }
+
+}  // namespace zs
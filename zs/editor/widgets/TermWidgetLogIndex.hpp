@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "zensim/TypeAlias.hpp"
+
+namespace zs {
+
+  ///
+  /// @brief incrementally maintained (case-insensitive) trigram index over TermLogStore entries
+  /// @note postings are kept at the granularity of store pages (s_page_size entries), which keeps
+  /// the index compact while still confining a query to the pages that may hold matches.
+  /// Candidates are then verified against the actual filter. Only the latest [maxPages] pages
+  /// are indexed, the postings of older (or pruned) pages are dropped in batches.
+  ///
+  struct TermLogIndex {
+    using PageList = std::vector<u32>;  // ascending page indices
+    static constexpr u32 s_page_bits = 6;
+    static constexpr size_t s_page_size = (size_t)1 << s_page_bits;  // entries per page
+
+    TermLogIndex(u32 maxPages = (u32)1 << 14) noexcept : _maxPages{maxPages ? maxPages : 1} {}
+
+    /// @note entries must be appended in ascending seq order, [type] is a ConsoleRecord::type_e
+    void append(u64 seq, std::string_view text, u32 type);
+    void clear();
+    /// @note the pages before [firstPage] are no longer queried (e.g. dropped by the store)
+    void prune(u32 firstPage);
+
+    /// @note pages before firstPage() are not indexed, thus may hold anything
+    u32 firstPage() const noexcept { return _firstPage; }
+    u32 numPages() const noexcept { return _firstPage + (u32)_pageTypeMasks.size(); }
+    /// @note number of (trigram, page) pairs, i.e. the size of the index
+    size_t numPostings() const noexcept { return _numPostings; }
+    /// @note bit (1 << type) is set if the page holds an entry of that type
+    u32 pageTypeMask(u32 page) const noexcept {
+      if (page < _firstPage) return ~(u32)0;
+      page -= _firstPage;
+      return page < _pageTypeMasks.size() ? _pageTypeMasks[page] : 0;
+    }
+    static u32 type_bit(u32 type) noexcept { return 1u << (type & 31u); }
+
+    /// @note returns false if [literal] is too short to narrow down the search (< 3 bytes),
+    /// otherwise [pages] holds every indexed page that may contain [literal]
+    bool candidatePages(std::string_view literal, PageList &pages) const;
+    /// @note every literal must be present
+    bool candidatePagesAll(const std::vector<std::string> &literals, PageList &pages) const;
+    /// @note any literal may be present
+    bool candidatePagesAny(const std::vector<std::string> &literals, PageList &pages) const;
+
+    /// @note literal substrings every match of [pattern] (ECMAScript) has to contain, empty if
+    /// none could be extracted conservatively
+    static std::vector<std::string> regex_required_literals(std::string_view pattern);
+
+  protected:
+    static u32 trigram_key(const char *p) noexcept;
+    /// @note drop the postings of the pages before [firstPage], O(size of the index)
+    void dropPages(u32 firstPage);
+
+    std::unordered_map<u32, PageList> _postings;
+    std::vector<u32> _pageTypeMasks;  // of the pages [_firstPage, numPages())
+    u32 _firstPage{0}, _maxPages;
+    size_t _numPostings{0};
+  };
+
+}  // namespace zs
@@ -0,0 +1,174 @@
+#include "TermWidgetComponent.hpp"
+
+#include <atomic>
+#include <filesystem>
+#if defined(ZS_PLATFORM_WINDOWS)
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
+namespace zs {
+
+  namespace fs = std::filesystem;
+
+  /// @note unique per store within the temp directory, so that concurrent editor processes (and
+  /// multiple terminals) never share a spill file
+  static std::string default_spill_file_name() {
+    static std::atomic<u32> s_numStores{0};
+#if defined(ZS_PLATFORM_WINDOWS)
+    const auto pid = (i64)_getpid();
+#else
+    const auto pid = (i64)getpid();
+#endif
+    std::error_code ec;
+    auto dir = fs::temp_directory_path(ec);
+    if (ec) dir = fs::current_path(ec);
+    return (dir / fmt::format("zs_terminal_log_{}_{}.bin", pid, s_numStores++)).string();
+  }
+
+  TermLogStore::TermLogStore(size_t capacity, std::string spillFileName, size_t numCachedPages)
+      : _ring(std::max(capacity, s_page_size)),
+        _memBegin{0},
+        _end{0},
+        _spillFileName{zs::move(spillFileName)},
+        _spillBytes{0},
+        _spillFailed{false},
+        _numCachedPages{std::max(numCachedPages, (size_t)1)} {
+    if (_spillFileName.empty()) _spillFileName = default_spill_file_name();
+    _unavailable._text = "<log entry unavailable>\n";
+    _unavailable._type = ConsoleRecord::unknown;
+  }
+  TermLogStore::~TermLogStore() {
+    if (_spillFile.is_open()) _spillFile.close();
+    /// @note also left behind by clear() until the next spill
+    std::error_code ec;
+    fs::remove(_spillFileName, ec);
+  }
+
+  u64 TermLogStore::append(std::string_view text, ConsoleRecord::type_e type) {
+    const auto cap = _ring.size();
+    if (_end - _memBegin == cap) {
+      spill(_memBegin, _ring[_memBegin % cap]);
+      _memBegin++;
+    }
+    /// @note reuse the string storage of the evicted slot
+    auto &rec = _ring[_end % cap];
+    rec._text.assign(text.data(), text.size());
+    rec._type = type;
+    return _end++;
+  }
+
+  void TermLogStore::clear() {
+    _memBegin = _end = 0;
+    _pages.clear();
+    _pageMap.clear();
+    _pageOffsets.clear();
+    _spillBytes = 0;
+    _spillFailed = false;
+    /// @note truncated upon the next spill
+    if (_spillFile.is_open()) _spillFile.close();
+  }
+
+  void TermLogStore::setCapacity(size_t capacity) {
+    capacity = std::max(capacity, s_page_size);
+    if (capacity == _ring.size()) return;
+    for (; _end - _memBegin > capacity; ++_memBegin)
+      spill(_memBegin, _ring[_memBegin % _ring.size()]);
+    std::vector<Record> ring(capacity);
+    for (u64 seq = _memBegin; seq < _end; ++seq)
+      ring[seq % capacity] = zs::move(_ring[seq % _ring.size()]);
+    _ring = zs::move(ring);
+  }
+
+  void TermLogStore::openSpillFile() {
+    fs::path filePath(_spillFileName);
+    if (filePath.has_parent_path()) {
+      std::error_code ec;
+      fs::create_directories(filePath.parent_path(), ec);
+    }
+    _spillFile.open(_spillFileName,
+                    std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!_spillFile.is_open()) {
+      _spillFailed = true;
+      fmt::print("Could not open file [{}] for terminal log spilling, older entries are dropped.\n",
+                 _spillFileName);
+    }
+  }
+
+  /// record layout: [u32 length][u8 type][text]
+  void TermLogStore::spill(u64 seq, const Record &rec) {
+    if (!_spillFailed && !_spillFile.is_open()) openSpillFile();
+    if (_spillFailed) return;
+
+    if ((seq & (s_page_size - 1)) == 0) _pageOffsets.push_back(_spillBytes);
+    const u32 len = (u32)rec._text.size();
+    const u8 type = (u8)rec._type;
+    _spillFile.seekp(_spillBytes);
+    _spillFile.write(reinterpret_cast<const char *>(&len), sizeof(len));
+    _spillFile.write(reinterpret_cast<const char *>(&type), sizeof(type));
+    _spillFile.write(rec._text.data(), len);
+    if (!_spillFile) {
+      _spillFailed = true;
+      fmt::print("Failed writing to [{}], older terminal log entries are dropped.\n",
+                 _spillFileName);
+      return;
+    }
+    _spillBytes += sizeof(len) + sizeof(type) + len;
+  }
+
+  void TermLogStore::readSpilled(u64 st, u64 ed,
+                                 const zs::function<void(u64, const Record &)> &f) {
+    if (ed > _memBegin) ed = _memBegin;
+    if (st >= ed || _spillFailed || !_spillFile.is_open()) return;
+    const u64 pageIndex = st >> s_page_bits;
+    if (pageIndex >= _pageOffsets.size()) return;
+
+    _spillFile.flush();
+    _spillFile.seekg(_pageOffsets[pageIndex]);
+    Record rec;
+    for (u64 seq = pageIndex << s_page_bits; seq < ed; ++seq) {
+      u32 len = 0;
+      u8 type = 0;
+      _spillFile.read(reinterpret_cast<char *>(&len), sizeof(len));
+      _spillFile.read(reinterpret_cast<char *>(&type), sizeof(type));
+      rec._text.resize(len);
+      _spillFile.read(rec._text.data(), len);
+      if (!_spillFile) break;
+      rec._type = static_cast<ConsoleRecord::type_e>(type);
+      if (seq >= st) f(seq, rec);
+    }
+    _spillFile.clear();
+  }
+
+  const TermLogStore::Record &TermLogStore::get(u64 seq) {
+    if (seq >= _end || seq < beginSeq()) return _unavailable;
+    if (seq >= _memBegin) return _ring[seq % _ring.size()];
+
+    const u64 pageIndex = seq >> s_page_bits;
+    const u64 pageBegin = pageIndex << s_page_bits;
+    Page *page = nullptr;
+    if (auto it = _pageMap.find(pageIndex); it != _pageMap.end()) {
+      _pages.splice(_pages.begin(), _pages, it->second);
+      page = zs::addressof(*it->second);
+    } else {
+      if (_pages.size() >= _numCachedPages) {
+        _pageMap.erase(_pages.back()._index);
+        _pages.pop_back();
+      }
+      _pages.push_front(Page{pageIndex, {}});
+      _pages.front()._records.reserve(s_page_size);
+      _pageMap[pageIndex] = _pages.begin();
+      page = zs::addressof(_pages.front());
+    }
+    /// @note (re)load if the page was only partially spilled when last loaded
+    if (seq - pageBegin >= page->_records.size()) {
+      page->_records.clear();
+      readSpilled(pageBegin, pageBegin + s_page_size,
+                  [page](u64, const Record &rec) { page->_records.push_back(rec); });
+    }
+    if (seq - pageBegin < page->_records.size()) return page->_records[seq - pageBegin];
+    return _unavailable;
+  }
+
+}  // namespace zs
@@ -0,0 +1,254 @@
+#include "TextEditorBuffer.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace zs {
+
+  static void index_line_breaks(std::string_view text, size_t base, std::vector<size_t> &breaks) {
+    for (size_t i = 0; i != text.size(); ++i)
+      if (text[i] == '\n') breaks.push_back(base + i);
+  }
+
+  ///
+  /// TextPieceTable
+  ///
+  void TextPieceTable::assign(std::string text) {
+    for (auto &buffer : _buffers) buffer.clear();
+    for (auto &breaks : _breaks) breaks.clear();
+    _pieces.clear();
+    _buffers[0] = std::move(text);
+    index_line_breaks(_buffers[0], 0, _breaks[0]);
+    if (!_buffers[0].empty()) _pieces.push_back(makePiece(0, 0, _buffers[0].size()));
+    _size = _buffers[0].size();
+    _numBreaks = _breaks[0].size();
+    _validPrefix = 0;
+    _version++;
+  }
+
+  TextPieceTable::Piece TextPieceTable::makePiece(u32 source, size_t start, size_t len) const {
+    const auto &breaks = _breaks[source];
+    auto st = std::lower_bound(std::begin(breaks), std::end(breaks), start);
+    auto ed = std::lower_bound(st, std::end(breaks), start + len);
+    return Piece{source, start, len, (size_t)(ed - st)};
+  }
+
+  void TextPieceTable::updatePrefixSums() const {
+    const size_t n = _pieces.size();
+    if (_validPrefix >= n && _pieceOffsets.size() == n + 1) return;
+    _pieceOffsets.resize(n + 1);
+    _pieceLines.resize(n + 1);
+    _pieceOffsets[0] = _pieceLines[0] = 0;
+    for (size_t i = std::min(_validPrefix, n); i != n; ++i) {
+      _pieceOffsets[i + 1] = _pieceOffsets[i] + _pieces[i]._length;
+      _pieceLines[i + 1] = _pieceLines[i] + _pieces[i]._numBreaks;
+    }
+    _validPrefix = n;
+  }
+
+  std::pair<size_t, size_t> TextPieceTable::locate(size_t pos) const {
+    updatePrefixSums();
+    if (pos >= _size) return {_pieces.size(), 0};
+    auto it = std::upper_bound(std::begin(_pieceOffsets), std::end(_pieceOffsets), pos);
+    const size_t idx = (size_t)(it - std::begin(_pieceOffsets)) - 1;
+    return {idx, pos - _pieceOffsets[idx]};
+  }
+
+  void TextPieceTable::insert(size_t pos, std::string_view text) {
+    if (text.empty()) return;
+    if (pos > _size) pos = _size;
+    auto &added = _buffers[1];
+    const size_t addStart = added.size();
+    added.append(text.data(), text.size());
+    index_line_breaks(text, addStart, _breaks[1]);
+
+    const auto [idx, offset] = locate(pos);
+    const Piece piece = makePiece(1, addStart, text.size());
+    if (offset == 0 && idx > 0 && _pieces[idx - 1]._source == 1
+        && _pieces[idx - 1]._start + _pieces[idx - 1]._length == addStart) {
+      /// @note typing continuously extends the previous piece
+      auto &prev = _pieces[idx - 1];
+      prev._length += piece._length;
+      prev._numBreaks += piece._numBreaks;
+      invalidatePrefixSums(idx - 1);
+    } else if (offset == 0) {
+      _pieces.insert(std::begin(_pieces) + idx, piece);
+      invalidatePrefixSums(idx);
+    } else {
+      const Piece orig = _pieces[idx];
+      const Piece left = makePiece(orig._source, orig._start, offset);
+      const Piece right = makePiece(orig._source, orig._start + offset, orig._length - offset);
+      _pieces[idx] = left;
+      _pieces.insert(std::begin(_pieces) + idx + 1, {piece, right});
+      invalidatePrefixSums(idx);
+    }
+    _size += text.size();
+    _numBreaks += piece._numBreaks;
+    _version++;
+  }
+
+  void TextPieceTable::erase(size_t pos, size_t len) {
+    if (pos >= _size || len == 0) return;
+    if (len > _size - pos) len = _size - pos;
+
+    const auto [i0, o0] = locate(pos);
+    const auto [i1, o1] = locate(pos + len);
+    Piece remains[2];
+    size_t numRemains = 0;
+    if (o0 > 0) remains[numRemains++] = makePiece(_pieces[i0]._source, _pieces[i0]._start, o0);
+    /// @note the last affected piece is only partially erased
+    size_t ed = i1;
+    if (o1 > 0) {
+      const auto &last = _pieces[i1];
+      remains[numRemains++] = makePiece(last._source, last._start + o1, last._length - o1);
+      ed = i1 + 1;
+    }
+    size_t numErasedBreaks = 0;
+    for (size_t i = i0; i != ed; ++i) numErasedBreaks += _pieces[i]._numBreaks;
+    for (size_t i = 0; i != numRemains; ++i) numErasedBreaks -= remains[i]._numBreaks;
+
+    _pieces.erase(std::begin(_pieces) + i0, std::begin(_pieces) + ed);
+    _pieces.insert(std::begin(_pieces) + i0, remains, remains + numRemains);
+    invalidatePrefixSums(i0);
+    _size -= len;
+    _numBreaks -= numErasedBreaks;
+    _version++;
+  }
+
+  size_t TextPieceTable::lineBegin(size_t line) const {
+    if (line == 0) return 0;
+    if (line > _numBreaks) return _size;
+    updatePrefixSums();
+    /// @note the piece holding the [line]-th line break
+    auto it = std::lower_bound(std::begin(_pieceLines), std::end(_pieceLines), line);
+    const size_t idx = (size_t)(it - std::begin(_pieceLines)) - 1;
+    const auto &piece = _pieces[idx];
+    const auto &breaks = _breaks[piece._source];
+    auto st = std::lower_bound(std::begin(breaks), std::end(breaks), piece._start);
+    const size_t breakPos = *(st + (line - _pieceLines[idx] - 1));
+    return _pieceOffsets[idx] + (breakPos - piece._start) + 1;
+  }
+
+  size_t TextPieceTable::lineEnd(size_t line) const {
+    if (line >= _numBreaks) return _size;
+    return lineBegin(line + 1) - 1;
+  }
+
+  size_t TextPieceTable::lineOf(size_t pos) const {
+    const auto [idx, offset] = locate(pos);
+    if (idx == _pieces.size()) return _numBreaks;
+    const auto &piece = _pieces[idx];
+    const auto &breaks = _breaks[piece._source];
+    auto st = std::lower_bound(std::begin(breaks), std::end(breaks), piece._start);
+    auto ed = std::lower_bound(st, std::end(breaks), piece._start + offset);
+    return _pieceLines[idx] + (size_t)(ed - st);
+  }
+
+  char TextPieceTable::at(size_t pos) const {
+    const auto [idx, offset] = locate(pos);
+    if (idx == _pieces.size()) return '\0';
+    const auto &piece = _pieces[idx];
+    return _buffers[piece._source][piece._start + offset];
+  }
+
+  void TextPieceTable::copyRange(size_t pos, size_t len, std::string &out) const {
+    if (pos >= _size || len == 0) return;
+    if (len > _size - pos) len = _size - pos;
+    out.reserve(out.size() + len);
+    auto [idx, offset] = locate(pos);
+    for (; len && idx != _pieces.size(); ++idx, offset = 0) {
+      const auto &piece = _pieces[idx];
+      const size_t n = std::min(len, piece._length - offset);
+      out.append(_buffers[piece._source], piece._start + offset, n);
+      len -= n;
+    }
+  }
+
+  std::string TextPieceTable::text() const {
+    std::string ret;
+    copyRange(0, _size, ret);
+    return ret;
+  }
+
+  ///
+  /// TextDocument
+  ///
+  void TextDocument::assign(std::string text) {
+    _text.assign(std::move(text));
+    _highlighter.reset(_text.numLines());
+    _cursor = _anchor = 0;
+    _preferredX = -1.f;
+    _mergeEdits = false;
+    _maxLineWidth = 0.f;
+    _undoStack.clear();
+    _redoStack.clear();
+    _syncedVersion = _text.version();
+  }
+
+  void TextDocument::applyEdit(size_t pos, std::string_view removed, std::string_view inserted) {
+    const size_t line = _text.lineOf(pos);
+    _text.erase(pos, removed.size());
+    _text.insert(pos, inserted);
+    _highlighter.onEdit(line, std::count(std::begin(removed), std::end(removed), '\n'),
+                        std::count(std::begin(inserted), std::end(inserted), '\n'));
+  }
+
+  std::string TextDocument::selectedText() const {
+    std::string ret;
+    _text.copyRange(selectionBegin(), selectionEnd() - selectionBegin(), ret);
+    return ret;
+  }
+
+  void TextDocument::replace(size_t pos, size_t len, std::string_view text, bool mergeable) {
+    if (len == 0 && text.empty()) return;
+    Edit edit{pos, {}, std::string{text}, _cursor, _anchor};
+    _text.copyRange(pos, len, edit._removed);
+    applyEdit(pos, edit._removed, text);
+    _cursor = _anchor = pos + text.size();
+    _preferredX = -1.f;
+    _scrollToCursor = true;
+
+    _redoStack.clear();
+    if (mergeable && _mergeEdits && !_undoStack.empty()) {
+      auto &last = _undoStack.back();
+      if (last._removed.empty() && edit._removed.empty()
+          && last._pos + last._inserted.size() == pos) {
+        last._inserted += text;
+        return;
+      }
+    }
+    _mergeEdits = mergeable;
+    _undoStack.push_back(std::move(edit));
+    if (_undoStack.size() > _undoLimit)
+      _undoStack.erase(std::begin(_undoStack),
+                       std::begin(_undoStack) + (_undoStack.size() - _undoLimit));
+  }
+
+  bool TextDocument::undo() {
+    if (_undoStack.empty()) return false;
+    auto edit = std::move(_undoStack.back());
+    _undoStack.pop_back();
+    applyEdit(edit._pos, edit._inserted, edit._removed);
+    _cursor = edit._cursorBefore;
+    _anchor = edit._anchorBefore;
+    _preferredX = -1.f;
+    _mergeEdits = false;
+    _scrollToCursor = true;
+    _redoStack.push_back(std::move(edit));
+    return true;
+  }
+
+  bool TextDocument::redo() {
+    if (_redoStack.empty()) return false;
+    auto edit = std::move(_redoStack.back());
+    _redoStack.pop_back();
+    applyEdit(edit._pos, edit._removed, edit._inserted);
+    _cursor = _anchor = edit._pos + edit._inserted.size();
+    _preferredX = -1.f;
+    _mergeEdits = false;
+    _scrollToCursor = true;
+    _undoStack.push_back(std::move(edit));
+    return true;
+  }
+
+}  // namespace zs
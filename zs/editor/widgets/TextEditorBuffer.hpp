@@ -0,0 +1,162 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "imgui.h"
+#include "zensim/TypeAlias.hpp"
+
+namespace zs {
+
+  ///
+  /// @brief piece table text storage
+  /// @note the original text and all the inserted text live in two append-only buffers, and the
+  /// document is a sequence of pieces referring to ranges of them. Line breaks of both buffers
+  /// are indexed once upon arrival, thus edits and line lookups cost time proportional to the
+  /// edit size (and the number of pieces), rather than the document size.
+  ///
+  struct TextPieceTable {
+    TextPieceTable() = default;
+    explicit TextPieceTable(std::string text) { assign(std::move(text)); }
+
+    void assign(std::string text);
+    void insert(size_t pos, std::string_view text);
+    void erase(size_t pos, size_t len);
+
+    size_t size() const noexcept { return _size; }
+    size_t numLines() const noexcept { return _numBreaks + 1; }
+    /// @note [lineBegin, lineEnd) of a line excludes its trailing line break
+    size_t lineBegin(size_t line) const;
+    size_t lineEnd(size_t line) const;
+    size_t lineOf(size_t pos) const;
+    char at(size_t pos) const;
+    /// @note appends [pos, pos + len) to [out]
+    void copyRange(size_t pos, size_t len, std::string &out) const;
+    std::string text() const;
+    /// @note bumped upon every modification
+    u64 version() const noexcept { return _version; }
+
+  protected:
+    struct Piece {
+      u32 _source;  // 0: original buffer, 1: added buffer
+      size_t _start, _length, _numBreaks;
+    };
+
+    Piece makePiece(u32 source, size_t start, size_t len) const;
+    /// @note (piece index, offset within the piece), (_pieces.size(), 0) for the end position
+    std::pair<size_t, size_t> locate(size_t pos) const;
+    void updatePrefixSums() const;
+    void invalidatePrefixSums(size_t pieceIdx) const noexcept {
+      if (pieceIdx < _validPrefix) _validPrefix = pieceIdx;
+    }
+
+    std::string _buffers[2];
+    std::vector<size_t> _breaks[2];  // ascending offsets of '\n' within each buffer
+    std::vector<Piece> _pieces;
+    /// exclusive prefix sums of piece lengths/ line breaks, up to date for [0, _validPrefix]
+    mutable std::vector<size_t> _pieceOffsets, _pieceLines;
+    mutable size_t _validPrefix{0};
+    size_t _size{0}, _numBreaks{0};
+    u64 _version{0};
+  };
+
+  ///
+  /// @brief incremental python syntax highlighter
+  /// @note the lexer state at the start of every line (e.g. within a triple-quoted string) is
+  /// kept. Upon edits, only the touched lines are re-lexed, and the re-lexing stops as soon as
+  /// a line ends in the state previously recorded for the next one. States are settled lazily up
+  /// to the lines being displayed, whose token spans are cached.
+  ///
+  struct PythonHighlighter {
+    enum token_e : u8 {
+      plain = 0,
+      keyword,
+      builtin,
+      string,
+      comment,
+      number,
+      decorator,
+      definition
+    };
+    enum state_e : u8 { normal = 0, in_single_quoted_docstring, in_double_quoted_docstring };
+    struct Token {
+      u32 _begin, _end;
+      token_e _kind;
+    };
+
+    void reset(size_t numLines);
+    /// @note [numRemovedBreaks] line breaks after the start of [line] were removed, and
+    /// [numInsertedBreaks] inserted
+    void onEdit(size_t line, size_t numRemovedBreaks, size_t numInsertedBreaks);
+    /// @note [lineText] is the content of [line], the returned reference is valid until the next
+    /// call
+    const std::vector<Token> &lineTokens(const TextPieceTable &text, size_t line,
+                                         std::string_view lineText);
+
+    static ImU32 token_color(token_e kind);
+    /// @note returns the state at the end of [line], tokens are appended to [tokens] if provided
+    static state_e lex_line(std::string_view line, state_e state, std::vector<Token> *tokens);
+
+  protected:
+    /// @note settle the start states of lines up to [line]
+    void updateStates(const TextPieceTable &text, size_t line);
+
+    std::vector<state_e> _states;  // lexer state at the start of every line
+    size_t _frontier{0};           // start states of [0, _frontier] are up to date
+    size_t _computedEnd{1};        // start states of [0, _computedEnd) were computed once
+    size_t _editEnd{0};            // lines after _editEnd are not edited since then
+    std::unordered_map<size_t, std::vector<Token>> _tokenCache;
+  };
+
+  ///
+  /// @brief a script opened in the text editor, i.e. its text along with the editing states
+  ///
+  struct TextDocument {
+    struct Edit {
+      size_t _pos;
+      std::string _removed, _inserted;
+      size_t _cursorBefore, _anchorBefore;
+    };
+
+    void assign(std::string text);
+
+    bool hasSelection() const noexcept { return _cursor != _anchor; }
+    size_t selectionBegin() const noexcept { return _cursor < _anchor ? _cursor : _anchor; }
+    size_t selectionEnd() const noexcept { return _cursor < _anchor ? _anchor : _cursor; }
+    std::string selectedText() const;
+
+    /// @note replaces [pos, pos + len) with [text] and records it for undo, consecutive
+    /// [mergeable] edits (typing) are undone at once
+    void replace(size_t pos, size_t len, std::string_view text, bool mergeable = false);
+    void replaceSelection(std::string_view text, bool mergeable = false) {
+      replace(selectionBegin(), selectionEnd() - selectionBegin(), text, mergeable);
+    }
+    bool undo();
+    bool redo();
+
+    /// @note whether there are edits not yet pushed to ResourceSystem
+    bool unsynced() const noexcept { return _text.version() != _syncedVersion; }
+
+  protected:
+    /// @note the only path through which _text is modified, keeps _highlighter informed
+    void applyEdit(size_t pos, std::string_view removed, std::string_view inserted);
+
+  public:
+    TextPieceTable _text;
+    PythonHighlighter _highlighter;
+    size_t _cursor{0}, _anchor{0};  // byte offsets, the selection spans [_anchor, _cursor)
+    float _preferredX{-1.f};        // kept through vertical cursor moves
+    bool _mergeEdits{false}, _scrollToCursor{false};
+    float _maxLineWidth{0.f};
+
+    std::vector<Edit> _undoStack, _redoStack;
+    size_t _undoLimit{1024};
+
+    u64 _syncedVersion{0};
+    double _lastEditTime{0.};
+  };
+
+}  // namespace zs
@@ -5,6 +5,10 @@
 //
 #include <float.h>
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
 // #include "IconsFontAwesome6.h"
 #include "world/core/Utils.hpp"
 #include "IconsMaterialDesign.h"
@@ -12,22 +16,85 @@
 #include "imgui_stdlib.h"
 #include "interface/details/Py.hpp"
 #include "interface/details/PyHelper.hpp"
+#include "editor/widgets/TermWidgetComponent.hpp"
 #include "editor/widgets/WidgetDrawUtilities.hpp"
 #include "world/system/PyExecSystem.hpp"
 #include "world/system/ResourceSystem.hpp"
+#include "utf8.h"
 
 namespace zs {
 
+  static bool is_word_char(char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'
+           || (unsigned char)c >= 0x80;
+  }
+  static bool is_utf8_continuation(char c) noexcept { return ((unsigned char)c & 0xC0) == 0x80; }
+  static size_t utf8_char_length(char c) noexcept {
+    const auto b = (unsigned char)c;
+    if ((b & 0xE0) == 0xC0) return 2;
+    if ((b & 0xF0) == 0xE0) return 3;
+    if ((b & 0xF8) == 0xF0) return 4;
+    return 1;
+  }
+
+  static size_t prev_char_pos(const TextPieceTable &text, size_t pos) {
+    if (pos == 0) return 0;
+    do --pos;
+    while (pos > 0 && is_utf8_continuation(text.at(pos)));
+    return pos;
+  }
+  static size_t next_char_pos(const TextPieceTable &text, size_t pos) {
+    if (pos >= text.size()) return text.size();
+    do ++pos;
+    while (pos < text.size() && is_utf8_continuation(text.at(pos)));
+    return pos;
+  }
+  static size_t prev_word_pos(const TextPieceTable &text, size_t pos) {
+    while (pos > 0 && !is_word_char(text.at(pos - 1))) --pos;
+    while (pos > 0 && is_word_char(text.at(pos - 1))) --pos;
+    return pos;
+  }
+  static size_t next_word_pos(const TextPieceTable &text, size_t pos) {
+    const size_t n = text.size();
+    while (pos < n && !is_word_char(text.at(pos))) ++pos;
+    while (pos < n && is_word_char(text.at(pos))) ++pos;
+    return pos;
+  }
+
+  static std::string line_text(const TextPieceTable &text, size_t line) {
+    std::string ret;
+    const size_t st = text.lineBegin(line);
+    text.copyRange(st, text.lineEnd(line) - st, ret);
+    return ret;
+  }
+  static float column_to_x(std::string_view line, size_t column) {
+    if (column > line.size()) column = line.size();
+    return ImGui::CalcTextSize(line.data(), line.data() + column).x;
+  }
+  static size_t x_to_column(std::string_view line, float x) {
+    const char *st = line.data(), *fin = line.data() + line.size();
+    float acc = 0.f;
+    for (const char *p = st; p < fin;) {
+      const char *next = p + utf8_char_length(*p);
+      if (next > fin) next = fin;
+      const float w = ImGui::CalcTextSize(p, next).x;
+      if (acc + w * 0.5f > x) return (size_t)(p - st);
+      acc += w;
+      p = next;
+    }
+    return line.size();
+  }
+
   ///
   TextEditor::TextEditor() {
     /// setup tab maintenance ops
     _tabs.setLeadingSymbolLiteral((const char *)ICON_MD_LIST);
-    _tabs.setInsertionCallback([](std::string_view label, std::string &buffer) {
-      buffer = ResourceSystem::get_script(std::string{label});
+    _tabs.setInsertionCallback([](std::string_view label, TextDocument &doc) {
+      doc.assign(ResourceSystem::get_script(std::string{label}));
     });
-    _tabs.setRemovalCallback([](std::string_view label, std::string &buffer) {
+    _tabs.setRemovalCallback([](std::string_view label, TextDocument &doc) {
+      sync_script(label, doc);
       if (label == g_textEditorLabel) {  // default text file is always saved upon removal
-        ResourceSystem::update_script(g_textEditorLabel, buffer);
         ResourceSystem::save_script(g_textEditorLabel);
       }
     });
@@ -37,8 +104,10 @@ namespace zs {
     _tabs.setIsModifiedPredicate([](std::string_view label) -> bool {
       return ResourceSystem::script_modified(std::string{label});
     });
-    _tabs.setSaveCallback(
-        [](std::string_view label) -> void { ResourceSystem::save_script(std::string{label}); });
+    _tabs.setSaveCallback([this](std::string_view label) -> void {
+      if (auto doc = _tabs.getEntryContent(label)) sync_script(label, *doc);
+      ResourceSystem::save_script(std::string{label});
+    });
     _tabs.setItemListCallback(
         []() -> std::vector<std::string> { return ResourceSystem::get_script_labels(); });
     //
@@ -49,23 +118,315 @@ namespace zs {
     // ResourceSystem::save_script(g_textEditorLabel);
   }
 
+  void TextEditor::sync_script(std::string_view label, TextDocument &doc) {
+    if (!doc.unsynced()) return;
+    ResourceSystem::update_script(label, doc._text.text());
+    doc._syncedVersion = doc._text.version();
+  }
+
+  bool TextEditor::processKeyboard(TextDocument &doc, size_t numPageLines) {
+    auto &io = ImGui::GetIO();
+    auto &text = doc._text;
+    const bool ctrl = io.ConfigMacOSXBehaviors ? io.KeySuper : io.KeyCtrl;
+    const bool shift = io.KeyShift;
+    const u64 version = text.version();
+
+    auto moveTo = [&doc, shift](size_t pos, bool keepPreferredX = false) {
+      doc._cursor = pos;
+      if (!shift) doc._anchor = pos;
+      if (!keepPreferredX) doc._preferredX = -1.f;
+      doc._mergeEdits = false;
+      doc._scrollToCursor = true;
+    };
+    auto moveVertically = [&](i64 numLines) {
+      const size_t line = text.lineOf(doc._cursor);
+      const i64 target = std::clamp((i64)line + numLines, (i64)0, (i64)text.numLines() - 1);
+      if (doc._preferredX < 0.f)
+        doc._preferredX = column_to_x(line_text(text, line), doc._cursor - text.lineBegin(line));
+      moveTo(text.lineBegin(target) + x_to_column(line_text(text, target), doc._preferredX), true);
+    };
+
+    if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow)) {
+      if (!shift && doc.hasSelection())
+        moveTo(doc.selectionBegin());
+      else
+        moveTo(ctrl ? prev_word_pos(text, doc._cursor) : prev_char_pos(text, doc._cursor));
+    } else if (ImGui::IsKeyPressed(ImGuiKey_RightArrow)) {
+      if (!shift && doc.hasSelection())
+        moveTo(doc.selectionEnd());
+      else
+        moveTo(ctrl ? next_word_pos(text, doc._cursor) : next_char_pos(text, doc._cursor));
+    } else if (ImGui::IsKeyPressed(ImGuiKey_UpArrow)) {
+      moveVertically(-1);
+    } else if (ImGui::IsKeyPressed(ImGuiKey_DownArrow)) {
+      moveVertically(1);
+    } else if (ImGui::IsKeyPressed(ImGuiKey_PageUp)) {
+      moveVertically(-(i64)numPageLines);
+    } else if (ImGui::IsKeyPressed(ImGuiKey_PageDown)) {
+      moveVertically((i64)numPageLines);
+    } else if (ImGui::IsKeyPressed(ImGuiKey_Home)) {
+      if (ctrl)
+        moveTo(0);
+      else {
+        /// @note toggle between the indentation end and the line begin
+        const size_t lineSt = text.lineBegin(text.lineOf(doc._cursor));
+        size_t indentEd = lineSt;
+        for (char c; indentEd < text.size() && ((c = text.at(indentEd)) == ' ' || c == '\t');)
+          ++indentEd;
+        moveTo(doc._cursor == indentEd ? lineSt : indentEd);
+      }
+    } else if (ImGui::IsKeyPressed(ImGuiKey_End)) {
+      moveTo(ctrl ? text.size() : text.lineEnd(text.lineOf(doc._cursor)));
+    } else if (ctrl && ImGui::IsKeyPressed(ImGuiKey_A)) {
+      doc._anchor = 0;
+      doc._cursor = text.size();
+    } else if (ctrl && ImGui::IsKeyPressed(ImGuiKey_C)) {
+      if (doc.hasSelection()) ImGui::SetClipboardText(doc.selectedText().c_str());
+    } else if (ctrl && ImGui::IsKeyPressed(ImGuiKey_X)) {
+      if (doc.hasSelection()) {
+        ImGui::SetClipboardText(doc.selectedText().c_str());
+        doc.replaceSelection({});
+      }
+    } else if (ctrl && ImGui::IsKeyPressed(ImGuiKey_V)) {
+      if (const char *clipboard = ImGui::GetClipboardText()) {
+        std::string str;
+        for (const char *p = clipboard; *p; ++p)
+          if (*p != '\r') str.push_back(*p);
+        doc.replaceSelection(str);
+      }
+    } else if (ctrl
+               && (ImGui::IsKeyPressed(ImGuiKey_Y) || (shift && ImGui::IsKeyPressed(ImGuiKey_Z)))) {
+      doc.redo();
+    } else if (ctrl && ImGui::IsKeyPressed(ImGuiKey_Z)) {
+      doc.undo();
+    } else if (ImGui::IsKeyPressed(ImGuiKey_Backspace)) {
+      if (doc.hasSelection())
+        doc.replaceSelection({});
+      else if (doc._cursor > 0) {
+        const size_t st
+            = ctrl ? prev_word_pos(text, doc._cursor) : prev_char_pos(text, doc._cursor);
+        doc.replace(st, doc._cursor - st, {});
+      }
+    } else if (ImGui::IsKeyPressed(ImGuiKey_Delete)) {
+      if (doc.hasSelection())
+        doc.replaceSelection({});
+      else if (doc._cursor < text.size()) {
+        const size_t ed
+            = ctrl ? next_word_pos(text, doc._cursor) : next_char_pos(text, doc._cursor);
+        doc.replace(doc._cursor, ed - doc._cursor, {});
+      }
+    } else if (ImGui::IsKeyPressed(ImGuiKey_Enter) || ImGui::IsKeyPressed(ImGuiKey_KeypadEnter)) {
+      /// @note keep the indentation of the current line
+      const size_t st = doc.selectionBegin();
+      std::string str = "\n";
+      for (size_t p = text.lineBegin(text.lineOf(st)); p < st; ++p) {
+        const char c = text.at(p);
+        if (c != ' ' && c != '\t') break;
+        str.push_back(c);
+      }
+      doc.replaceSelection(str);
+    } else if (!ctrl && ImGui::IsKeyPressed(ImGuiKey_Tab)) {
+      doc.replaceSelection("\t", true);
+    }
+
+    /// @note ctrl+alt composes characters on some layouts (AltGr)
+    if (!ctrl || io.KeyAlt) {
+      std::string str;
+      for (ImWchar c : io.InputQueueCharacters) {
+        if (c < 32 || c == 127) continue;
+        utf8::unchecked::append((unsigned int)c, std::back_inserter(str));
+      }
+      if (!str.empty()) doc.replaceSelection(str, true);
+    }
+    return text.version() != version;
+  }
+
+  bool TextEditor::drawDocument(TextDocument &doc, bool readOnly) {
+    bool edited = false;
+    auto &text = doc._text;
+    const float lineHeight = ImGui::GetTextLineHeight();
+    const float charWidth = ImGui::CalcTextSize(" ").x;
+
+    ImGui::PushStyleColor(ImGuiCol_ChildBg, g_darkest_color);
+    ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
+    if (ImGui::BeginChild("##source", ImVec2(-FLT_MIN, -FLT_MIN), ImGuiChildFlags_None,
+                          ImGuiWindowFlags_HorizontalScrollbar | ImGuiWindowFlags_NoMove
+                              | ImGuiWindowFlags_NoNavInputs)) {
+      const ImVec2 viewSize = ImGui::GetContentRegionAvail();
+      const size_t numPageLines = std::max((size_t)(viewSize.y / lineHeight), (size_t)1);
+      const bool focused = ImGui::IsWindowFocused();
+
+      if (focused && !readOnly) {
+        ImGui::SetNextFrameWantCaptureKeyboard(true);
+        edited = processKeyboard(doc, numPageLines);
+      }
+
+      const size_t numLines = text.numLines();
+      const float gutterWidth
+          = ImGui::CalcTextSize(fmt::format("{}", numLines).c_str()).x + charWidth * 2;
+      const ImVec2 origin = ImGui::GetCursorScreenPos();
+
+      ///
+      /// mouse
+      ///
+      auto hitTest = [&](ImVec2 mousePos) -> size_t {
+        const float y = mousePos.y - origin.y;
+        const size_t line = y < 0.f ? 0 : std::min((size_t)(y / lineHeight), numLines - 1);
+        return text.lineBegin(line)
+               + x_to_column(line_text(text, line), mousePos.x - origin.x - gutterWidth);
+      };
+      if (ImGui::IsWindowHovered()) {
+        if (ImGui::GetMousePos().x > origin.x + gutterWidth)
+          ImGui::SetMouseCursor(ImGuiMouseCursor_TextInput);
+        if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+          const size_t pos = hitTest(ImGui::GetMousePos());
+          doc._cursor = pos;
+          if (!ImGui::GetIO().KeyShift) doc._anchor = pos;
+          if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+            size_t st = pos, ed = pos;
+            while (st > 0 && is_word_char(text.at(st - 1))) --st;
+            while (ed < text.size() && is_word_char(text.at(ed))) ++ed;
+            doc._anchor = st;
+            doc._cursor = ed;
+          }
+          doc._preferredX = -1.f;
+          doc._mergeEdits = false;
+          _dragging = true;
+        }
+      }
+      if (_dragging) {
+        if (!ImGui::IsMouseDown(ImGuiMouseButton_Left))
+          _dragging = false;
+        else if (ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+          doc._cursor = hitTest(ImGui::GetMousePos());
+          doc._scrollToCursor = true;
+        }
+      }
+
+      if (doc._scrollToCursor) {
+        doc._scrollToCursor = false;
+        const size_t line = text.lineOf(doc._cursor);
+        const float y = line * lineHeight;
+        const float scrollY = ImGui::GetScrollY();
+        if (y < scrollY)
+          ImGui::SetScrollY(y);
+        else if (y + lineHeight > scrollY + viewSize.y)
+          ImGui::SetScrollY(y + lineHeight - viewSize.y);
+        const float x
+            = column_to_x(line_text(text, line), doc._cursor - text.lineBegin(line)) + gutterWidth;
+        const float scrollX = ImGui::GetScrollX();
+        if (x < scrollX + gutterWidth)
+          ImGui::SetScrollX(std::max(x - gutterWidth, 0.f));
+        else if (x + charWidth > scrollX + viewSize.x)
+          ImGui::SetScrollX(x + charWidth - viewSize.x);
+      }
+
+      ///
+      /// visible lines only
+      ///
+      ImDrawList *drawList = ImGui::GetWindowDrawList();
+      const size_t selBegin = doc.selectionBegin(), selEnd = doc.selectionEnd();
+      const int cursorLine = (int)text.lineOf(doc._cursor);
+      const double time = ImGui::GetTime();
+      const bool showCursor = focused && !readOnly
+                              && (time - doc._lastEditTime < 0.5 || std::fmod(time, 1.0) < 0.6);
+      const ImU32 textColor = ImGui::GetColorU32(ImGuiCol_Text);
+      const ImU32 lineNumberColor = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+      const ImU32 selectionColor = ImGui::GetColorU32(ImGuiCol_TextSelectedBg);
+      const ImU32 currentLineColor = IM_COL32(255, 255, 255, 16);
+
+      std::string lineStr;
+      ImGuiListClipper clipper;
+      clipper.Begin((int)numLines, lineHeight);
+      while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+          const ImVec2 pos = ImGui::GetCursorScreenPos();
+          const ImVec2 textPos(pos.x + gutterWidth, pos.y);
+          const size_t lineSt = text.lineBegin(i), lineEd = text.lineEnd(i);
+          lineStr.clear();
+          text.copyRange(lineSt, lineEd - lineSt, lineStr);
+          const float lineWidth = column_to_x(lineStr, lineStr.size());
+          doc._maxLineWidth = std::max(doc._maxLineWidth, lineWidth);
+
+          if (i == cursorLine && !doc.hasSelection() && focused)
+            drawList->AddRectFilled(
+                textPos,
+                ImVec2(textPos.x + std::max(doc._maxLineWidth, viewSize.x), pos.y + lineHeight),
+                currentLineColor);
+          /// @note a selected line break is shown as a trailing blank
+          if (selBegin < selEnd && selBegin <= lineEd && selEnd > lineSt) {
+            const float x0 = column_to_x(lineStr, std::max(selBegin, lineSt) - lineSt);
+            const float x1
+                = selEnd > lineEd ? lineWidth + charWidth : column_to_x(lineStr, selEnd - lineSt);
+            drawList->AddRectFilled(ImVec2(textPos.x + x0, pos.y),
+                                    ImVec2(textPos.x + x1, pos.y + lineHeight), selectionColor);
+          }
+
+          const auto lineNumber = fmt::format("{}", i + 1);
+          drawList->AddText(
+              ImVec2(textPos.x - charWidth - ImGui::CalcTextSize(lineNumber.c_str()).x, pos.y),
+              lineNumberColor, lineNumber.c_str());
+          /// @note highlighted spans, the gaps in between are plain text
+          {
+            float x = textPos.x;
+            auto drawSpan = [&](size_t st, size_t ed, ImU32 color) {
+              if (st >= ed) return;
+              const char *b = lineStr.data() + st, *e = lineStr.data() + ed;
+              drawList->AddText(ImVec2(x, pos.y), color, b, e);
+              x += ImGui::CalcTextSize(b, e).x;
+            };
+            size_t last = 0;
+            for (const auto &token : doc._highlighter.lineTokens(text, i, lineStr)) {
+              drawSpan(last, token._begin, textColor);
+              drawSpan(token._begin, token._end, PythonHighlighter::token_color(token._kind));
+              last = token._end;
+            }
+            drawSpan(last, lineStr.size(), textColor);
+          }
+
+          if (i == cursorLine && showCursor) {
+            const float x = textPos.x + column_to_x(lineStr, doc._cursor - lineSt);
+            drawList->AddLine(ImVec2(x, pos.y), ImVec2(x, pos.y + lineHeight), textColor);
+          }
+          ImGui::Dummy(ImVec2(gutterWidth + doc._maxLineWidth + charWidth, lineHeight));
+        }
+      }
+      clipper.End();
+    }
+    ImGui::EndChild();
+    ImGui::PopStyleVar();
+    ImGui::PopStyleColor();
+    return edited;
+  }
+
   void TextEditor::paint() {
     _tabs.paint();
     int selectedIdx = _tabs.getFocusId();
 
     ///
     /// update script if needed
-    auto pCurBuffer = &_buffer;
+    auto pDoc = &_buffer;
     if (selectedIdx != -1 && _tabs.size() > 0) {
       auto &entry = _tabs[selectedIdx];
-      pCurBuffer = &entry.content();
-      if (ResourceSystem::script_modified(entry._label)) {
-        *pCurBuffer = ResourceSystem::get_script(entry._label);
-        // ResourceSystem::mark_script_clean(doc._label);
+      pDoc = &entry.content();
+      /// @note upon switching documents, push pending edits of the previous one and pick up the
+      /// changes made to this script elsewhere, rather than copying the script every frame
+      if (entry._label != _focusedLabel) {
+        if (auto prevDoc = _tabs.getEntryContent(_focusedLabel))
+          sync_script(_focusedLabel, *prevDoc);
+        if (ResourceSystem::script_modified(entry._label)) {
+          auto script = ResourceSystem::get_script(entry._label);
+          if (script != pDoc->_text.text()) pDoc->assign(zs::move(script));
+        }
+        _focusedLabel = entry._label;
       }
     }
 
-    auto &buffer = *pCurBuffer;
+    auto &doc = *pDoc;
+    /// @note edits are pushed to ResourceSystem once typing pauses
+    if (selectedIdx != -1 && doc.unsynced() && ImGui::GetTime() - doc._lastEditTime > 0.5)
+      sync_script(_tabs[selectedIdx].getLabel(), doc);
+
     auto &pyExec = PyExecSystem::instance();
     bool inProgress = pyExec.inProgress();
     // icon_e ie = icon_e::play;
@@ -88,17 +449,23 @@ namespace zs {
 #endif
     if (!inProgress) {
       if (ImGui::Button((const char *)ICON_MD_PLAY_CIRCLE_OUTLINE u8"执行")) {
-        bool res = pyExec.assignTask([this, &buffer] {
+        sync_script(_tabs[selectedIdx].getLabel(), doc);
+        /// @note the task runs asynchronously, thus works on a snapshot of the script
+        bool res = pyExec.assignTask([script = doc._text.text()] {
           ResourceSystem::start_cstream_capture();
           int result_ = 0;
-          ZsValue ret = zs_execute_script(buffer.c_str(), &result_);
+          ZsValue ret = zs_execute_script(script.c_str(), &result_);
           ConsoleRecord::type_e result = result_ == 0 ? ConsoleRecord::info : ConsoleRecord::error;
-          ResourceSystem::dump_cstream_capture();
+          {
+            auto lk = lock_editor_logs();
+            ResourceSystem::dump_cstream_capture();
+          }
 
           PyGILState_STATE gstate = PyGILState_Ensure();
           if (ret.isObject()) {
             assert(ret.isBytes());
             PyVar resultPyBytes = ret;
+            auto lk = lock_editor_logs();
             if (resultPyBytes) {
               auto cstr = resultPyBytes.asBytes().c_str();
               ResourceSystem::push_assembled_log(cstr, result);
@@ -130,24 +497,13 @@ namespace zs {
     else
       ImGui::Text((const char *)u8"空");
 
-    ImGuiInputTextFlags flags = ImGuiInputTextFlags_AllowTabInput;
-    ImGui::PushStyleColor(ImGuiCol_FrameBg, g_darkest_color);
-
     if (selectedIdx != -1)
       ImGui::PushID(ImGui::GetCurrentWindow()->GetID(_tabs[selectedIdx].getLabel().data()));
 
     // auto tag = fmt::format("##{}\n", _openedDocs[_selectedDocIdx]._label);
-    if (ImGui::InputTextMultiline("##source", &buffer,
-                                  ImVec2(-FLT_MIN, /*ImGui::GetTextLineHeight() * 16*/ -FLT_MIN),
-                                  flags)) {
-      if (selectedIdx != -1) {
-        ResourceSystem::update_script(_tabs[selectedIdx].getLabel(), buffer);
-      }
-    }
+    if (drawDocument(doc, selectedIdx == -1)) doc._lastEditTime = ImGui::GetTime();
     if (selectedIdx != -1) ImGui::PopID();
 
-    ImGui::PopStyleColor();
-
     ///
     if (ImGui::BeginDragDropTarget()) {
       if (const ImGuiPayload *payload = ImGui::AcceptDragDropPayload("ASSETS_BROWSER_ITEMS")) {
@@ -172,4 +528,4 @@ namespace zs {
     }
   }
 
-}  // namespace zs
\ No newline at end of file
+}  // namespace zs
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <string>
+#include <string_view>
+
+#include "TextEditorBuffer.hpp"
 #include "WidgetComponent.hpp"
 #include "imgui.h"
 #include "zensim/ZpcResource.hpp"
@@ -16,9 +20,17 @@ namespace zs {
     void paint() override;
 
   protected:
-    std::string _buffer;
+    /// @note returns true if the document is edited
+    bool drawDocument(TextDocument &doc, bool readOnly);
+    bool processKeyboard(TextDocument &doc, size_t numPageLines);
+    /// @note push pending edits of the document to ResourceSystem
+    static void sync_script(std::string_view label, TextDocument &doc);
+
+    TextDocument _buffer;
+    std::string _focusedLabel;
+    bool _dragging{false};
 
-    TabEntries<std::string> _tabs;
+    TabEntries<TextDocument> _tabs;
   };
 
-}  // namespace zs
\ No newline at end of file
+}  // namespace zs
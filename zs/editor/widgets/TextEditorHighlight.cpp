@@ -0,0 +1,221 @@
+#include "TextEditorBuffer.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace zs {
+
+  static bool is_ident_start(char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (unsigned char)c >= 0x80;
+  }
+  static bool is_ident_char(char c) noexcept { return is_ident_start(c) || (c >= '0' && c <= '9'); }
+  static bool is_digit(char c) noexcept { return c >= '0' && c <= '9'; }
+  static bool is_string_prefix(std::string_view s) noexcept {
+    if (s.size() > 2) return false;
+    for (char c : s)
+      switch (c) {
+        case 'r':
+        case 'R':
+        case 'b':
+        case 'B':
+        case 'u':
+        case 'U':
+        case 'f':
+        case 'F':
+          break;
+        default:
+          return false;
+      }
+    return true;
+  }
+
+  ImU32 PythonHighlighter::token_color(token_e kind) {
+    switch (kind) {
+      case keyword:
+        return IM_COL32(86, 156, 214, 255);
+      case builtin:
+        return IM_COL32(78, 201, 176, 255);
+      case string:
+        return IM_COL32(206, 145, 120, 255);
+      case comment:
+        return IM_COL32(106, 153, 85, 255);
+      case number:
+        return IM_COL32(181, 206, 168, 255);
+      case decorator:
+      case definition:
+        return IM_COL32(220, 220, 170, 255);
+      default:
+        return ImGui::GetColorU32(ImGuiCol_Text);
+    }
+  }
+
+  PythonHighlighter::state_e PythonHighlighter::lex_line(std::string_view line, state_e state,
+                                                         std::vector<Token> *tokens) {
+    static const std::unordered_set<std::string_view> s_keywords{
+        "and",   "as",     "assert", "async",    "await", "break",  "class",  "continue",
+        "def",   "del",    "elif",   "else",     "except", "finally", "for",   "from",
+        "global", "if",    "import", "in",       "is",    "lambda", "nonlocal", "not",
+        "or",    "pass",   "raise",  "return",   "try",   "while",  "with",   "yield",
+        "match", "case"};
+    static const std::unordered_set<std::string_view> s_builtins{
+        "True",  "False",    "None",   "self",   "cls",      "print",   "len",     "range",
+        "int",   "float",    "str",    "bool",   "list",     "dict",    "set",     "tuple",
+        "object", "type",    "super",  "isinstance", "open", "enumerate", "zip",  "map",
+        "filter", "sorted",  "min",    "max",    "sum",      "abs",     "any",     "all",
+        "getattr", "setattr", "hasattr", "repr",  "iter",     "next",    "Exception"};
+
+    auto push = [tokens](size_t b, size_t e, token_e kind) {
+      if (tokens && b < e) tokens->push_back(Token{(u32)b, (u32)e, kind});
+    };
+    const size_t n = line.size();
+    size_t i = 0;
+
+    /// @note continue a docstring from the previous line
+    if (state != normal) {
+      const char *delim = state == in_single_quoted_docstring ? "'''" : "\"\"\"";
+      const size_t ed = line.find(delim);
+      if (ed == std::string_view::npos) {
+        push(0, n, string);
+        return state;
+      }
+      i = ed + 3;
+      push(0, i, string);
+      state = normal;
+    }
+
+    bool afterDef = false;
+    bool lineStart = true;
+    size_t st = 0;
+    /// @note lexes the string literal whose opening quote is at i, returns true if the line ends
+    /// within a docstring
+    auto lexString = [&]() -> bool {
+      const char quote = line[i];
+      if (i + 2 < n && line[i + 1] == quote && line[i + 2] == quote) {
+        const char delim[] = {quote, quote, quote, '\0'};
+        const size_t ed = line.find(delim, i + 3);
+        if (ed == std::string_view::npos) {
+          push(st, n, string);
+          state = quote == '\'' ? in_single_quoted_docstring : in_double_quoted_docstring;
+          return true;
+        }
+        i = ed + 3;
+      } else {
+        for (++i; i < n && line[i] != quote; ++i)
+          if (line[i] == '\\') ++i;
+        i = i < n ? i + 1 : n;
+      }
+      push(st, i, string);
+      return false;
+    };
+    while (i < n) {
+      const char c = line[i];
+      if (c == ' ' || c == '\t' || c == '\r') {
+        ++i;
+        continue;
+      }
+      st = i;
+      if (c == '#') {
+        push(st, n, comment);
+        break;
+      } else if (c == '@' && lineStart) {
+        for (++i; i < n && (is_ident_char(line[i]) || line[i] == '.'); ++i);
+        push(st, i, decorator);
+      } else if (c == '\'' || c == '"') {
+        if (lexString()) return state;
+      } else if (is_digit(c) || (c == '.' && i + 1 < n && is_digit(line[i + 1]))) {
+        for (++i; i < n; ++i) {
+          const char d = line[i];
+          if (is_ident_char(d) || d == '.') continue;
+          /// @note exponent signs
+          if ((d == '+' || d == '-') && (line[i - 1] == 'e' || line[i - 1] == 'E')
+              && !(line.size() > st + 1 && (line[st + 1] == 'x' || line[st + 1] == 'X')))
+            continue;
+          break;
+        }
+        push(st, i, number);
+      } else if (is_ident_start(c)) {
+        for (++i; i < n && is_ident_char(line[i]); ++i);
+        const auto word = line.substr(st, i - st);
+        if (i < n && (line[i] == '\'' || line[i] == '"') && is_string_prefix(word)) {
+          if (lexString()) return state;
+        } else if (afterDef) {
+          push(st, i, definition);
+          afterDef = false;
+        } else if (s_keywords.count(word)) {
+          push(st, i, keyword);
+          afterDef = word == "def" || word == "class";
+        } else if (s_builtins.count(word))
+          push(st, i, builtin);
+      } else
+        ++i;
+      lineStart = false;
+    }
+    return state;
+  }
+
+  void PythonHighlighter::reset(size_t numLines) {
+    _states.assign(numLines ? numLines : 1, normal);
+    _frontier = 0;
+    _computedEnd = 1;
+    _editEnd = 0;
+    _tokenCache.clear();
+  }
+
+  void PythonHighlighter::onEdit(size_t line, size_t numRemovedBreaks, size_t numInsertedBreaks) {
+    if (line >= _states.size()) return;
+    /// @note keep the states after the edited lines aligned with their lines
+    const size_t removeEd = std::min(line + 1 + numRemovedBreaks, _states.size());
+    _states.erase(std::begin(_states) + line + 1, std::begin(_states) + removeEd);
+    _states.insert(std::begin(_states) + line + 1, numInsertedBreaks, normal);
+
+    auto shift = [&](size_t l) -> size_t {
+      return l > line + numRemovedBreaks ? l + numInsertedBreaks - numRemovedBreaks : line + 1;
+    };
+    if (_frontier > line) _frontier = line;
+    if (_computedEnd > line + 1) _computedEnd = shift(_computedEnd);
+    _editEnd = std::max(_editEnd > line ? shift(_editEnd) : _editEnd, line + numInsertedBreaks);
+
+    /// @note lines before the edit keep their tokens, later ones are shifted or changed
+    for (auto it = std::begin(_tokenCache); it != std::end(_tokenCache);)
+      if (it->first >= line)
+        it = _tokenCache.erase(it);
+      else
+        ++it;
+  }
+
+  void PythonHighlighter::updateStates(const TextPieceTable &text, size_t line) {
+    if (_states.size() != text.numLines()) reset(text.numLines());
+    if (line >= _states.size()) line = _states.size() - 1;
+    std::string lineText;
+    while (_frontier < line) {
+      const size_t l = _frontier++;
+      lineText.clear();
+      const size_t st = text.lineBegin(l);
+      text.copyRange(st, text.lineEnd(l) - st, lineText);
+      const state_e state = lex_line(lineText, _states[l], nullptr);
+      if (_frontier > _editEnd && _frontier < _computedEnd && _states[_frontier] == state) {
+        /// @note converged, the following states are not affected by any edit
+        _frontier = _computedEnd - 1;
+        _editEnd = 0;
+        continue;
+      }
+      _states[_frontier] = state;
+    }
+    if (_computedEnd < _frontier + 1) _computedEnd = _frontier + 1;
+    /// @note stopped short of converging, the state of _frontier may have changed, thus the
+    /// states recorded beyond are only trusted once re-lexing agrees with them after it
+    if (_frontier + 1 < _computedEnd && _editEnd < _frontier) _editEnd = _frontier;
+  }
+
+  const std::vector<PythonHighlighter::Token> &PythonHighlighter::lineTokens(
+      const TextPieceTable &text, size_t line, std::string_view lineText) {
+    updateStates(text, line);
+    if (auto it = _tokenCache.find(line); it != _tokenCache.end()) return it->second;
+    /// @note only (recently) displayed lines are cached
+    if (_tokenCache.size() > 512) _tokenCache.clear();
+    auto &tokens = _tokenCache[line];
+    lex_line(lineText, line < _states.size() ? _states[line] : normal, &tokens);
+    return tokens;
+  }
+
+}  // namespace zs
@@ -7,6 +7,75 @@ namespace zs {
 
   namespace ui {
 
+    void TreeNodeBase::updateVisibleRows() {
+      if (!_view) _view = std::make_unique<TreeView>();
+      auto& rows = _view->_rows;
+      rows.clear();
+      /// @note preorder traversal, descending into open nodes only
+      std::vector<VisibleRow> stack{VisibleRow{this, 0}};
+      while (!stack.empty()) {
+        auto row = stack.back();
+        stack.pop_back();
+        auto node = row._node;
+        node->_visibleRowIndex = (i32)rows.size();
+        rows.push_back(row);
+        if (!tree_node_get_open(node)) continue;
+        if (node->childrenPending()) node->populateChildren();
+        for (u32 i = node->numViewedChildren(); i-- != 0;)
+          stack.push_back(
+              VisibleRow{static_cast<TreeNodeBase*>(node->getChildByIndex(i)), row._depth + 1});
+      }
+      _view->_dirty = false;
+    }
+
+    void TreeNodeBase::invalidateVisibleRows() {
+      TreeNodeBase* root = this;
+      while (root->getParent()) root = static_cast<TreeNodeBase*>(root->getParent());
+      if (root->_view) root->_view->_dirty = true;
+    }
+
+    const Shared<TreePathTable>& TreeNodeBase::pathTable() {
+      if (!_pathTable) {
+        if (_parent)
+          _pathTable = static_cast<TreeNodeBase*>(_parent)->pathTable();
+        else {
+          _pathTable = std::make_shared<TreePathTable>();
+          _pathTable->bind(TreePathTable::s_root, this);
+        }
+      }
+      return _pathTable;
+    }
+
+    void TreeNodeBase::updatePath() {
+      auto par = static_cast<TreeNodeBase*>(_parent);
+      if (_pathTable) _pathTable->unbind(_pathHandle, this);
+      if (!par) {
+        _pathHandle = TreePathTable::s_root;
+      } else {
+        _pathHandle = pathTable()->intern(par->_pathHandle, _label);
+      }
+      pathTable()->bind(_pathHandle, this);
+    }
+
+    TreeNodeBase* TreeNodeBase::findNode(std::string_view path) {
+      TreePathTable::handle_t handle;
+      if (!pathTable()->find(path, handle)) return nullptr;
+      return _pathTable->node(handle);
+    }
+
+    void TreeNodeBase::forgetSubtree(TreeNodeBase* node) {
+      TreeNodeBase* root = this;
+      while (root->getParent()) root = static_cast<TreeNodeBase*>(root->getParent());
+      std::vector<TreeNodeBase*> stack{node};
+      while (!stack.empty()) {
+        auto n = stack.back();
+        stack.pop_back();
+        root->_imguiSelection.SetItemSelected(n->_id, false);
+        if (root->_view && root->_view->_contextNode == n) root->_view->_contextNode = nullptr;
+        for (auto ch : n->_viewedTreeNodes) stack.push_back(static_cast<TreeNodeBase*>(ch));
+      }
+    }
+
     bool tree_node_get_open(TreeNodeBase* node) {
       return ImGui::GetStateStorage()->GetBool(node->_id);
     }
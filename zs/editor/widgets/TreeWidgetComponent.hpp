@@ -1,12 +1,16 @@
 #pragma once
+#include <deque>
 #include <list>
 #include <map>
 #include <set>
+#include <string_view>
+#include <unordered_map>
 
 #include "IconsMaterialDesign.h"
 // #include "IconsMaterialDesignIcons.h"
 #include "IconsMaterialSymbols.h"
 #include "editor/ImguiSystem.hpp"
+#include "TreeWidgetPaths.hpp"
 #include "WidgetBase.hpp"
 #include "imgui.h"
 #include "editor/widgets/WidgetComponent.hpp"
@@ -23,6 +27,8 @@ namespace zs {
   struct ZsPrimitive;
   namespace ui {
 
+    struct TreeNodeBase;
+
     // key : u32 index, string, pointer
     struct TreeNodeConcept : WidgetConcept {
       ~TreeNodeConcept() = default;
@@ -47,11 +53,14 @@ namespace zs {
       virtual bool selectable() { return true; }
       virtual bool togglable() { return true; }
       virtual void onDelete(std::string_view path) {}
+      /// @note lazily populated nodes only build their children upon the first expansion
+      virtual bool childrenPending() const { return false; }
+      virtual void populateChildren() {}
 
       // virtual void sortChildren(zs::function_ref<void()>) = 0;
       // virtual void filterChildren(zs::function<bool(TreeNodeConcept *)>) = 0;
 
-      bool isLeaf() const { return numChildren() == 0; }
+      bool isLeaf() const { return numChildren() == 0 && !childrenPending(); }
       bool isRoot() const { return const_cast<TreeNodeConcept *>(this)->getParent() == nullptr; }
 
       virtual i32 getViewIndexInParent() {
@@ -94,6 +103,10 @@ namespace zs {
 
     /// @note key's operator< must be defined
     struct TreeNodeBase : TreeNodeConcept {
+      ~TreeNodeBase() {
+        if (_pathTable) _pathTable->unbind(_pathHandle, this);
+      }
+
       u32 numChildren() const override { return _treeNodes.size(); }
       const char *getLabel() const override { return _label.c_str(); }
       u32 numViewedChildren() const override { return _viewedTreeNodes.size(); }
@@ -104,19 +117,29 @@ namespace zs {
       }
       TreeNodeConcept *getParent() override { return _parent; }
       void setParent(TreeNodeConcept *par) override { _parent = par; }
+      /// @note maintained upon insertions/ removals of the parent
+      i32 getViewIndexInParent() override { return _parent ? _indexInParent : -1; }
 
       bool appendChild(TreeNodeConcept *node) override {
         auto &ref = _treeNodes.emplace_back(node);
+        auto child = static_cast<TreeNodeBase *>(ref.get());
+        child->_indexInParent = (i32)_viewedTreeNodes.size();
         _viewedTreeNodes.emplace_back(ref.get());
         // ref->setParent(_parent);
         ref->setParent(this);  // fix
+        /// @note usually labelled afterwards (see TreeBuilder), which interns the path then
+        if (!child->_label.empty()) child->updatePath();
+        invalidateVisibleRows();
         return true;
       }
 
       bool removeChildByIndex(u32 id) override {
         auto target = getChildByIndex(id);
         if (target) {
+          forgetSubtree(static_cast<TreeNodeBase *>(target));
           _viewedTreeNodes.erase(_viewedTreeNodes.begin() + id);
+          reindexChildren(id);
+          invalidateVisibleRows();
           for (auto it = _treeNodes.begin(); it != _treeNodes.end();) {
             if ((*it).get() == target) {
               it = _treeNodes.erase(it);
@@ -129,27 +152,31 @@ namespace zs {
       }
       bool removeChildrenIf(zs::function_ref<bool(TreeNodeConcept *)> pred) override {
         bool deleted = false;
+        u32 firstDeleted = 0;
         for (auto it = _viewedTreeNodes.begin(); it != _viewedTreeNodes.end();) {
-          if (pred(*it)) {
+          if (auto target = *it; pred(target)) {
+            if (!deleted) firstDeleted = (u32)(it - _viewedTreeNodes.begin());
+            forgetSubtree(static_cast<TreeNodeBase *>(target));
             it = _viewedTreeNodes.erase(it);
             deleted = true;
-            for (auto nodeit = _treeNodes.begin(); nodeit != _treeNodes.end();) {
-              if ((*nodeit).get() == *it) {
-                nodeit = _treeNodes.erase(nodeit);
-                break;
-              } else
-                ++it;
-            }
+            _treeNodes.remove_if([target](const auto &node) { return node.get() == target; });
           } else
             ++it;
         }
+        if (deleted) {
+          reindexChildren(firstDeleted);
+          invalidateVisibleRows();
+        }
         return deleted;
       }
 
       void setWidgetId(ImGuiID id) override { _id = id; }
       // bool selectable() override { return static_cast<bool>(_selection); }
 
-      void setLabel(std::string_view label) { _label = label; }
+      void setLabel(std::string_view label) {
+        _label = label;
+        if (_parent) updatePath();
+      }
       void setTrailingOptions(TreeNodeTrailingOptions::type_e type, bool defaultState) {
         _trailingOptions[type] = TreeNodeTrailingOptions{type, defaultState};
       }
@@ -159,7 +186,44 @@ namespace zs {
 
       void paint() override;
 
-      void paintNode(ImGuiSelectionBasicStorage *selection, const std::string &path = "/");
+      /// @note a displayed row of the tree, i.e. a node all of whose ancestors are open
+      struct VisibleRow {
+        TreeNodeBase *_node;
+        u32 _depth;
+      };
+      /// @note states of the tree view, only maintained on the root being painted
+      struct TreeView {
+        std::vector<VisibleRow> _rows;  // in display order
+        bool _dirty{true};
+        TreeNodeBase *_contextNode{nullptr};  // whose context menu is open
+      };
+      enum row_event_e : u32 { _row_toggled = 1, _row_context_menu = 2 };
+
+      /// @note flatten the open part of the tree (populating pending children on the way)
+      void updateVisibleRows();
+      /// @note mark the visible rows of the root outdated
+      void invalidateVisibleRows();
+      /// @note returns the row_event_e bits triggered
+      u32 paintRow(ImGuiSelectionBasicStorage *selection, u32 depth);
+      /// @note returns false once the menu is closed
+      bool paintContextMenu();
+      /// @note '/'-separated labels from (excluding) the root, interned upon labelling
+      std::string_view path() const {
+        return _pathTable ? _pathTable->path(_pathHandle) : std::string_view{};
+      }
+      /// @note the path table of the tree, created by the root on demand
+      const Shared<TreePathTable> &pathTable();
+      void updatePath();
+      /// @note the node of [path] (relative to this root), nullptr if absent or not built yet
+      TreeNodeBase *findNode(std::string_view path);
+      /// @note drop the selection/ view states of the root referring to a subtree about to be
+      /// removed
+      void forgetSubtree(TreeNodeBase *node);
+      /// @note refresh _indexInParent of children starting from [st]
+      void reindexChildren(u32 st) {
+        for (u32 i = st; i < _viewedTreeNodes.size(); ++i)
+          static_cast<TreeNodeBase *>(_viewedTreeNodes[i])->_indexInParent = (i32)i;
+      }
 
       TreeNodeConcept *_parent{nullptr};
       ImGuiID _id;
@@ -174,6 +238,11 @@ namespace zs {
       float _width;
 
       ImGuiSelectionBasicStorage _imguiSelection;
+      Unique<TreeView> _view;
+      i32 _visibleRowIndex{-1};  // might be outdated, check against _view->_rows of the root
+      i32 _indexInParent{-1};    // within _viewedTreeNodes of the parent
+      Shared<TreePathTable> _pathTable;
+      TreePathTable::handle_t _pathHandle{TreePathTable::s_root};
     };
 
     template <typename TreeNode> struct TreeBuilder {
@@ -297,13 +366,26 @@ namespace zs {
         return *this;
       }
       void onDelete(std::string_view path) override;
+      bool childrenPending() const override { return _numPendingChildren != 0; }
+      /// @note child prims are retrieved from the stage through _path
+      void populateChildren() override;
+      /// @note bring the (built part of the) subtree in line with the stage in place, keeping the
+      /// nodes of the remaining prims (thus expansion and selection states). Only the branch
+      /// towards [focusPath] is descended if given. Returns false if the prim is gone.
+      bool resync(std::string_view focusPath = {});
+      /// @note resync after the prim at (the usd path) [primPath] is added, removed or changed,
+      /// called on the root. Returns false if the tree could not be updated in place.
+      bool resyncPrim(std::string_view primPath);
 
       SceneDescConcept *_scene{nullptr};  // plugin->getScene(zs_cstr(_name.data()))
       std::string _path{""}, _sceneName{""};
       type_e _type{_unknown};
+      /// @note children are built upon the first expansion
+      Shared<IDGenerator> _idGenerator;
+      size_t _numPendingChildren{0};
     };
 
-    /// @note new reference
+    /// @note new reference, only the root is built, descendants are built on demand
     UsdTreeNode *build_usd_tree_node(ScenePrimConcept *pr);
 
     struct SceneFileEditor : WidgetConcept {
@@ -0,0 +1,36 @@
+#include "TreeWidgetPaths.hpp"
+
+#include <utility>
+
+namespace zs {
+
+  namespace ui {
+
+    TreePathTable::TreePathTable() {
+      _paths.emplace_back();
+      _handles.emplace(std::string_view{_paths.back()}, s_root);
+    }
+
+    TreePathTable::handle_t TreePathTable::intern(handle_t parent, std::string_view label) {
+      const auto& parentPath = _paths[parent];
+      std::string p;
+      p.reserve(parentPath.size() + 1 + label.size());
+      p.append(parentPath).append(1, '/').append(label);
+      if (auto it = _handles.find(p); it != _handles.end()) return it->second;
+      const auto handle = (handle_t)_paths.size();
+      _paths.push_back(std::move(p));
+      _handles.emplace(std::string_view{_paths.back()}, handle);
+      return handle;
+    }
+
+    bool TreePathTable::find(std::string_view path, handle_t& handle) const {
+      if (auto it = _handles.find(path); it != _handles.end()) {
+        handle = it->second;
+        return true;
+      }
+      return false;
+    }
+
+  }  // namespace ui
+
+}  // namespace zs
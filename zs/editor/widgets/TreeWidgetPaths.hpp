@@ -0,0 +1,56 @@
+#pragma once
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "zensim/TypeAlias.hpp"
+
+namespace zs {
+
+  namespace ui {
+
+    struct TreeNodeBase;
+
+    ///
+    /// @brief interned node paths of a tree
+    /// @note a path ('/'-separated labels from, yet excluding, the root) is stored once and
+    /// referred to by a handle, which stays valid as long as the table
+    ///
+    struct TreePathTable {
+      using handle_t = u32;
+      static constexpr handle_t s_root = 0;  // the empty path of the root
+
+      TreePathTable();
+      TreePathTable(const TreePathTable &) = delete;
+      TreePathTable &operator=(const TreePathTable &) = delete;
+
+      /// @note path of [parent] + '/' + [label]
+      handle_t intern(handle_t parent, std::string_view label);
+      std::string_view path(handle_t handle) const noexcept { return _paths[handle]; }
+      /// @note returns false if [path] is not interned
+      bool find(std::string_view path, handle_t &handle) const;
+      size_t size() const noexcept { return _paths.size(); }
+
+      /// @note the node currently holding the path, nullptr if none
+      TreeNodeBase *node(handle_t handle) const noexcept {
+        return handle < _nodes.size() ? _nodes[handle] : nullptr;
+      }
+      void bind(handle_t handle, TreeNodeBase *node) {
+        if (handle >= _nodes.size()) _nodes.resize(_paths.size(), nullptr);
+        _nodes[handle] = node;
+      }
+      void unbind(handle_t handle, const TreeNodeBase *node) noexcept {
+        if (handle < _nodes.size() && _nodes[handle] == node) _nodes[handle] = nullptr;
+      }
+
+    protected:
+      std::deque<std::string> _paths;  // stable addresses, referred to by _handles
+      std::unordered_map<std::string_view, handle_t> _handles;
+      std::vector<TreeNodeBase *> _nodes;
+    };
+
+  }  // namespace ui
+
+}  // namespace zs
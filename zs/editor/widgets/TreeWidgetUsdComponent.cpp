@@ -1,4 +1,7 @@
 #include "TreeWidgetComponent.hpp"
+//
+#include <unordered_set>
+
 #include "imgui.h"
 #include "imgui_internal.h"
 #include "world/system/ResourceSystem.hpp"
@@ -13,40 +16,144 @@ namespace zs {
 
       builder  //.enableSelection()
           .setOption(TreeNodeTrailingOptions::type_e::_visible, true)
-          .setupObject([prim](UsdTreeNode& node) {
+          .setupObject([prim, &builder](UsdTreeNode& node) {
             node.setLabel(prim->getName());
             node._path = prim->getPath();
             // node._prim = prim;
             node._scene = prim->getScene();
             node._sceneName = prim->getScene()->getName();
             if (prim->isValid()) node.setType(UsdTreeNode::_mesh);
+
+            /// @note only count the children here, they are built once the node gets expanded
+            size_t nChilds = 0;  // the following might not assign any value to it, must init 0
+            prim->getAllChilds(&nChilds, nullptr);
+            node._numPendingChildren = nChilds;
+            node._idGenerator = builder._curId;
           });
+    }
 
-      size_t nChilds = 0;  // the following might not assign any value to it, must init 0
+    UsdTreeNode* build_usd_tree_node(ScenePrimConcept* pr) {
+      auto builder = build_tree_node<UsdTreeNode>();  // pr ? pr->getName() : "<empty>"
+
+      __build_usd_node(builder, pr);
+      return builder.get();
+    }
+
+    void UsdTreeNode::populateChildren() {
+      if (!_numPendingChildren) return;
+      _numPendingChildren = 0;
+      if (!_scene) return;
+      auto prim = _scene->getPrim(_path.c_str());
+      if (!prim) return;
+
+      size_t nChilds = 0;
       prim->getAllChilds(&nChilds, nullptr);
       std::vector<ScenePrimHolder> childs(nChilds);
       if (nChilds) {
         prim->getAllChilds(&nChilds, childs.data());
 
         for (size_t i = 0; i < nChilds; ++i) {
-          auto chBuilder = builder.beginChild();
+          auto child = new UsdTreeNode();
+          appendChild(child);  // setParent happens within
+          TreeBuilder<UsdTreeNode> chBuilder{_idGenerator, *child};
           __build_usd_node(chBuilder, childs[i].get());
-          builder.endChild();
         }
       }
     }
 
-    UsdTreeNode* build_usd_tree_node(ScenePrimConcept* pr) {
-      auto builder = build_tree_node<UsdTreeNode>();  // pr ? pr->getName() : "<empty>"
+    bool UsdTreeNode::resync(std::string_view focusPath) {
+      if (!_scene) return false;
+      auto prim = _scene->getPrim(_path.c_str());
+      if (!prim) return false;
+      if (prim->isValid()) setType(UsdTreeNode::_mesh);
+      /// @note the whole subtree of the focused prim is subject to change
+      if (focusPath == _path) focusPath = {};
 
-      __build_usd_node(builder, pr);
-      return builder.get();
+      size_t nChilds = 0;
+      prim->getAllChilds(&nChilds, nullptr);
+      /// @note unbuilt children are simply recounted
+      if (childrenPending() || _viewedTreeNodes.empty()) {
+        if (_numPendingChildren != nChilds) {
+          _numPendingChildren = nChilds;
+          invalidateVisibleRows();
+        }
+        return true;
+      }
+      std::vector<ScenePrimHolder> childs(nChilds);
+      if (nChilds) prim->getAllChilds(&nChilds, childs.data());
+
+      std::unordered_map<std::string_view, UsdTreeNode*> remains;
+      remains.reserve(_viewedTreeNodes.size());
+      for (auto ch : _viewedTreeNodes) {
+        auto child = static_cast<UsdTreeNode*>(ch);
+        remains.emplace(child->_path, child);
+      }
+      auto onFocusedBranch = [focusPath](std::string_view path) {
+        if (focusPath.empty()) return true;
+        return focusPath.size() >= path.size() && focusPath.substr(0, path.size()) == path
+               && (focusPath.size() == path.size() || focusPath[path.size()] == '/');
+      };
+
+      std::vector<TreeNodeConcept*> viewed;
+      viewed.reserve(nChilds);
+      for (size_t i = 0; i < nChilds; ++i) {
+        auto chPrim = childs[i].get();
+        std::string chPath{chPrim->getPath()};
+        if (auto it = remains.find(chPath); it != remains.end()) {
+          auto child = it->second;
+          remains.erase(it);
+          viewed.push_back(child);
+          if (onFocusedBranch(child->_path)) child->resync(focusPath);
+        } else {
+          auto child = new UsdTreeNode();
+          _treeNodes.emplace_back(child);
+          child->setParent(this);
+          viewed.push_back(child);
+          TreeBuilder<UsdTreeNode> chBuilder{_idGenerator, *child};
+          __build_usd_node(chBuilder, chPrim);
+        }
+      }
+      /// @note nodes of vanished prims
+      if (!remains.empty()) {
+        std::unordered_set<TreeNodeConcept*> removed;
+        for (auto& [path, child] : remains) {
+          forgetSubtree(child);
+          removed.insert(child);
+        }
+        remains.clear();  // keys refer to the nodes being released
+        _treeNodes.remove_if([&removed](const auto& node) { return removed.count(node.get()); });
+      }
+      _viewedTreeNodes = zs::move(viewed);
+      reindexChildren(0);
+      invalidateVisibleRows();
+      return true;
+    }
+
+    bool UsdTreeNode::resyncPrim(std::string_view primPath) {
+      /// @note tree paths exclude the path of the root prim
+      std::string_view relPath = primPath;
+      if (_path != "/") {
+        if (primPath.substr(0, _path.size()) != _path) return false;
+        relPath = primPath.substr(_path.size());
+      }
+      /// @note the prim itself might be added or removed, thus start from its parent, i.e. the
+      /// nearest built ancestor
+      TreeNodeBase* node = nullptr;
+      while (!node) {
+        const auto pos = relPath.rfind('/');
+        if (pos == std::string_view::npos) break;
+        relPath = relPath.substr(0, pos);
+        node = findNode(relPath);
+      }
+      if (!node) node = this;
+      return static_cast<UsdTreeNode*>(node)->resync(primPath);
     }
 
     ///
     ///
     ///
     void UsdTreeNode::onDelete(std::string_view path) {
+      const auto sceneName = _sceneName;
 #if ZS_ENABLE_USD
       fmt::print("deleted [{}] of scene [{}] ({})\n", _path, _scene->getName(), _sceneName);
       auto ret = ResourceSystem::get_usd(_sceneName)->removePrim(path.data());
@@ -56,17 +163,36 @@ namespace zs {
       // dynamic_cast<USDSceneDesc*>(ResourceSystem::get_usd(_sceneName))->viewTree();
 
       ResourceSystem::mark_usd_dirty(_sceneName);
+
+      /// @note update the tree in place instead of rebuilding it, this node is released within
+      if (ret) {
+        UsdTreeNode* root = this;
+        while (root->getParent()) root = static_cast<UsdTreeNode*>(root->getParent());
+        const auto primPath = _path;
+        if (root->resyncPrim(primPath)) return;
+      }
 #endif
-      ResourceSystem::onUsdFilesChanged().emit({std::string{_sceneName}});
+      ResourceSystem::onUsdFilesChanged().emit({sceneName});
     }
 
-    void TreeNodeBase::paintNode(ImGuiSelectionBasicStorage* selection, const std::string& path) {
+    u32 TreeNodeBase::paintRow(ImGuiSelectionBasicStorage* selection, u32 depth) {
+      u32 events = 0;
+      /// @note rows are not nested through TreePush, thus indent explicitly (as much as a
+      /// TreePush plus the label alignment of the parent row), and keep ids of same-labeled nodes
+      /// apart through the node id
+      const auto& style = ImGui::GetStyle();
+      const float indent
+          = depth
+            * (style.IndentSpacing + ImGui::GetTreeNodeToLabelSpacing() - style.FramePadding.x * 2);
+      if (indent > 0.f) ImGui::Indent(indent);
+      ImGui::PushID(_id);
+
       ImGui::TableNextRow();
       /// column 1
       ImGui::TableNextColumn();
 
       auto flags
-          = _flags | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_NavLeftJumpsBackHere;
+          = _flags | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen;
       if (isLeaf()) flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_Bullet;
       if (selection->Contains(_id)) {  // isSelected
         flags |= ImGuiTreeNodeFlags_Selected;
@@ -76,31 +202,17 @@ namespace zs {
       ImGui::SetNextItemSelectionUserData((ImGuiSelectionUserData)(intptr_t)this);
       ImGui::SetNextItemStorageID(_id);
       bool nodeOpen = ImGui::TreeNodeEx(_label.c_str(), flags);
-      bool toggled = !nodeOpen && ImGui::IsItemToggledOpen();
+      if (ImGui::IsItemToggledOpen()) {
+        events |= _row_toggled;
+        if (!nodeOpen) tree_close_and_unselect_child_nodes(this, selection);
+      }
 
       // right-click menu
       if (ImGui::IsItemClicked(ImGuiMouseButton_Right)) {
         ImGui::OpenPopupEx((ImGuiID)_id,
                            ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoTitleBar
                                | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoMove);
-      }
-      if (ImGui::BeginPopupEx((ImGuiID)_id,
-                              ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoTitleBar
-                                  | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoMove)) {
-        ImGui::Text(path.substr(0, path.size() - 1).c_str());
-        if (ImGui::Selectable((const char*)u8"删除")) {
-          ZS_EVENT_SCHEDULER().emplace(
-              // must hold a std::string rather than a string_view
-              [this, path = std::string(path.substr(0, path.size() - 1))]() {
-                this->onDelete(path);
-              });
-
-          /// @note when tree rebuilt (e.g. signaled here), imgui ids are likely reused, thus reset
-          /// here ahead
-          /// @note reset open/close state here to operate within imgui window scope
-          tree_node_set_open(this, false);
-        }
-        ImGui::EndPopup();
+        events |= _row_context_menu;
       }
       // trailing buttons
       auto findOption = [this](TreeNodeTrailingOptions::type_e type) -> TreeNodeTrailingOptions* {
@@ -108,7 +220,6 @@ namespace zs {
         return nullptr;
       };
       /// column 2 (visibility)
-      ImGui::PushID(_id);
       ImGui::TableNextColumn();
       {
         auto option = findOption(TreeNodeTrailingOptions::_visible);
@@ -126,112 +237,114 @@ namespace zs {
         } else
           ImGui::TextDisabled("--");
       }
+
       ImGui::PopID();
-      /*
-                if (_trailingOptions.size()) {
-                  const auto &style = ImGui::GetStyle();
-                  auto width = ImGui::GetContentRegionAvail().x;
-                  auto accumWidth = 0.f;
-                  for (int i = 0; i < _trailingOptions.size(); ++i) {
-                    auto &option = _trailingOptions[i];
-                    accumWidth += option.evalWidth() + style.FramePadding.x * 2.0f +
-         style.ItemSpacing.x; ImGui::SameLine(width - accumWidth); option.paint();
-                  }
-                }
-                */
-
-      // children
-      // if (_toggled) _toggled = ImGui::IsItemToggledOpen();
-      if (nodeOpen) {  // togglable() &&
-        ImGui::Indent(ImGui::GetTreeNodeToLabelSpacing() - ImGui::GetStyle().FramePadding.x * 2);
-        for (auto& child : _viewedTreeNodes) {
-          auto ch = static_cast<TreeNodeBase*>(child);
-          ch->paintNode(selection, path + ch->getLabel() + "/");
-        }
-        ImGui::Unindent(ImGui::GetTreeNodeToLabelSpacing() - ImGui::GetStyle().FramePadding.x * 2);
-      } else if (toggled) {
-        tree_close_and_unselect_child_nodes(this, selection);
-      }
+      if (indent > 0.f) ImGui::Unindent(indent);
+      return events;
+    }
 
-      if (nodeOpen) {
-        ImGui::TreePop();
+    bool TreeNodeBase::paintContextMenu() {
+      if (!ImGui::BeginPopupEx((ImGuiID)_id,
+                               ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoTitleBar
+                                   | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoMove))
+        return false;
+      const auto path = this->path();
+      ImGui::TextUnformatted(path.data(), path.data() + path.size());
+      if (ImGui::Selectable((const char*)u8"删除")) {
+        ZS_EVENT_SCHEDULER().emplace(
+            // must hold a std::string rather than a string_view
+            [this, path = std::string{path}]() { this->onDelete(path); });
+
+        /// @note when tree rebuilt (e.g. signaled here), imgui ids are likely reused, thus reset
+        /// here ahead
+        /// @note reset open/close state here to operate within imgui window scope
+        tree_node_set_open(this, false);
+        invalidateVisibleRows();
       }
+      ImGui::EndPopup();
+      return true;
     }
 
     void TreeNodeBase::paint() {
-      bool tableOpen = false;
-      if (tableOpen = ImGui::BeginTable("tree_table", 3, ImGuiTreeNodeFlags_SpanFullWidth);
-          tableOpen) {
-        ImGui::TableSetupColumn((const char*)u8"结点名", ImGuiTableColumnFlags_NoHide);
-        ImGui::TableSetupColumn((const char*)u8"可见", ImGuiTableColumnFlags_WidthFixed,
-                                ImGui::CalcTextSize((const char*)u8"可见").x);
-        ImGui::TableSetupColumn((const char*)u8"编辑", ImGuiTableColumnFlags_WidthFixed,
-                                ImGui::CalcTextSize((const char*)u8"编辑").x);
-        ImGui::TableHeadersRow();
-      }
+      if (!_view) _view = std::make_unique<TreeView>();
+      auto& view = *_view;
+      if (view._dirty) updateVisibleRows();
+      const auto& rows = view._rows;
+
+      if (!ImGui::BeginTable("tree_table", 3, ImGuiTreeNodeFlags_SpanFullWidth)) return;
+      ImGui::TableSetupColumn((const char*)u8"结点名", ImGuiTableColumnFlags_NoHide);
+      ImGui::TableSetupColumn((const char*)u8"可见", ImGuiTableColumnFlags_WidthFixed,
+                              ImGui::CalcTextSize((const char*)u8"可见").x);
+      ImGui::TableSetupColumn((const char*)u8"编辑", ImGuiTableColumnFlags_WidthFixed,
+                              ImGui::CalcTextSize((const char*)u8"编辑").x);
+      ImGui::TableHeadersRow();
+
+      /// @note row index of a node, -1 if it is not displayed
+      auto rowOf = [&rows](TreeNodeBase* node) -> int {
+        const auto idx = node->_visibleRowIndex;
+        if (idx >= 0 && idx < (int)rows.size() && rows[idx]._node == node) return idx;
+        return -1;
+      };
 
       /// multi select
       ImGuiMultiSelectFlags flags
           = ImGuiMultiSelectFlags_ClearOnEscape | ImGuiMultiSelectFlags_BoxSelect1d;
-      ImGuiMultiSelectIO* msIo = ImGui::BeginMultiSelect(flags, _imguiSelection.Size, -1);
+      ImGuiMultiSelectIO* msIo
+          = ImGui::BeginMultiSelect(flags, _imguiSelection.Size, (int)rows.size());
 
-      auto applySelectionRequests = [](ImGuiMultiSelectIO* ms_io, TreeNodeBase* tree,
-                                       ImGuiSelectionBasicStorage* selection) {
+      auto applySelectionRequests = [&rows, &rowOf](ImGuiMultiSelectIO* ms_io, TreeNodeBase* tree,
+                                                    ImGuiSelectionBasicStorage* selection) {
         for (ImGuiSelectionRequest& req : ms_io->Requests) {
           if (req.Type == ImGuiSelectionRequestType_SetAll) {
-            if (req.Selected)
-              tree_set_all_in_open_nodes(tree, selection, req.Selected);
-            else
+            if (req.Selected) {
+              /// @note the root row is not selectable
+              for (const auto& row : rows)
+                if (row._node != tree) selection->SetItemSelected(row._node->_id, true);
+            } else
               selection->Clear();
           } else if (req.Type == ImGuiSelectionRequestType_SetRange) {
             TreeNodeBase* first_node = (TreeNodeBase*)(intptr_t)req.RangeFirstItem;
             TreeNodeBase* last_node = (TreeNodeBase*)(intptr_t)req.RangeLastItem;
-            int cnt = 0;
-            for (TreeNodeBase* node = first_node; node != nullptr;
-                 node = tree_get_next_node_in_visible_order(node, last_node)) {
-              selection->SetItemSelected(node->_id, req.Selected);
-#if 0
-              if (cnt++ > 100) {
-                fmt::print(
-                    "iterating {} and still counting. first node: ({}) {} (id in par: {}, open: "
-                    "{}), last node: ({}) {} (id "
-                    "in par: {}, open: {}). cur "
-                    "node: ({}) {} (id in par: {}, open: {}, par child size: {})\n",
-                    cnt, first_node->_label, first_node ? first_node->_id : 0,
-                    first_node->getViewIndexInParent(), tree_node_get_open(first_node),
-                    last_node->_label, last_node ? last_node->_id : 0,
-                    last_node->getViewIndexInParent(), tree_node_get_open(last_node), node->_label,
-                    node ? node->_id : 0, node->getViewIndexInParent(), tree_node_get_open(node),
-                    node->getParent()->numViewedChildren());
-                if (node->getViewIndexInParent() == -1) {
-                  fmt::print("\t[");
-                  for (int i = 0; i < node->getParent()->numViewedChildren(); ++i)
-                    fmt::print(
-                        "{}, ",
-                        static_cast<TreeNodeBase*>(node->getParent()->getChildByIndex(i))->_id);
-                  fmt::print("]\n");
-                }
-                fmt::print("iterating {} and still counting. selection size: {}\n", cnt,
-                           selection->Size);
-                getchar();
-              }
-#endif
+            int st = rowOf(first_node), ed = rowOf(last_node);
+            if (st != -1 && ed != -1) {
+              if (st > ed) zs_swap(st, ed);
+              for (int i = st; i <= ed; ++i)
+                selection->SetItemSelected(rows[i]._node->_id, req.Selected);
+            } else {
+              for (TreeNodeBase* node = first_node; node != nullptr;
+                   node = tree_get_next_node_in_visible_order(node, last_node))
+                selection->SetItemSelected(node->_id, req.Selected);
             }
           }
         }
       };
       applySelectionRequests(msIo, this, &_imguiSelection);
 
-      paintNode(&_imguiSelection, "/");
+      /// @note only the rows within the visible region are submitted
+      ImGuiListClipper clipper;
+      clipper.Begin((int)rows.size());
+      if (msIo->RangeSrcItem != ImGuiSelectionUserData_Invalid)
+        if (int idx = rowOf((TreeNodeBase*)(intptr_t)msIo->RangeSrcItem); idx != -1)
+          clipper.IncludeItemByIndex(idx);
+      while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+          auto node = rows[i]._node;
+          auto events = node->paintRow(&_imguiSelection, rows[i]._depth);
+          if (events & _row_toggled) view._dirty = true;
+          if (events & _row_context_menu) view._contextNode = node;
+        }
+      }
+      clipper.End();
+      /// @note the context menu outlives its row being clipped
+      if (view._contextNode && !view._contextNode->paintContextMenu()) view._contextNode = nullptr;
 
       msIo = ImGui::EndMultiSelect();
       applySelectionRequests(msIo, this, &_imguiSelection);
 
-      if (tableOpen) {
-        ImGui::EndTable();
-      }
+      ImGui::EndTable();
 
-      // ImGui::PopStyleVar();
+      /// @note newly expanded nodes are populated ahead of the next frame
+      if (view._dirty) updateVisibleRows();
     }
 
     SceneFileEditor::SceneFileEditor() {
@@ -280,8 +393,13 @@ namespace zs {
       ResourceSystem::onUsdFilesChanged().connect([](const std::vector<std::string>& labels) {
         for (auto& label : labels) {
 #if ZS_ENABLE_USD
+          auto scene = ResourceSystem::get_usd(label);
+          /// @note update the existing tree in place if it still reflects the same stage
+          if (auto tree = dynamic_cast<ui::UsdTreeNode*>(ResourceSystem::get_widget_ptr(label));
+              tree && tree->_scene == scene && tree->resync())
+            continue;
           fmt::print("rebuilding usd scene [{}] widget!\n", label);
-          auto root = ResourceSystem::get_usd(label)->getRootPrim();
+          auto root = scene->getRootPrim();
           // auto root = ResourceSystem::get_usd(label)->getPrim("/");
           ResourceSystem::set_widget(std::string(label), ui::build_usd_tree_node(root.get()));
 #endif
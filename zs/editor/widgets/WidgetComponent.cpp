@@ -34,6 +34,9 @@ namespace zs {
       case type_e::usd_:
         label = (const char *)ICON_MS_SCENE;
         break;
+      case type_e::mesh_:
+        label = (const char *)ICON_MD_WIDGETS;
+        break;
       default:
         break;
     }
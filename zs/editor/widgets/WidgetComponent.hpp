@@ -311,7 +311,7 @@ namespace zs {
   };
 
   struct AssetEntry {
-    enum type_e : int { unknown_ = 0, text_, usd_, texture_ };
+    enum type_e : int { unknown_ = 0, text_, usd_, texture_, mesh_ };
 
     std::string _tag{};
     type_e _type{unknown_};